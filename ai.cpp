@@ -1,7 +1,134 @@
 #include <iostream>
 #include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <sys/time.h>
 #include "ai.h"
 #include "rules.h"
+#include "position.h"
+#include "alloccount.h"
+#include "trace.h"
+
+/**
+* Returns the wall clock time in seconds.
+*/
+static double aiClock()
+{
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec+tv.tv_usec/1000000.0;
+}
+
+/**
+* Tells whether the search has been told to stop.
+* @param const TAISearch *search, the search, may be NULL.
+*/
+static bool aiStopped(const TAISearch *search)
+{
+	return search!=NULL && search->stop!=NULL && __atomic_load_n(search->stop, __ATOMIC_RELAXED);
+}
+
+/**
+* Counts a move tried at a ply.
+* @param TAISearch *search, the search, may be NULL.
+* @param int ply, ply of the move.
+*/
+static void countNode(TAISearch *search, int ply)
+{
+	if(search==NULL || search->stats==NULL || ply<0 || ply>=AI_PLIES)
+		return;
+	search->stats->nodes++;
+	search->stats->plyNodes[ply]++;
+}
+
+/**
+* Counts the moves listed at a ply, before the worst looking are cut off.
+* @param TAISearch *search, the search, may be NULL.
+* @param int ply, ply of the moves.
+* @param int count, moves listed.
+*/
+static void countMoves(TAISearch *search, int ply, int count)
+{
+	if(search==NULL || search->stats==NULL || ply<0 || ply>=AI_PLIES)
+		return;
+	search->stats->plyMoves[ply]+=count;
+}
+
+/**
+* Starts the line of a move at a ply.
+* @param TAISearch *search, the search, may be NULL.
+* @param int ply, ply of the move.
+* @param TCoord place, the move.
+*/
+static void startLine(TAISearch *search, int ply, TCoord place)
+{
+	if(search==NULL || ply<0 || ply>=AI_PLIES)
+		return;
+	search->pv[ply][ply]=place.x+place.y*BOARDSIZE;
+	search->pvLength[ply]=ply+1;
+}
+
+/**
+* The move just tried after the move at ply gave it its score, its line
+* follows the move.
+* @param TAISearch *search, the search, may be NULL.
+* @param int ply, ply of the move.
+*/
+static void takeLine(TAISearch *search, int ply)
+{
+	if(search==NULL || ply<0 || ply+1>=AI_PLIES)
+		return;
+	memcpy(&search->pv[ply][ply+1], &search->pv[ply+1][ply+1], search->pvLength[ply+1]-(ply+1));
+	search->pvLength[ply]=search->pvLength[ply+1];
+}
+
+/**
+* Counts the index of the move that gave a node its score.
+* @param TAISearch *search, the search, may be NULL.
+* @param int index, index in the sorted list, -1 if no move did.
+*/
+static void countBest(TAISearch *search, int index)
+{
+	if(search==NULL || search->stats==NULL || index<0)
+		return;
+	search->stats->bestIndex[(index < AI_INDEXES) ? index : AI_INDEXES-1]++;
+}
+
+/**
+* Keeps the line of the best root move so far.
+* @param TAISearch *search, the search, may be NULL.
+*/
+static void keepLine(TAISearch *search)
+{
+	if(search==NULL || search->stats==NULL)
+		return;
+	memcpy(search->stats->pv, search->pv[0], search->pvLength[0]);
+	search->stats->pvLength=search->pvLength[0];
+}
+
+/**
+* Tells the caller of findMove() how far it has got.
+* @param TAIStats *stats, the statistics, may be NULL.
+* @param double start, aiClock() time the search started.
+* @param TCoord best, best move so far.
+* @param int score, its score.
+* @param TAIProgress progress, the callback, may be NULL.
+* @param void *data, handed to progress.
+*/
+static void reportMove(TAIStats *stats, double start, TCoord best, int score,
+	TAIProgress progress, void *data)
+{
+	if(stats==NULL)
+		return;
+	stats->rootDone++;
+	stats->best=best.x+best.y*BOARDSIZE;
+	stats->score=score;
+	stats->seconds=aiClock()-start;
+	if(progress)
+		progress(stats, data);
+}
 
 /**
 * Finds all moves for player and returns the co-ordinates for the next move.
@@ -9,39 +136,75 @@
 * @return TCoord, location of the best next move.
 * @param TRules othello, current situation
 * @param unsigned int player, color.
+* @param TAIStats *stats, if not NULL, the statistics are saved here.
+* @param TAIProgress progress, called with the statistics so far, may be NULL.
+* @param void *data, handed to progress.
+* @param const int *stop, if not NULL, findMove() gives up soon after
+* another thread sets it to non-zero. The move returned is then legal but
+* not searched.
 */
-TCoord findMove(TRules othello, unsigned int player)
+TCoord findMove(TRules othello, unsigned int player, TAIStats *stats,
+	TAIProgress progress, void *data, const int *stop)
 {
-	TCoord *moveList;
+	TRACE_SCOPE("findMove");
+	TMoveList moveList;
 	TCoord nextMove;
-	int moveNumber=0;
-	int k, previousScore, newScore;
+	TAIStats local;
+	TAISearch search;
+	double start;
+	int k, best=0, previousScore, newScore;
+#ifdef ALLOC_COUNT
+	unsigned long allocations=allocationCount();
+#endif
 
         /// seed rand() with processor ticks
         srand( (int)clock() );
 
-	/// Find all moves and sort them.
-	moveList=possibleMoves(othello, player, &moveNumber);
-	sortScores(othello, moveList, moveNumber, player);
+	/// Progress needs statistics to report, keep them here if the caller doesn't.
+	if(stats==NULL && progress)
+		stats=&local;
+	if(stats)
+		memset(stats, 0, sizeof(TAIStats));
+	search.stats=stats;
+	search.stop=stop;
+	start=aiClock();
 
-	nextMove=moveList[0];
-	previousScore=tryNext(othello, player, nextMove, STEPS);
+	/// Find all moves and sort them.
+	possibleMoves(othello, player, &moveList);
+	sortScores(othello, &moveList, player);
+	countMoves(&search, 0, moveList.count);
+	if(stats)
+		stats->rootMoves=(moveList.count/3 > 1) ? moveList.count/3 : 1;
+
+	nextMove=squareCoord(moveList.square[0]);
+	previousScore=tryNext(othello, player, nextMove, STEPS, &search);
+	keepLine(&search);
+	reportMove(stats, start, nextMove, previousScore, progress, data);
 	
 	/// Examine third of the best looking moves deeper.
-	for(k=1;k<(int)moveNumber/3;k++)
+	for(k=1;k<moveList.count/3 && !aiStopped(&search);k++)
 	{
-		if((newScore=tryNext(othello, player, moveList[k], STEPS)) > previousScore)
+		if((newScore=tryNext(othello, player, squareCoord(moveList.square[k]), STEPS, &search)) > previousScore)
 		{
-			nextMove=moveList[k];
+			nextMove=squareCoord(moveList.square[k]);
 			previousScore=newScore;
+			best=k;
+			keepLine(&search);
 		} else if(newScore == previousScore && ((float)rand()/(float)0x7fffffff)>0.5)
 		{
-			nextMove=moveList[k];
+			nextMove=squareCoord(moveList.square[k]);
 			previousScore=newScore;
+			best=k;
+			keepLine(&search);
 		}
+		reportMove(stats, start, nextMove, previousScore, progress, data);
 	}
-	
-	free(moveList);
+	countBest(&search, best);
+
+#ifdef ALLOC_COUNT
+	/// The whole search runs on the stack.
+	assert(allocationCount() == allocations);
+#endif
 
   return nextMove;
 }
@@ -53,20 +216,28 @@ TCoord findMove(TRules othello, unsigned int player)
 * @param unsigned int player, players color
 * @param TCoord place, place to try
 * @param int steps, amount of steps left
+* @param TAISearch *search, the search of findMove(), may be NULL.
 */
-int tryNext(TRules othello, unsigned int player, TCoord place, int steps)
+int tryNext(TRules othello, unsigned int player, TCoord place, int steps,
+	TAISearch *search)
 {
+	TRACE_SCOPE("tryNext");
 	int score, tempScore;
 	unsigned int enemy;
-	TCoord *enemyMoves;
-	int moveNumber;
-	int i;
+	TMoveList enemyMoves;
+	int i, best=-1;
 
 	if(player==WHITE)
 		enemy=BLACK;
 	else
 		enemy=WHITE;
 
+	/// Own moves are at the even plies, findMove()'s at ply 0.
+	countNode(search, 2*(STEPS-steps));
+	startLine(search, 2*(STEPS-steps), place);
+	/// A stopped search unwinds, its scores mean nothing.
+	if(aiStopped(search))
+		return 0;
 	score=moveScore(othello, player, place);
 	/// Places the stone on copy of the board.
 	othello.rulesSetStone(place, player);
@@ -76,18 +247,22 @@ int tryNext(TRules othello, unsigned int player, TCoord place, int steps)
 /// score.
 	if(steps>0)
 	{
-		enemyMoves=possibleMoves(othello, enemy, &moveNumber);
-		sortScores(othello, enemyMoves, moveNumber, enemy);
+		possibleMoves(othello, enemy, &enemyMoves);
+		sortScores(othello, &enemyMoves, enemy);
+		countMoves(search, 2*(STEPS-steps)+1, enemyMoves.count);
 
 		/// Check part of the enemy's moves.
-		for(i=0;i<(int) moveNumber/5;i++)
+		for(i=0;i<enemyMoves.count/5;i++)
 		{
-			tempScore=nextEnemyMove(othello, player, enemyMoves[i], steps-1);
+			tempScore=nextEnemyMove(othello, player, squareCoord(enemyMoves.square[i]), steps-1, search);
 			if(tempScore>score)
+			{
 				score=tempScore;
+				best=i;
+				takeLine(search, 2*(STEPS-steps));
+			}
 		}
-		
-		free(enemyMoves);
+		countBest(search, best);
 	}
 
 	return score;
@@ -99,44 +274,59 @@ int tryNext(TRules othello, unsigned int player, TCoord place, int steps)
 * @param unsigned int player, player's color.
 * @param TCoord place, enemy's move.
 * @param int steps, remaining steps
+* @param TAISearch *search, the search of findMove(), may be NULL.
 * @return Returns the score for this move.
 *
 */
-int nextEnemyMove(TRules othello, unsigned int player, TCoord place, int steps)
+int nextEnemyMove(TRules othello, unsigned int player, TCoord place, int steps,
+	TAISearch *search)
 {
+	TRACE_SCOPE("nextEnemyMove");
 	unsigned int enemy;
-	TCoord *moveList;
-	int moveNumber;
+	TMoveList moveList;
 	int score=0;
 	int tempScore;
-	int i;
+	int i, best=-1;
 
 	if(player==WHITE)
 		enemy=BLACK;
 	else
 		enemy=WHITE;
 
+	/// Enemy moves are at the odd plies, called with one step less than the own move before.
+	countNode(search, 2*(STEPS-steps)-1);
+	startLine(search, 2*(STEPS-steps)-1, place);
+	if(aiStopped(search))
+		return 0;
 	/// Place opponent's stone
 	othello.rulesSetStone(place, enemy);
 
 	/// Get next possible moves and sort them.
-	moveList=possibleMoves(othello, player, &moveNumber);
-	sortScores(othello, moveList, moveNumber, player);
+	possibleMoves(othello, player, &moveList);
+	sortScores(othello, &moveList, player);
+	countMoves(search, 2*(STEPS-steps), moveList.count);
 
 	/// Check part of the best moves and return the score for the best.
-	for(i=0;(int) i<moveNumber/4;i++)
+	for(i=0;i<moveList.count/4;i++)
 	{
 		if(i==0)
-			score=tryNext(othello, player, moveList[0], steps);
+		{
+			score=tryNext(othello, player, squareCoord(moveList.square[0]), steps, search);
+			best=0;
+			takeLine(search, 2*(STEPS-steps)-1);
+		}
 		else
 		{
-			tempScore=tryNext(othello, player, moveList[i], steps);
+			tempScore=tryNext(othello, player, squareCoord(moveList.square[i]), steps, search);
 			if (tempScore>score)
+			{
 				score=tempScore;
+				best=i;
+				takeLine(search, 2*(STEPS-steps)-1);
+			}
 		}
 	}
-
-	free(moveList);
+	countBest(search, best);
 
 	return score;
 }
@@ -151,10 +341,10 @@ int nextEnemyMove(TRules othello, unsigned int player, TCoord place, int steps)
 */
 int moveScore(TRules othello, unsigned int player, TCoord place)
 {
+	TRACE_SCOPE("moveScore");
 	int score=0;
-	int newMoves;
 	unsigned int enemy;
-	TCoord *temp;
+	TMoveList newMoves;
 
 	if(player==WHITE)
 		enemy=BLACK;
@@ -171,18 +361,15 @@ int moveScore(TRules othello, unsigned int player, TCoord place)
 	/// We're trying to avoid empty spaces around our stones
 	score-=countLiberties(othello, player); 
 
-	temp=possibleMoves(othello, player, &newMoves);
-	free(temp);
+	possibleMoves(othello, player, &newMoves);
 
 	/// and we're trying to get maximum number of moves
-	score+=newMoves;
+	score+=newMoves.count;
 
-	temp=possibleMoves(othello, enemy, &newMoves);
+	possibleMoves(othello, enemy, &newMoves);
 	
 	/// and we don't want opponent to have many moves.
-	score-=newMoves; 
-
-	free(temp);
+	score-=newMoves.count; 
 
 	return score;
 }
@@ -439,23 +626,20 @@ int evaluateLocation(TRules othello, TCoord place, unsigned int player)
 
 
 /**
-* Searches for all possible moves for player.
+* Searches for all possible moves for player. A move is listed once for
+* every own stone it traps enemy stones against, as the mobility terms and
+* the cut-offs of the search count them.
 * @param TRules othello, current board.
 * @param unsigned int player, player's color.
-* @param int *moveNumber, saves the number of moves here.
-* @return Returns the list of possible moves.
+* @param TMoveList *moves, saves the possible moves here.
 */
-TCoord *possibleMoves(TRules othello, unsigned int player, int *moveNumber)
+void possibleMoves(TRules othello, unsigned int player, TMoveList *moves)
 {
-	TCoord *moveList;
-	int blockNum=1;
 	int x,y,k;
 	unsigned int enemy;
 	TCoord direction, check;
 
-	*moveNumber=0;
-	/// Allocates memory for the list.
-	moveList=(TCoord *)malloc(BLOCKSIZE*sizeof(TCoord));
+	moves->count=0;
   
 	if(player==WHITE)
 		enemy=BLACK;
@@ -489,24 +673,31 @@ TCoord *possibleMoves(TRules othello, unsigned int player, int *moveNumber)
 						/// If the next square was inside the board and it was empty, we have found a possible move. Add it to list and rejoice.
 						if(othello.stoneAt(check) == BLANK && check.x>=0 && check.x<BOARDSIZE && check.y>=0 && check.y<BOARDSIZE)
 						{
-							(*moveNumber)++;
-
-							/// We can allocate more memory for the list, if it's necessary.
-							if(*moveNumber==blockNum*BLOCKSIZE)
-							{
-								blockNum++;
-								moveList=(TCoord *) realloc(moveList, blockNum*BLOCKSIZE*sizeof(TCoord));
-							}
-							moveList[(*moveNumber)-1]=check;
+							/// One entry per square and direction, the list can't fill up.
+							assert(moves->count < MOVELIST_SIZE);
+							if(moves->count < MOVELIST_SIZE)
+								moves->square[moves->count++]=check.x+check.y*BOARDSIZE;
 						}
 					}
 				}
 			}
 		}
 	}
+}
 
-  return moveList;
-  
+/**
+* Returns the co-ordinates of a square in a move list.
+* @param int square, x+y*BOARDSIZE.
+* @return Returns the co-ordinates.
+*/
+TCoord squareCoord(int square)
+{
+	TCoord place;
+
+	place.x=square%BOARDSIZE;
+	place.y=square/BOARDSIZE;
+
+	return place;
 }
 
 /**
@@ -560,30 +751,100 @@ TCoord getDirection(int k)
 /**
 * Sorts the scores based on their scores.
 * @param TRules othello, current situation.
-* @param TCoord *moves, list of moves.
-* @param int moveNum, number of moves.
+* @param TMoveList *moves, list of moves.
 * @param unsigned int player, player's color.
 */
-void sortScores(TRules othello, TCoord *moves, int moveNum, unsigned int player)
+void sortScores(TRules othello, TMoveList *moves, unsigned int player)
 {
 	int i, j;
-	TCoord temp;
+	uint8_t temp;
 
-	for(i=1;i<moveNum;i++)
+	for(i=1;i<moves->count;i++)
 	{
-		temp.x=moves[i].x;
-		temp.y=moves[i].y;
+		temp=moves->square[i];
 		j=i;
 
-		while(j>0 && moveScore(othello, player,moves[j-1]) < moveScore(othello, player, temp))
+		while(j>0 && moveScore(othello, player, squareCoord(moves->square[j-1])) < moveScore(othello, player, squareCoord(temp)))
 		{
-			moves[j].x=moves[j-1].x;
-			moves[j].y=moves[j-1].y;
+			moves->square[j]=moves->square[j-1];
 			j--;
 		}
 
-		moves[j].x=temp.x;
-		moves[j].y=temp.y;
+		moves->square[j]=temp;
 	}
 
 }
+
+/**
+* Average number of moves tried after each move of a ply.
+* @param const TAIStats *stats, the statistics.
+* @param int ply, ply from the root.
+* @return Returns the branching factor, 0 if no moves were tried at ply.
+*/
+double aiBranchingFactor(const TAIStats *stats, int ply)
+{
+	if(ply<0 || ply+1>=AI_PLIES || stats->plyNodes[ply]==0)
+		return 0;
+	return (double)stats->plyNodes[ply+1]/stats->plyNodes[ply];
+}
+
+/**
+* Share of the nodes whose score came from the move at an index of the
+* sorted list. Well ordered moves put the best first almost always.
+* @param const TAIStats *stats, the statistics.
+* @param int index, move index, AI_INDEXES-1 covers the later moves too.
+* @return Returns the share between 0 and 1.
+*/
+double aiBestRate(const TAIStats *stats, int index)
+{
+	uint64_t total=0;
+	int i;
+
+	for(i=0; i<AI_INDEXES; i++)
+		total+=stats->bestIndex[i];
+	if(total==0 || index<0 || index>=AI_INDEXES)
+		return 0;
+	return (double)stats->bestIndex[index]/total;
+}
+
+/**
+* Writes a one line summary: moves tried, nodes, speed, branching
+* factors, the share of moves cut off, how often the first move was
+* best, and the score and line of the best move so far.
+* @param const TAIStats *stats, the statistics.
+* @param char *text, the line is saved here.
+* @param int size, size of text.
+*/
+void formatAIStats(const TAIStats *stats, char *text, int size)
+{
+	uint64_t listed=0, tried=0;
+	char name[3];
+	int length, i;
+
+	length=snprintf(text, size, "move %d/%d, %llu nodes, %.0f kN/s, branching",
+		stats->rootDone, stats->rootMoves, (unsigned long long)stats->nodes,
+		(stats->seconds > 0) ? stats->nodes/stats->seconds/1000 : 0.0);
+	for(i=0; i+1<AI_PLIES; i++)
+		length+=snprintf(text+length, (length < size) ? size-length : 0,
+			" %.1f", aiBranchingFactor(stats, i));
+
+	for(i=0; i<AI_PLIES; i++)
+	{
+		listed+=stats->plyMoves[i];
+		tried+=stats->plyNodes[i];
+	}
+	if(listed > 0)
+		length+=snprintf(text+length, (length < size) ? size-length : 0,
+			", cut %.0f%%", 100.0*(listed-tried)/listed);
+
+	length+=snprintf(text+length, (length < size) ? size-length : 0,
+		", best@1 %.0f%%, score %+d", 100*aiBestRate(stats, 0), stats->score);
+
+	if(stats->pvLength > 0)
+		length+=snprintf(text+length, (length < size) ? size-length : 0, ", pv");
+	for(i=0; i<stats->pvLength; i++)
+	{
+		squareName(stats->pv[i], name);
+		length+=snprintf(text+length, (length < size) ? size-length : 0, " %s", name);
+	}
+}
@@ -11,11 +11,89 @@
 #include <iostream>
 #include <stdlib.h>
 #include <limits.h>
+#include <stdint.h>
 #include "rules.h"
 
-#define BLOCKSIZE 10
+/// Capacity of a move list. A move is listed once for every direction
+/// it flips in, so there are at most 8 entries per square.
+#define MOVELIST_SIZE (8*BOARDSIZE*BOARDSIZE)
 /// Number of steps to look forward
 #define STEPS 2 
+/// Plies findMove() looks ahead, own and enemy moves both counted
+#define AI_PLIES (2*STEPS+1)
+/// Best moves are counted by their index in the sorted list, the last counts the rest
+#define AI_INDEXES 8
+
+/**
+* @short List of moves, kept on the stack so that searching does no
+* heap allocations.
+* @param uint8_t square, the moves as x+y*BOARDSIZE.
+* @param int count, number of moves in the list.
+*/
+typedef struct{
+	uint8_t square[MOVELIST_SIZE];
+	int count;
+	} TMoveList;
+
+/**
+* @short What findMove() did.
+*
+* Every move tried is a node. Only the best looking part of the moves
+* listed at a ply are tried, the rest are cut off. There is no window and
+* so no beta cutoffs, how well the moves are ordered shows in the index
+* of the move that gives a node its score instead. findMove() has no
+* transposition table and every line ends at the same ply, so there is
+* no hit rate and no selective depth.
+* @param uint64_t nodes, moves tried.
+* @param double seconds, time taken so far.
+* @param uint64_t plyNodes, moves tried at each ply, ply 0 is the move to make.
+* @param uint64_t plyMoves, moves listed at each ply, tried or cut off.
+* @param uint64_t bestIndex, nodes whose score came from a move tried
+* after them, by the index of that move in the sorted list.
+* @param int rootMoves, moves findMove() tries at ply 0.
+* @param int rootDone, moves it has tried so far.
+* @param int score, score of the best move so far.
+* @param int best, best move so far as x+y*BOARDSIZE.
+* @param uint8_t pv, the line the score of the best move came from, moves as x+y*BOARDSIZE.
+* @param int pvLength, moves in pv.
+*/
+typedef struct TAIStats{
+	uint64_t nodes;
+	double seconds;
+	uint64_t plyNodes[AI_PLIES];
+	uint64_t plyMoves[AI_PLIES];
+	uint64_t bestIndex[AI_INDEXES];
+	int rootMoves;
+	int rootDone;
+	int score;
+	int best;
+	uint8_t pv[AI_PLIES];
+	int pvLength;
+	} TAIStats;
+
+/**
+* Called by findMove() after each move it has tried at ply 0.
+* @param const TAIStats *stats, the search so far.
+* @param void *data, the caller's pointer.
+*/
+typedef void (*TAIProgress)(const TAIStats *stats, void *data);
+
+/**
+* @short State of a findMove() search, handed down to tryNext() and
+* nextEnemyMove().
+* @param TAIStats *stats, where moves are counted, may be NULL.
+* @param const int *stop, if not NULL, the search returns soon after
+* another thread sets it to non-zero with __atomic_store_n().
+* @param uint8_t pv, line the score of the move at each ply came from,
+* row ply starting at column ply.
+* @param int pvLength, end of each row of pv.
+*/
+typedef struct{
+	TAIStats *stats;
+	const int *stop;
+	uint8_t pv[AI_PLIES][AI_PLIES];
+	int pvLength[AI_PLIES];
+	} TAISearch;
 
 /**
 * Finds all moves for player and returns the co-ordinates for the next move.
@@ -23,8 +101,15 @@
 * @return TCoord, location of the best next move.
 * @param TRules othello, current situation
 * @param unsigned int player, color.
+* @param TAIStats *stats, if not NULL, the statistics are saved here.
+* @param TAIProgress progress, called with the statistics so far, may be NULL.
+* @param void *data, handed to progress.
+* @param const int *stop, if not NULL, findMove() gives up soon after
+* another thread sets it to non-zero. The move returned is then legal but
+* not searched.
 */
-TCoord findMove(TRules othello, unsigned int player);
+TCoord findMove(TRules othello, unsigned int player, TAIStats *stats=NULL,
+	TAIProgress progress=NULL, void *data=NULL, const int *stop=NULL);
 
 /**
 * Examines next own move and searches all opponent's moves.
@@ -33,18 +118,49 @@ TCoord findMove(TRules othello, unsigned int player);
 * @param unsigned int player, players color
 * @param TCoord place, place to try
 * @param int steps, amount of steps left
+* @param TAISearch *search, the search of findMove(), may be NULL.
 */
-int tryNext(TRules othello, unsigned int player, TCoord place, int steps);
+int tryNext(TRules othello, unsigned int player, TCoord place, int steps,
+	TAISearch *search=NULL);
 /**
 * Make the next opponent's move and search all possible next own moves.
 * @param TRules othello, current situation.
 * @param unsigned int player, player's color.
 * @param TCoord place, enemy's move.
 * @param int steps, remaining steps
+* @param TAISearch *search, the search of findMove(), may be NULL.
 * @return Returns the score for this move.
 *
 */
-int nextEnemyMove(TRules othello, unsigned int player, TCoord place, int steps);
+int nextEnemyMove(TRules othello, unsigned int player, TCoord place, int steps,
+	TAISearch *search=NULL);
+
+/**
+* Average number of moves tried after each move of a ply.
+* @param const TAIStats *stats, the statistics.
+* @param int ply, ply from the root.
+* @return Returns the branching factor, 0 if no moves were tried at ply.
+*/
+double aiBranchingFactor(const TAIStats *stats, int ply);
+
+/**
+* Share of the nodes whose score came from the move at an index of the
+* sorted list. Well ordered moves put the best first almost always.
+* @param const TAIStats *stats, the statistics.
+* @param int index, move index, AI_INDEXES-1 covers the later moves too.
+* @return Returns the share between 0 and 1.
+*/
+double aiBestRate(const TAIStats *stats, int index);
+
+/**
+* Writes a one line summary: moves tried, nodes, speed, branching
+* factors, the share of moves cut off, how often the first move was
+* best, and the score and line of the best move so far.
+* @param const TAIStats *stats, the statistics.
+* @param char *text, the line is saved here.
+* @param int size, size of text.
+*/
+void formatAIStats(const TAIStats *stats, char *text, int size);
 
 
 /**
@@ -86,13 +202,21 @@ int countLiberties(TRules othello, unsigned int player);
 int evaluateLocation(TRules othello, TCoord place, unsigned int player);
 
 /**
-* Searches for all possible moves for player.
+* Searches for all possible moves for player. A move is listed once for
+* every own stone it traps enemy stones against, as the mobility terms and
+* the cut-offs of the search count them.
 * @param TRules othello, current board.
 * @param unsigned int player, player's color.
-* @param int *moveNumber, saves the number of moves here.
-* @return Returns the list of possible moves.
+* @param TMoveList *moves, saves the possible moves here.
+*/
+void possibleMoves(TRules othello, unsigned int player, TMoveList *moves);
+
+/**
+* Returns the co-ordinates of a square in a move list.
+* @param int square, x+y*BOARDSIZE.
+* @return Returns the co-ordinates.
 */
-TCoord *possibleMoves(TRules othello, unsigned int player, int *moveNumber);
+TCoord squareCoord(int square);
 
 /**
 * Returns the vector for direction k.
@@ -104,10 +228,9 @@ TCoord getDirection(int k);
 /**
 * Sorts the scores based on their scores.
 * @param TRules othello, current situation.
-* @param TCoord *moves, list of moves.
-* @param int moveNum, number of moves.
+* @param TMoveList *moves, list of moves.
 * @param unsigned int player, player's color.
 */
-void sortScores(TRules othello, TCoord *moves, int moveNum, unsigned int player);
+void sortScores(TRules othello, TMoveList *moves, unsigned int player);
 
 #endif /*AI_H*/
@@ -16,47 +16,172 @@
  ***************************************************************************/
 
 #include <qtimer.h>
+#include <string.h>
 
 #include "aiplayer.h"
-#include "gamerules.h"
+#include "gamestate.h"
+#include "book.h"
+#include "search.h"
 #include "ai.h"
+#include "trace.h"
 
-AIPlayer::AIPlayer(unsigned int color) : QObject(),
-rules(new GameRules()), trules(new TRules()), gTimer(new QTimer()), color(color)
+AIPlayer::AIPlayer(unsigned int color, GameState* state) : QObject(),
+state(state), book(new TBook()), gTimer(new QTimer()),
+pollTimer(new QTimer()), searching(false), stop(0), color(color)
 {
-    opposite = (color==BLACK) ? WHITE : BLACK;
+    // no book file just means every move is searched
+    book->open(DEFAULT_BOOK);
+    pthread_mutex_init(&lock, NULL);
     connect( gTimer, SIGNAL(timeout()), this, SLOT(processMove()) );
+    connect( pollTimer, SIGNAL(timeout()), this, SLOT(pollSearch()) );
+    connect( state, SIGNAL(moveMade(unsigned int)), this, SLOT(extMove(unsigned int)) );
+    connect( state, SIGNAL(gameStarted()), this, SLOT(startGame()) );
+    connect( state, SIGNAL(jumped()), this, SLOT(restartMove()) );
 }
 
 AIPlayer::~AIPlayer() {
     gTimer->stop();
+    stopSearch();
     
-    delete rules;
-    delete trules;
+    pthread_mutex_destroy(&lock);
+    delete book;
     delete gTimer;
+    delete pollTimer;
 }
 
-void AIPlayer::extMove(unsigned int pos) {
-      last_pos = pos;
+void AIPlayer::extMove(unsigned int) {
+      gTimer->start( 600, TRUE );
+}
+
+void AIPlayer::startGame() {
+      gTimer->start( 600, TRUE );
+}
+
+void AIPlayer::restartMove() {
+      stopSearch();
       gTimer->start( 600, TRUE );
 }
 
 void AIPlayer::processMove() {
-    unsigned int move;
-    TCoord tmove;
-    if (rules->getTurn() == opposite) {
-        if (rules->setPiece(last_pos,opposite))
-            trules->rulesSetStone(rules->uiToTCoord(last_pos),opposite);
-    }
-    if (rules->getTurn() == color) {
-      tmove = findMove(*trules, color);
-      move = rules->TCoordToUi(tmove);
-      if (rules->setPiece(move, color)) {
-        trules->rulesSetStone(tmove, color);
-        emit makeMove( move );
+    TRACE_SCOPE("AIPlayer::processMove");
+    GameSnapshot game = state->snapshot();
+    if (game.turn() == color && !searching) {
+      // the book answers instantly, search only when out of book
+      TPosition pos = game.position(color);
+      searchPly = game.moves();
+      int square = book->lookup(pos, NULL);
+      if (square != -1 && (legalMoves(pos) >> square) & 1) {
+        playMove(square);
+        return;
       }
+      searchPos = pos;
+      TPosition black = game.position(BLACK);
+      searchRules = GameRules(game.weird());
+      searchRules.setPosition(black.own, black.enemy, color);
+      __atomic_store_n(&stop, 0, __ATOMIC_RELAXED);
+      found = false;
+      progress[0] = 0;
+      if (pthread_create(&searcher, NULL, searchThread, this) == 0) {
+        searching = true;
+        pollTimer->start( AI_POLL, FALSE );
+        return;
+      }
+      // no thread, think here with the window frozen
+      searchThread(this);
+      playMove(foundMove);
+      return;
     }
-    if (rules->getTurn() == BLANK) {
+    if (game.turn() == BLANK) {
       emit disconnectMe( this );
     }
 }
+
+void AIPlayer::pollSearch() {
+    char text[sizeof(progress)];
+    bool done;
+
+    pthread_mutex_lock(&lock);
+    strcpy(text, progress);
+    progress[0] = 0;
+    done = found;
+    pthread_mutex_unlock(&lock);
+
+    if (text[0] != 0) {
+      QString msg = (color == BLACK) ? "Black" : "White";
+      msg += " thinking: ";
+      msg += text;
+      emit thinking( msg );
+    }
+    if (done) {
+      stopSearch();
+      playMove(foundMove);
+    }
+}
+
+void AIPlayer::playMove(int square) {
+    // the board checks the move, the game tells when it was made
+    if (state->snapshot().moves() == searchPly) {
+      emit makeMove( square );
+    }
+}
+
+void AIPlayer::stopSearch() {
+    if (!searching) {
+      return;
+    }
+    // a solve notices within a few thousand nodes, findMove() at its next move
+    __atomic_store_n(&stop, 1, __ATOMIC_RELAXED);
+    pthread_join(searcher, NULL);
+    searching = false;
+    pollTimer->stop();
+}
+
+void* AIPlayer::searchThread(void* data) {
+    AIPlayer* ai = (AIPlayer*)data;
+    TSearchLimits limits;
+    int square;
+
+    traceThreadName("AI");
+    TRACE_SCOPE("AIPlayer::searchThread");
+    if (SQUARES - countBits(ai->searchPos.own|ai->searchPos.enemy) <= EXACT_EMPTIES) {
+      // late enough to play perfectly, solves are kept in the solved cache
+      limits.depth = 0;
+      limits.seconds = 0;
+      limits.weights = NULL;
+      limits.stop = &ai->stop;
+      searchLimited(ai->searchPos, &limits, &square, NULL, searchProgress, ai);
+    } else {
+      TAIStats stats;
+      TCoord tmove = findMove(ai->searchRules, ai->color, &stats, findProgress, ai, &ai->stop);
+      square = ai->searchRules.TCoordToUi(tmove);
+    }
+
+    pthread_mutex_lock(&ai->lock);
+    ai->foundMove = square;
+    ai->found = true;
+    pthread_mutex_unlock(&ai->lock);
+    return NULL;
+}
+
+void AIPlayer::searchProgress(const TSearchStats* stats, void* data) {
+    AIPlayer* ai = (AIPlayer*)data;
+    char text[sizeof(ai->progress)];
+
+    formatStats(stats, text, sizeof(text));
+    ai->setProgress(text);
+}
+
+void AIPlayer::findProgress(const TAIStats* stats, void* data) {
+    AIPlayer* ai = (AIPlayer*)data;
+    char text[sizeof(ai->progress)];
+
+    formatAIStats(stats, text, sizeof(text));
+    ai->setProgress(text);
+}
+
+void AIPlayer::setProgress(const char* text) {
+    // only the GUI thread touches the status bar, see pollSearch()
+    pthread_mutex_lock(&lock);
+    strcpy(progress, text);
+    pthread_mutex_unlock(&lock);
+}
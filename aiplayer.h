@@ -19,29 +19,45 @@
 #ifndef AIPLAYER_H
 #define AIPLAYER_H
 
+#include <pthread.h>
+
 #include "playerif.h"
+#include "position.h"
+#include "gamerules.h"
+
+/// Milliseconds between looks at the search thread
+#define AI_POLL 50
 
-class GameRules;
-class TRules;
+class GameState;
+class TBook;
 class QTimer;
+struct TSearchStats;
+struct TAIStats;
 
 /**
 * @short A computer player class to connect to BoardView
 * @author Ilmari Heikkinen
 *
 * The AIPlayer class communicates with a BoardView class its connected to
-* and plays othello according to the AI module implemented.
+* and plays othello according to the AI module implemented. It follows the
+* game through the board's GameState and sends its moves to the board.
+*
+* The search runs in a thread of its own so the window stays usable while
+* the computer thinks. The thread only touches the fields under lock, and
+* the GUI thread polls them with pollTimer, because Qt is not thread safe.
+* Deleting the player stops its search.
 */
 class AIPlayer : virtual public PlayerIface
 {
   Q_OBJECT
   public:
     /**
-    * Constructor, sets player color, opposing player color and connects the timer
-    * to the AI move processor.
+    * Constructor, sets player color and connects the timer to the AI move processor
+    * and the game to the timer.
     * @param color The color the AI should play. Permitted values are BLACK and WHITE.
+    * @param state The game to play.
     */
-    AIPlayer(unsigned int color);
+    AIPlayer(unsigned int color, GameState* state);
     /**
     * Destructor, deletes pointers.
     */
@@ -54,37 +70,129 @@ class AIPlayer : virtual public PlayerIface
     */
     virtual void extMove( unsigned int );
     /**
-    * The actual move processing function. Asks the AI module for a move and then fires
+    * Should be connected to the game started signal of the game. Looks whether the
+    * first move is ours.
+    */
+    void startGame();
+    /**
+    * Should be connected to the jumped signal of the game. Gives up the search of the
+    * position left and looks whether the move is ours.
+    */
+    void restartMove();
+    /**
+    * The actual move processing function. Reads the game, and if it is our turn plays
+    * the opening book move if the position
+    * is in the book, solves the endgame exactly when few squares are left and
+    * otherwise asks the AI module for a move. Then fires
     * off a makeMove(unsigned) signal that should be listened to by the BoardView the
     * player is connected to. Is connected to gTimer to delay move processing.
     */
     void processMove();
+    /**
+    * Checks on the search thread. Sends its progress to the board as a
+    * thinking(QString&) signal, and plays its move once it has finished.
+    * Is connected to pollTimer.
+    */
+    void pollSearch();
     
   private:
     /**
-    * Internal othello board for keeping tab of the game.
+    * Fires off makeMove(unsigned), unless the game has moved on since the search
+    * started.
+    * @param square The move, as a bitboard square.
+    */
+    void playMove(int square);
+    /**
+    * Stops the search thread and waits for it to finish, if one runs.
+    */
+    void stopSearch();
+    /**
+    * Body of the search thread, solves searchPos or runs findMove() on searchRules.
+    * @param data The AIPlayer searching.
+    */
+    static void* searchThread(void* data);
+    /**
+    * Endgame solve progress callback, runs in the search thread. Leaves the
+    * statistics for pollSearch().
+    * @param stats The solve so far.
+    * @param data The AIPlayer searching.
+    */
+    static void searchProgress(const TSearchStats* stats, void* data);
+    /**
+    * findMove() progress callback, runs in the search thread. Leaves the
+    * statistics for pollSearch().
+    * @param stats The search so far.
+    * @param data The AIPlayer searching.
+    */
+    static void findProgress(const TAIStats* stats, void* data);
+    /**
+    * Leaves a line of progress for pollSearch().
+    * @param text The line.
+    */
+    void setProgress(const char* text);
+
+    /**
+    * The game being played, shared with the board.
     */
-    GameRules* rules; // internal othello board
+    GameState* state;
     /**
-    * For AI module compatibility.
+    * Opening book, consulted before searching.
     */
-    TRules* trules; // ai compatibility
+    TBook* book;
     /**
     * Timer for move processing.
     */
     QTimer* gTimer;
     /**
-    * Color of the AI player.
+    * Timer for checking on the search thread while it runs.
     */
-    unsigned int color;
+    QTimer* pollTimer;
+    /**
+    * The search thread, valid while searching is set.
+    */
+    pthread_t searcher;
+    /**
+    * Whether the search thread has been started and not yet joined.
+    */
+    bool searching;
+    /**
+    * Position the search thread searches.
+    */
+    TPosition searchPos;
+    /**
+    * The same position for findMove().
+    */
+    GameRules searchRules;
+    /**
+    * Moves made in the game when the search started, a move found after the game
+    * has moved on is not played.
+    */
+    unsigned int searchPly;
+    /**
+    * Set by the GUI thread to make the search thread give up, only accessed
+    * with the __atomic builtins.
+    */
+    int stop;
     /**
-    * Color of the opposing player.
+    * Guards the fields below, which the search thread writes.
     */
-    unsigned int opposite;
+    pthread_mutex_t lock;
     /**
-    * Stores where the last move received was made.
+    * Set when the search thread has finished.
     */
-    unsigned int last_pos;
+    bool found;
+    /**
+    * The move found, as a bitboard square.
+    */
+    int foundMove;
+    /**
+    * Latest progress of the search, empty once it was shown.
+    */
+    char progress[256];
+    /**
+    * Color of the AI player.
+    */
+    unsigned int color;
 };
 
 #endif // AIPLAYER_H
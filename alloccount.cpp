@@ -0,0 +1,50 @@
+#include <stdlib.h>
+#include "alloccount.h"
+
+#ifdef ALLOC_COUNT
+
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+}
+
+/// Allocations of this thread
+static __thread unsigned long allocations=0;
+
+/**
+* Replaces the C library's malloc(), counting the call. The default
+* operator new allocates through here as well.
+*/
+extern "C" void *malloc(size_t size)
+{
+	allocations++;
+	return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t count, size_t size)
+{
+	allocations++;
+	return __libc_calloc(count, size);
+}
+
+extern "C" void *realloc(void *ptr, size_t size)
+{
+	allocations++;
+	return __libc_realloc(ptr, size);
+}
+
+#endif /* ALLOC_COUNT */
+
+/**
+* Returns the number of heap allocations made by the calling thread.
+* @return Returns the count, always 0 if ALLOC_COUNT is not defined.
+*/
+unsigned long allocationCount()
+{
+#ifdef ALLOC_COUNT
+	return allocations;
+#else
+	return 0;
+#endif
+}
@@ -0,0 +1,23 @@
+/** @file alloccount.h
+ *  Heap allocation counter for debug builds. Counts the malloc(),
+ *  calloc(), realloc() and operator new calls of the calling thread, so
+ *  code that must not allocate can check that it does not.
+*/
+
+#ifndef ALLOCCOUNT_H
+#define ALLOCCOUNT_H
+
+#include <stdlib.h>
+
+/// Counting needs glibc's allocator entry points and is left out of release builds
+#if !defined(NDEBUG) && !defined(QT_NO_DEBUG) && defined(__GLIBC__)
+#define ALLOC_COUNT 1
+#endif
+
+/**
+* Returns the number of heap allocations made by the calling thread.
+* @return Returns the count, always 0 if ALLOC_COUNT is not defined.
+*/
+unsigned long allocationCount();
+
+#endif /* ALLOCCOUNT_H */
@@ -0,0 +1,135 @@
+#include <string.h>
+#include "analysis.h"
+#include "position.h"
+#include "search.h"
+#include "transtable.h"
+
+TAnalysis::TAnalysis() : table(new TTransTable(ANALYSIS_TABLE_BITS)), moveCount(0), round(1), next(0)
+{
+	position.own=0;
+	position.enemy=0;
+}
+
+/**
+* Destructor. Frees the transposition table.
+*/
+TAnalysis::~TAnalysis()
+{
+	delete table;
+}
+
+/**
+* Starts analysing a new position. Forgets the old scores but not the
+* transposition table.
+* @param TPosition pos, the position, seen from the player to move.
+*/
+void TAnalysis::setPosition(TPosition pos)
+{
+	uint64_t moves=legalMoves(pos);
+	TPosition other=playMove(pos, PASS_MOVE);
+
+	position=pos;
+	moveCount=0;
+	round=1;
+	next=0;
+
+	/// Passing is the one move when there is nothing else, unless the game is over.
+	if(moves == 0 && legalMoves(other) != 0)
+	{
+		memset(&scores[0], 0, sizeof(TMoveScore));
+		scores[moveCount++].move=PASS_MOVE;
+	}
+	while(moves)
+	{
+		memset(&scores[moveCount], 0, sizeof(TMoveScore));
+		scores[moveCount++].move=__builtin_ctzll(moves);
+		moves&=moves-1;
+	}
+}
+
+/**
+* Continues the analysis for a while.
+* @param double seconds, time to spend.
+* @return Returns 1 if there is more to do, 0 if every move is solved exactly.
+*/
+int TAnalysis::refine(double seconds)
+{
+	double deadline=searchClock()+seconds;
+	int empties=SQUARES-countBits(position.own|position.enemy);
+	TSearchStats stats;
+	TMoveScore *result;
+	int depth, score, i;
+
+	while(moveCount > 0)
+	{
+		if(next == moveCount)
+		{
+			/// Round finished, every move is one ply deeper now.
+			for(i=0; i<moveCount && scores[i].exact; i++);
+			if(i == moveCount)
+				return 0;
+			round++;
+			next=0;
+		}
+
+		result=&scores[next];
+		if(result->exact)
+		{
+			next++;
+			continue;
+		}
+
+		/// Solving is no dearer than searching to the end.
+		depth=(empties-1 <= EXACT_EMPTIES || round >= empties) ? -1 : round;
+		if(searchMove(position, result->move, depth, table, deadline, &score, &stats) == -1)
+			return 1;
+
+		result->score=score;
+		result->depth=stats.depth;
+		result->exact=stats.exact;
+		result->pvLength=stats.pvLength;
+		memcpy(result->pv, stats.pv, stats.pvLength);
+		next++;
+	}
+
+	return 0;
+}
+
+/**
+* @return Returns the number of moves analysed, 0 if the game is over.
+*/
+int TAnalysis::count()
+{
+	return moveCount;
+}
+
+/**
+* @param int i, index, 0..count()-1.
+* @return Returns the result of a move.
+*/
+const TMoveScore *TAnalysis::move(int i)
+{
+	return &scores[i];
+}
+
+/**
+* @return Returns the index of the best scored move, -1 if none is scored yet.
+*/
+int TAnalysis::best()
+{
+	int i, found=-1;
+
+	for(i=0; i<moveCount; i++)
+		if(scores[i].depth > 0 && (found == -1 || scores[i].score > scores[found].score))
+			found=i;
+
+	return found;
+}
+
+/**
+* @return Returns the depth every move has been searched to.
+*/
+int TAnalysis::depth()
+{
+	return (next == moveCount) ? round : round-1;
+}
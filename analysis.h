@@ -0,0 +1,104 @@
+/** @file analysis.h
+ *  Scores every legal move of a position, not just the best one. The
+ *  moves are searched one ply deeper at a time in short slices, so the
+ *  first scores come at once and keep improving for as long as the
+ *  caller keeps asking.
+*/
+
+#ifndef ANALYSIS_H
+#define ANALYSIS_H
+
+#include <stdint.h>
+#include "position.h"
+#include "search.h"
+
+class TTransTable;
+
+/// Transposition table size of an analysis, 2^ANALYSIS_TABLE_BITS entries
+#define ANALYSIS_TABLE_BITS 20
+
+/**
+* @short Analysis result of one move.
+* @param int move, the square, or PASS_MOVE.
+* @param int score, value for the player making the move, valid if depth > 0.
+* @param int depth, plies the score comes from, 0 if not searched yet.
+* @param int exact, 1 if the score is the perfect play result.
+* @param uint8_t pv, principal variation starting with move.
+* @param int pvLength, moves in pv.
+*/
+typedef struct{
+	int move;
+	int score;
+	int depth;
+	int exact;
+	uint8_t pv[MAX_PLY];
+	int pvLength;
+	} TMoveScore;
+
+/**
+* @short Multi-PV analysis of a position.
+*
+* Each round searches every move to the same depth with a full window,
+* so all scores are exact for that depth. Results are updated in place as
+* each move finishes. The transposition table is shared by every move and
+* kept across positions, so interrupted work is not lost.
+*/
+class TAnalysis
+{
+	public:
+
+TAnalysis();
+
+/**
+* Destructor. Frees the transposition table.
+*/
+~TAnalysis();
+
+/**
+* Starts analysing a new position. Forgets the old scores but not the
+* transposition table.
+* @param TPosition pos, the position, seen from the player to move.
+*/
+void setPosition(TPosition pos);
+
+/**
+* Continues the analysis for a while.
+* @param double seconds, time to spend.
+* @return Returns 1 if there is more to do, 0 if every move is solved exactly.
+*/
+int refine(double seconds);
+
+/**
+* @return Returns the number of moves analysed, 0 if the game is over.
+*/
+int count();
+
+/**
+* @param int i, index, 0..count()-1.
+* @return Returns the result of a move.
+*/
+const TMoveScore *move(int i);
+
+/**
+* @return Returns the index of the best scored move, -1 if none is scored yet.
+*/
+int best();
+
+/**
+* @return Returns the depth every move has been searched to.
+*/
+int depth();
+
+	private:
+
+TTransTable *table;
+TPosition position;
+TMoveScore scores[SQUARES];
+int moveCount;
+/// Depth of the round in progress
+int round;
+/// Next move to search in the round
+int next;
+};
+
+#endif /* ANALYSIS_H */
@@ -0,0 +1,157 @@
+#include "animclock.h"
+#include "animpiece.h"
+#include "trace.h"
+
+#include <qcanvas.h>
+#include <qtimer.h>
+#include <stdlib.h>
+#include <time.h>
+
+AnimClock::AnimClock( QCanvas* canvas )
+    : QObject(), canvas( canvas ), timer( new QTimer() )
+{
+  // seed rand() with processor ticks, for the jitter
+  srand( (int)clock() );
+  epoch.start();
+  frames[BTW] = frames[WTB] = NULL;
+  connect( timer, SIGNAL(timeout()), this, SLOT(tick()) );
+}
+
+// the pieces the timeline flips may be gone already, only the animations get deleted
+AnimClock::~AnimClock()
+{
+  timer->stop();
+  delete timer;
+  QValueList<Step>::iterator it;
+  for (it = timeline.begin(); it != timeline.end(); ++it) {
+    delete (*it).anim;
+  }
+  for (int d=0; d<2; d++) {
+    while (!idle[d].isEmpty()) {
+      delete idle[d].last();
+      idle[d].pop_back();
+    }
+  }
+}
+
+void AnimClock::setFrames( unsigned int d, QCanvasPixmapArray* frames )
+{
+  this->frames[d] = frames;
+}
+
+// put a flip on the timeline, replacing the earlier one of the piece
+void AnimClock::play( Piece* p, unsigned int d, double seq, bool jitter )
+{
+  QValueList<Step>::iterator it;
+  for (it = timeline.begin(); it != timeline.end(); ++it) {
+    if ((*it).piece == p) {
+      (*it).anim->stopPlaying();
+      release( (*it).anim );
+      timeline.remove( it );
+      break;
+    }
+  }
+
+  // an idle animation of the direction, or a new one if all are playing
+  AnimPiece* a;
+  if (!idle[d].isEmpty()) {
+    a = idle[d].last();
+    idle[d].pop_back();
+  } else {
+    a = new AnimPiece( frames[d], canvas, d );
+  }
+
+  // anim start time jitter for ze bombardment.
+  int startDelay;
+  if (jitter && seq > 0) { // fire off first in sequence instantly
+    startDelay = (int)(((float)rand()/(float)0x7fffffff)*JITTER*FRAME_DELAY);
+  } else {
+    startDelay = (seq > 0) ? (int)(FRAME_DELAY * seq) : 0;
+  }
+
+  a->animPlay( p );
+  Step step;
+  step.anim = a;
+  step.piece = p;
+  step.start = epoch.elapsed() + startDelay;
+  step.frame = -1;
+  timeline.append( step );
+  schedule( epoch.elapsed() );
+}
+
+// every animation back to rest
+void AnimClock::stopAll()
+{
+  QValueList<Step>::iterator it;
+  for (it = timeline.begin(); it != timeline.end(); ++it) {
+    (*it).anim->stopPlaying();
+    release( (*it).anim );
+  }
+  timeline.clear();
+  timer->stop();
+}
+
+// nothing to animate
+bool AnimClock::isIdle()
+{
+  return timeline.isEmpty();
+}
+
+// show the frame each animation should be at by now, finish those past the last
+void AnimClock::tick()
+{
+  TRACE_SCOPE("AnimClock::tick");
+  int now = epoch.elapsed();
+  bool changed = FALSE;
+
+  QValueList<Step>::iterator it = timeline.begin();
+  while (it != timeline.end()) {
+    Step& step = *it;
+    if (now >= step.start) {
+      int frame = (now - step.start) / FRAME_DELAY;
+      if (frame >= FRAMES) {
+        step.anim->finishPlaying();
+        release( step.anim );
+        it = timeline.remove( it );
+        changed = TRUE;
+        continue;
+      }
+      if (frame != step.frame) {
+        step.frame = frame;
+        step.anim->showFrame( frame );
+        changed = TRUE;
+      }
+    }
+    ++it;
+  }
+
+  if (changed) {
+    canvas->update();
+  }
+  schedule( now );
+}
+
+// sleep until the earliest frame due
+void AnimClock::schedule( int now )
+{
+  if (timeline.isEmpty()) {
+    timer->stop();
+    return;
+  }
+
+  int next = 0;
+  QValueList<Step>::iterator it;
+  for (it = timeline.begin(); it != timeline.end(); ++it) {
+    int due = (*it).start + ((*it).frame + 1) * FRAME_DELAY;
+    if (it == timeline.begin() || due < next) {
+      next = due;
+    }
+  }
+  timer->start( (next > now) ? next - now : 0, TRUE );
+}
+
+// ready for the next flip of its direction
+void AnimClock::release( AnimPiece* a )
+{
+  idle[(a->getResult() == BLACK) ? WTB : BTW].append( a );
+}
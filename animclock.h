@@ -0,0 +1,120 @@
+/** @file animclock.h
+ *  One clock for all the flip animations on the board.
+*/
+
+#ifndef ANIMCLOCK_H
+#define ANIMCLOCK_H
+
+#include <qobject.h>
+#include <qvaluelist.h>
+#include <qdatetime.h>
+
+class QCanvas;
+class QCanvasPixmapArray;
+class QTimer;
+class Piece;
+class AnimPiece;
+
+/**
+* @short Plays the flip animations from a single timer.
+*
+* Every animation playing or waiting to start is on a timeline with the
+* time it starts at. Its frame follows from how long ago that was, one
+* frame every FRAME_DELAY ms, so a late tick skips frames instead of
+* slowing the flip down. Each tick advances every animation that is due,
+* updates the canvas once and sets the timer for the next frame due.
+* With nothing on the timeline the timer does not run at all.
+*
+* The clock also owns the animation sprites. A flip takes one from a pool
+* for its direction and gives it back when it finishes, so there are only
+* as many as the most flips ever playing at once.
+*/
+class AnimClock : public QObject
+{
+    Q_OBJECT
+public:
+    /**
+    * Constructor.
+    * @param canvas The canvas to update after each tick.
+    */
+    AnimClock( QCanvas* canvas );
+    /**
+    * Destructor, stops the timer and deletes the animations. Delete the clock before the
+    * canvas and the animation frames.
+    */
+    ~AnimClock();
+
+    /**
+    * Sets the frames of the animations in a direction. Set both directions before playing.
+    * @param d Direction, BTW (black to white) or WTB (white to black).
+    * @param frames The FRAMES frames of the flip, kept by the caller.
+    */
+    void setFrames( unsigned int d, QCanvasPixmapArray* frames );
+    /**
+    * Starts flipping a piece after a delay of seq * FRAME_DELAY ms or, if jitter is TRUE,
+    * a random delay between zero and JITTER * FRAME_DELAY ms.
+    * @param p The piece to flip, see AnimPiece::animPlay(). If it is already flipping, it starts over.
+    * @param d Direction of the flip, BTW (black to white) or WTB (white to black).
+    * @param seq Sequence number. Values under zero get handled as zero.
+    * @param jitter Whether to use random animation start delay or not.
+    */
+    void play( Piece* p, unsigned int d, double seq=0, bool jitter=FALSE );
+    /**
+    * Stops every animation and empties the timeline.
+    */
+    void stopAll();
+    /**
+    * Whether nothing is playing or waiting to play.
+    * @return Returns TRUE if the timeline is empty.
+    */
+    bool isIdle();
+
+protected slots:
+    /**
+    * Advances the animations that are due and sets the timer for the next one.
+    */
+    void tick();
+
+private:
+    /**
+    * An animation on the timeline.
+    */
+    struct Step
+    {
+        AnimPiece* anim;
+        Piece* piece;
+        /**
+        * Time to start at, ms on the clock.
+        */
+        int start;
+        /**
+        * Frame showing, -1 before the start.
+        */
+        int frame;
+    };
+    /**
+    * Sets the timer for the next frame due, or stops it.
+    * @param now The time on the clock.
+    */
+    void schedule( int now );
+    /**
+    * Gives an animation back to the pool of its direction.
+    * @param a An animation that has stopped playing.
+    */
+    void release( AnimPiece* a );
+
+    QCanvas* canvas;
+    QTimer* timer;
+    /**
+    * Time since the clock was made.
+    */
+    QTime epoch;
+    QValueList<Step> timeline;
+    QCanvasPixmapArray* frames[2];
+    /**
+    * Animations not playing, by direction.
+    */
+    QValueList<AnimPiece*> idle[2];
+};
+
+#endif  // ANIMCLOCK_H
@@ -16,32 +16,18 @@
  ***************************************************************************/
 
 #include "animpiece.h"
+#include "trace.h"
 
-#include <qtimer.h>
-#include <qobject.h>
-#include <qdatetime.h>
-#include <stdlib.h>
-#include <time.h>
-
-// connect timers to animation start and frame advance, set direction
+// set direction
 AnimPiece::AnimPiece( QCanvasPixmapArray *parray, QCanvas *canvas, unsigned int d ) :
- QObject(), Piece(parray,canvas), direction(d), playing(FALSE), STimer(new QTimer), Timer(new QTimer)
+ Piece(parray,canvas), direction(d), playing(FALSE), piece(NULL)
 {
     // set position out of range to make position updating mandatory on first time
     position = ROWS*COLUMNS;
-    // seed rand() with processor ticks
-    srand( (int)clock() );
-    
-    connect( STimer, SIGNAL(timeout()), SLOT(startAnim()) );
-    connect( Timer, SIGNAL(timeout()), SLOT(advanceFrame()) );
 }
 
 AnimPiece::~AnimPiece()
 {
-  STimer->stop();
-  Timer->stop();
-  delete STimer;
-  delete Timer;
 }
 
 // move to new position. z-index according to color
@@ -99,53 +85,36 @@ unsigned int AnimPiece::getResult()
   }
 }
 
-// set next frame unless last, in which case hide animation
-// and set the piece to right color
-void AnimPiece::advanceFrame()
+// show a frame, the first one shows the animation
+void AnimPiece::showFrame(int frame)
 {
-  if (currentFrame < FRAMES) {
-    if (currentFrame == 0) {
-      show();
-    }
-    setFrame(currentFrame);
-    currentFrame++;
-  } else {
-    piece->setFrame( getResult() );
-    stopPlaying();
-  }  
+  TRACE_SCOPE("AnimPiece::showFrame");
+  if (!isVisible()) {
+    show();
+  }
+  setFrame(frame);
+}
+
+// set the piece to the right color and hide the animation
+void AnimPiece::finishPlaying()
+{
+  piece->setFrame( getResult() );
+  stopPlaying();
 }
 
-// stop frame timer, rewind, show resulting piece frame, hide anim
+// rewind, hide anim
 void AnimPiece::stopPlaying()
 {
     playing = FALSE;
-    currentFrame = 0;
-
-    Timer->stop();
-    setFrame(currentFrame);
+    setFrame(0);
     hide();
 }
 
-// stop animstart timer, reset animation, set piece, start playing
-void AnimPiece::animPlay(Piece* p, double seq, bool jitter)
+// reset animation, set piece, ready to play
+void AnimPiece::animPlay(Piece* p)
 {
-  STimer->stop();
-  Timer->stop();
   playing = TRUE;  
   piece = p;
   setPosition(p->getPosition());
   piece->setColor( getResult() );
-  // anim start time jitter for ze bombardment.
-  int startDelay;
-  if (jitter && seq > 0) { // fire off first in sequence instantly
-    startDelay = (int)(((float)rand()/(float)0x7fffffff)*JITTER*FRAME_DELAY);
-  } else {
-    startDelay = (int)(FRAME_DELAY * seq);
-  }
-  STimer->start( startDelay, TRUE );
-}
-
-void AnimPiece::startAnim() {
-  Timer->start( FRAME_DELAY, FALSE );
-  advanceFrame();
 }
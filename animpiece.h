@@ -33,55 +33,29 @@
 #define BTW_X_OFFSET -51
 #define BTW_Y_OFFSET -51
 
-#define DEFAULT_WTB_1 "pics/wtb/white_to_black1.png"
-#define DEFAULT_WTB_2 "pics/wtb/white_to_black2.png"
-#define DEFAULT_WTB_3 "pics/wtb/white_to_black3.png"
-#define DEFAULT_WTB_4 "pics/wtb/white_to_black4.png"
-#define DEFAULT_WTB_5 "pics/wtb/white_to_black5.png"
-#define DEFAULT_WTB_6 "pics/wtb/white_to_black6.png"
-#define DEFAULT_WTB_7 "pics/wtb/white_to_black7.png"
-
-#define DEFAULT_BTW_1 "pics/btw/black_to_white1.png"
-#define DEFAULT_BTW_2 "pics/btw/black_to_white2.png"
-#define DEFAULT_BTW_3 "pics/btw/black_to_white3.png"
-#define DEFAULT_BTW_4 "pics/btw/black_to_white4.png"
-#define DEFAULT_BTW_5 "pics/btw/black_to_white5.png"
-#define DEFAULT_BTW_6 "pics/btw/black_to_white6.png"
-#define DEFAULT_BTW_7 "pics/btw/black_to_white7.png"
-
 #define FRAMES 7
 
 #define ANIM_RTTI 1002
 
-#include <qobject.h>
-
-class QTimer;
-
 /**
-* @short Animated extension to Piece-class, also inheriting QObject to handle signals and slots.
+* @short Animated extension to Piece-class.
 * @author Ilmari Heikkinen
 *
-* The AnimPiece-class inherits both Piece and QObject in order to have both the properties of a
-* QCanvasSprite and the signal-slot-communication of a QObject. The AnimPiece class defines
-* FRAME_DELAY, JITTER factor (multiples of FRAME_DELAY) and default locations on disk for black-to-white
-* and white-to-black flip animation frames (DEFAULT_WTB_1..DEFAULT_WTB_7, DEFAULT_BTW_1..DEFAULT_BTW_7).
+* The AnimPiece class defines
+* FRAME_DELAY, JITTER factor (multiples of FRAME_DELAY) and the number of FRAMES in the black-to-white
+* and white-to-black flip animations, which come from the atlas (ATLAS_BTW, ATLAS_WTB).
 *
-* Animating is handled by changing the AnimPiece frame to the tune of QTimer* Timer, and animation start
-* delay is handled by QTimer* STimer.
+* The timing is left to an AnimClock, which starts the animation, shows its frames one by one
+* and finishes it.
 */
-class AnimPiece : public QObject, public Piece
+class AnimPiece : public Piece
 {
-Q_OBJECT
 public:
     /**
     * Constructor, calls Piece constructor with the first two parameters.
-    * Seeds random number generator, connects timers to slots.
     * @param d Direction of the piece animation, BTW (black to white) or WTB (white to black).
     */
     AnimPiece( QCanvasPixmapArray *parray, QCanvas *canvas, unsigned int d );
-    /**
-    * Destructor, deletes timer pointers.
-    */
     ~AnimPiece();
 
     /**
@@ -104,38 +78,31 @@ public:
     */
     bool isPlaying();
     /**
-    * Starts playing the AnimPiece animation, delays animation start by seq * FRAME_DELAY ms
-    * or, if jitter is TRUE, by a random amount between zero and JITTER * FRAME_DELAY ms.
+    * Readies the AnimPiece animation to be played on p's square. Sets the color of p to the result
+    * right away, its frame only when the animation finishes.
     * @param p Pointer to piece the AnimPiece flips after the finishing playing its animation.
-    * @param seq Sequence number. Used for determining animation start delay. Values under zero get handled as zero.
-    * @param jitter Whether to use random animation start delay or not. TRUE for yes, FALSE for no.
     */
-    void animPlay(Piece* p, double seq=0, bool jitter=FALSE);
+    void animPlay(Piece* p);
     /**
-    * Get animation end result.
-    * @return Returns BLACK or WHITE per the direction-property.
+    * Shows a frame of the animation.
+    * @param frame The frame, 0..FRAMES-1.
     */
-    unsigned int getResult();
+    void showFrame(int frame);
     /**
-    * Stops playing the animation. Stops all timers, resets frame counter, hides the animation, set piece color.
+    * Sets the piece to the result and stops playing.
     */
-    void stopPlaying();
-    
-protected slots:
+    void finishPlaying();
     /**
-    * Advances to the next frame, if the current frame is last, hide animation and set piece color. Gets called by Timer.
+    * Get animation end result.
+    * @return Returns BLACK or WHITE per the direction-property.
     */
-    void advanceFrame();
+    unsigned int getResult();
     /**
-    * Starts playing the animation. Gets called by STimer.
+    * Stops playing the animation. Rewinds and hides the animation.
     */
-    void startAnim();
+    void stopPlaying();
         
 protected:
-    /**
-    * Current frame of the animation.
-    */
-    int currentFrame;
     /**
     * Is BTW if the animation is from black to white, WTB if the animation is from white to black.
     */
@@ -148,14 +115,6 @@ protected:
     * Piece to set color of after animation played.
     */
     Piece* piece;
-    /**
-    * Animation start delay timer.
-    */
-    QTimer* STimer;
-    /**
-    * Animation frame-to-frame delay timer.
-    */
-    QTimer* Timer;
 };
 
 
@@ -0,0 +1,63 @@
+#include "atlas.h"
+#include "trace.h"
+
+#include <qimage.h>
+#include <string.h>
+
+#include "atlasdata.h"
+
+// where each picture is in pics/atlas.png: x, y, width, height
+static const int atlasRects[ATLAS_PICTURES][4] = {
+  {   0,   0, 450, 450 },   // board
+  {   0, 450,  56,  62 },   // blank
+  {  56, 450,  56,  62 },   // black
+  { 112, 450,  56,  62 },   // white
+  { 450,   0, 160, 160 },   // white to black 1..7
+  { 450, 160, 160, 160 },
+  { 450, 320, 160, 160 },
+  { 450, 480, 160, 160 },
+  { 450, 640, 160, 160 },
+  { 450, 800, 160, 160 },
+  { 450, 960, 160, 160 },
+  { 610,   0, 160, 160 },   // black to white 1..7
+  { 610, 160, 160, 160 },
+  { 610, 320, 160, 160 },
+  { 610, 480, 160, 160 },
+  { 610, 640, 160, 160 },
+  { 610, 800, 160, 160 },
+  { 610, 960, 160, 160 }
+};
+
+// one decode and one upload to the display for all the pictures
+static const QPixmap& atlas()
+{
+  static QPixmap* decoded = NULL;
+  if (decoded == NULL) {
+    TRACE_SCOPE("atlas");
+    QImage image;
+    image.loadFromData( qembed_findData("atlas.png") );
+    decoded = new QPixmap( image );
+  }
+  return *decoded;
+}
+
+// copied on the display side, mask and alpha included
+QPixmap atlasPixmap( int picture )
+{
+  if (picture < 0 || picture >= ATLAS_PICTURES) {
+    return QPixmap();
+  }
+  const int* r = atlasRects[picture];
+  QPixmap pixmap( r[2], r[3] );
+  copyBlt( &pixmap, 0, 0, &atlas(), r[0], r[1], r[2], r[3] );
+  return pixmap;
+}
+
+QValueList<QPixmap> atlasPixmaps( int first, int count )
+{
+  QValueList<QPixmap> list;
+  for (int i=first; i<first+count; i++) {
+    list.append( atlasPixmap(i) );
+  }
+  return list;
+}
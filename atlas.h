@@ -0,0 +1,40 @@
+/** @file atlas.h
+ *  The board and piece pictures, built into the program as one image.
+ *  pics/atlas.png packs the pictures under pics/ and atlasdata.h holds it,
+ *  made with "qembed pics/atlas.png > atlasdata.h". Moving a picture in
+ *  the atlas means updating its rectangle in atlas.cpp too.
+*/
+
+#ifndef ATLAS_H
+#define ATLAS_H
+
+#include <qpixmap.h>
+#include <qvaluelist.h>
+
+// pictures in the atlas, pics/board.png, pics/blank.png and so on
+#define ATLAS_BOARD 0
+#define ATLAS_BLANK 1
+#define ATLAS_BLACK 2
+#define ATLAS_WHITE 3
+// the FRAMES white-to-black animation frames, pics/wtb/, start here
+#define ATLAS_WTB 4
+// and the black-to-white ones, pics/btw/
+#define ATLAS_BTW 11
+#define ATLAS_PICTURES 18
+
+/**
+* Gets a picture out of the atlas. The atlas is decoded on the first call
+* and kept, each picture is a copy of its part of it.
+* @param picture ATLAS_BOARD, ATLAS_BLANK etc.
+* @return Returns the picture, or a null pixmap if picture is out of range.
+*/
+QPixmap atlasPixmap( int picture );
+/**
+* Gets pictures that follow each other in the atlas, for a QCanvasPixmapArray.
+* @param first The first picture, e.g. ATLAS_BLANK or ATLAS_WTB.
+* @param count How many pictures.
+* @return Returns the pictures in order.
+*/
+QValueList<QPixmap> atlasPixmaps( int first, int count );
+
+#endif  // ATLAS_H
@@ -0,0 +1,469 @@
+/** @file benchmain.cpp
+ *  othello-bench, times the rules and the classic AI on a fixed set of
+ *  positions (benchpositions.txt). Each benchmark runs over the whole
+ *  set, repeated until a sample takes long enough to time, and several
+ *  samples give the spread. Reports nanoseconds per operation: the
+ *  median of the samples, their mean and standard deviation, and the
+ *  fastest sample.
+ *
+ *  usage: othello-bench [options] [benchmark...]
+ *    -p file       positions (default benchpositions.txt)
+ *    -s samples    samples of each benchmark (default 15)
+ *    -t seconds    least time of a sample (default 0.02)
+ *    -o file       also write the results as JSON
+ *    -c file       compare with JSON results written before
+ *    -r percent    slowdown over the baseline that counts as a regression
+ *                  (default 5)
+ *  Without benchmark names every benchmark runs. Returns 2 if a
+ *  benchmark is slower than the baseline by more than -r percent and
+ *  by more than the spread of the two measurements.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include "ai.h"
+#include "rules.h"
+#include "position.h"
+#include "search.h"
+
+#define DEFAULT_POSITIONS "benchpositions.txt"
+
+/**
+* @short A benchmark position in the form the rules and the AI use.
+* @param TRules board, the stones.
+* @param unsigned int player, colour of the player to move.
+* @param TMoveList moves, the player's legal moves.
+*/
+typedef struct{
+	TRules board;
+	unsigned int player;
+	TMoveList moves;
+	} TBenchPosition;
+
+/**
+* One pass of a benchmark over every position.
+* @return Returns the number of operations done.
+*/
+typedef uint64_t (*TBenchFunction)(std::vector<TBenchPosition> &positions);
+
+/**
+* @short A benchmark and what one operation of it is.
+*/
+typedef struct{
+	const char *name;
+	const char *operation;
+	TBenchFunction run;
+	} TBenchmark;
+
+/**
+* @short Timing of a benchmark, in nanoseconds per operation.
+*/
+typedef struct{
+	double median;
+	double mean;
+	double deviation;
+	double fastest;
+	int samples;
+	uint64_t operations;
+	} TBenchResult;
+
+/// Results are added here so the compiler can't drop the work.
+static volatile uint64_t sink;
+
+static uint64_t benchStoneAt(std::vector<TBenchPosition> &positions)
+{
+	uint64_t sum=0;
+	unsigned int i;
+	TCoord place;
+
+	for(i=0; i<positions.size(); i++)
+		for(place.y=0; place.y<BOARDSIZE; place.y++)
+			for(place.x=0; place.x<BOARDSIZE; place.x++)
+				sum+=positions[i].board.stoneAt(place);
+	sink+=sum;
+	return positions.size()*BOARDSIZE*BOARDSIZE;
+}
+
+static uint64_t benchRulesSetStone(std::vector<TBenchPosition> &positions)
+{
+	uint64_t count=0;
+	unsigned int i;
+	int j;
+
+	for(i=0; i<positions.size(); i++)
+		for(j=0; j<positions[i].moves.count; j++)
+		{
+			TRules board=positions[i].board;
+			sink+=board.rulesSetStone(squareCoord(positions[i].moves.square[j]), positions[i].player);
+			count++;
+		}
+	return count;
+}
+
+/// flipDir() is private, turnStones() calls it for all eight directions.
+static uint64_t benchTurnStones(std::vector<TBenchPosition> &positions)
+{
+	uint64_t count=0;
+	unsigned int i;
+	int j;
+
+	for(i=0; i<positions.size(); i++)
+		for(j=0; j<positions[i].moves.count; j++)
+		{
+			TRules board=positions[i].board;
+			sink+=board.turnStones(squareCoord(positions[i].moves.square[j]), positions[i].player);
+			count++;
+		}
+	return count;
+}
+
+static uint64_t benchMovePossible(std::vector<TBenchPosition> &positions)
+{
+	unsigned int i;
+
+	for(i=0; i<positions.size(); i++)
+		sink+=positions[i].board.movePossible(positions[i].player);
+	return positions.size();
+}
+
+static uint64_t benchPossibleMoves(std::vector<TBenchPosition> &positions)
+{
+	TMoveList moves;
+	unsigned int i;
+
+	for(i=0; i<positions.size(); i++)
+	{
+		possibleMoves(positions[i].board, positions[i].player, &moves);
+		sink+=moves.count;
+	}
+	return positions.size();
+}
+
+static uint64_t benchCountLiberties(std::vector<TBenchPosition> &positions)
+{
+	unsigned int i;
+
+	for(i=0; i<positions.size(); i++)
+		sink+=countLiberties(positions[i].board, positions[i].player);
+	return positions.size();
+}
+
+static uint64_t benchEvaluateLocation(std::vector<TBenchPosition> &positions)
+{
+	uint64_t count=0;
+	unsigned int i;
+	int j;
+
+	for(i=0; i<positions.size(); i++)
+		for(j=0; j<positions[i].moves.count; j++)
+		{
+			sink+=evaluateLocation(positions[i].board, squareCoord(positions[i].moves.square[j]),
+				positions[i].player);
+			count++;
+		}
+	return count;
+}
+
+static uint64_t benchMoveScore(std::vector<TBenchPosition> &positions)
+{
+	uint64_t count=0;
+	unsigned int i;
+	int j;
+
+	for(i=0; i<positions.size(); i++)
+		for(j=0; j<positions[i].moves.count; j++)
+		{
+			sink+=moveScore(positions[i].board, positions[i].player,
+				squareCoord(positions[i].moves.square[j]));
+			count++;
+		}
+	return count;
+}
+
+static uint64_t benchSortScores(std::vector<TBenchPosition> &positions)
+{
+	TMoveList moves;
+	unsigned int i;
+
+	for(i=0; i<positions.size(); i++)
+	{
+		moves=positions[i].moves;
+		sortScores(positions[i].board, &moves, positions[i].player);
+		sink+=moves.square[0];
+	}
+	return positions.size();
+}
+
+static uint64_t benchFindMove(std::vector<TBenchPosition> &positions)
+{
+	TCoord move;
+	unsigned int i;
+
+	for(i=0; i<positions.size(); i++)
+	{
+		move=findMove(positions[i].board, positions[i].player);
+		sink+=move.x+move.y;
+	}
+	return positions.size();
+}
+
+static const TBenchmark benchmarks[]={
+	{"stoneAt", "square", benchStoneAt},
+	{"rulesSetStone", "move", benchRulesSetStone},
+	{"turnStones", "move", benchTurnStones},
+	{"movePossible", "position", benchMovePossible},
+	{"possibleMoves", "position", benchPossibleMoves},
+	{"countLiberties", "position", benchCountLiberties},
+	{"evaluateLocation", "move", benchEvaluateLocation},
+	{"moveScore", "move", benchMoveScore},
+	{"sortScores", "position", benchSortScores},
+	{"findMove", "position", benchFindMove},
+	{NULL, NULL, NULL}
+	};
+
+static void usage()
+{
+	int i;
+
+	fprintf(stderr, "usage: othello-bench [-p file] [-s samples] [-t seconds] [-o file] [-c file] [-r percent] [benchmark...]\n"
+		"benchmarks:");
+	for(i=0; benchmarks[i].name != NULL; i++)
+		fprintf(stderr, " %s", benchmarks[i].name);
+	fprintf(stderr, "\n");
+	exit(1);
+}
+
+/**
+* Reads the positions, and the player to move in each.
+* @return Returns the number of positions, -1 if the file can't be read.
+*/
+static int readPositions(const char *path, std::vector<TBenchPosition> &positions)
+{
+	char line[256];
+	TBenchPosition bench;
+	TPosition pos;
+	FILE *file;
+	int length, square;
+	uint64_t bit;
+	TCoord place;
+
+	file=fopen(path, "r");
+	if(file == NULL)
+		return -1;
+
+	while(fgets(line, sizeof(line), file) != NULL)
+	{
+		if(line[0] == '#' || (length=parsePosition(line, &pos)) == -1)
+			continue;
+		/// The side to move is the last character read.
+		bench.player=(line[length-1] == 'O' || line[length-1] == 'o') ? WHITE : BLACK;
+		for(square=0; square<SQUARES; square++)
+		{
+			bit=(uint64_t)1 << square;
+			place=squareCoord(square);
+			if(pos.own & bit)
+				bench.board.setStone(place, bench.player);
+			else if(pos.enemy & bit)
+				bench.board.setStone(place, (bench.player == BLACK) ? WHITE : BLACK);
+			else
+				bench.board.setStone(place, BLANK);
+		}
+		possibleMoves(bench.board, bench.player, &bench.moves);
+		positions.push_back(bench);
+	}
+
+	fclose(file);
+	return positions.size();
+}
+
+/**
+* Times a benchmark.
+*/
+static void runBenchmark(const TBenchmark *bench, std::vector<TBenchPosition> &positions,
+	int samples, double seconds, TBenchResult *result)
+{
+	std::vector<double> times;
+	uint64_t passes=1, operations, i;
+	double start, took, sum=0, squares=0;
+	int sample;
+
+	/// Warm up, and find how many passes make a sample long enough.
+	for(;;)
+	{
+		start=searchClock();
+		for(i=0; i<passes; i++)
+			operations=bench->run(positions);
+		took=searchClock()-start;
+		if(took >= seconds)
+			break;
+		passes=(took > seconds/100) ? (uint64_t)(passes*seconds*1.2/took)+1 : passes*10;
+	}
+
+	for(sample=0; sample<samples; sample++)
+	{
+		start=searchClock();
+		for(i=0; i<passes; i++)
+			bench->run(positions);
+		took=searchClock()-start;
+		times.push_back(took*1e9/(passes*operations));
+	}
+
+	std::sort(times.begin(), times.end());
+	for(sample=0; sample<samples; sample++)
+	{
+		sum+=times[sample];
+		squares+=times[sample]*times[sample];
+	}
+	result->median=(samples % 2) ? times[samples/2] : (times[samples/2-1]+times[samples/2])/2;
+	result->mean=sum/samples;
+	result->deviation=(samples > 1) ? sqrt(fmax(0, (squares-sum*sum/samples)/(samples-1))) : 0;
+	result->fastest=times[0];
+	result->samples=samples;
+	result->operations=operations;
+}
+
+/**
+* Reads results written by writeResults(). Only the fields this program
+* writes are understood, one benchmark per line.
+* @return Returns the number of benchmarks, -1 if the file can't be read.
+*/
+static int readBaseline(const char *path, std::map<std::string, TBenchResult> &baseline)
+{
+	char line[1024], name[64];
+	TBenchResult result;
+	FILE *file;
+
+	file=fopen(path, "r");
+	if(file == NULL)
+		return -1;
+
+	while(fgets(line, sizeof(line), file) != NULL)
+	{
+		memset(&result, 0, sizeof(result));
+		if(sscanf(line, " {\"name\": \"%63[^\"]\", \"median_ns\": %lf, \"mean_ns\": %lf, \"stddev_ns\": %lf",
+			name, &result.median, &result.mean, &result.deviation) == 4)
+			baseline[name]=result;
+	}
+
+	fclose(file);
+	return baseline.size();
+}
+
+/**
+* Writes the results as JSON.
+* @return Returns 0, or -1 if the file can't be written.
+*/
+static int writeResults(const char *path, const char *positions, int count,
+	const std::vector<const TBenchmark *> &run, const std::vector<TBenchResult> &results)
+{
+	FILE *file;
+	unsigned int i;
+
+	file=fopen(path, "w");
+	if(file == NULL)
+		return -1;
+
+	fprintf(file, "{\"positions\": \"%s\", \"count\": %d, \"benchmarks\": [\n", positions, count);
+	for(i=0; i<run.size(); i++)
+		fprintf(file, "  {\"name\": \"%s\", \"median_ns\": %.3f, \"mean_ns\": %.3f, \"stddev_ns\": %.3f, "
+			"\"min_ns\": %.3f, \"samples\": %d, \"ops\": %llu, \"op\": \"%s\"}%s\n",
+			run[i]->name, results[i].median, results[i].mean, results[i].deviation,
+			results[i].fastest, results[i].samples, (unsigned long long)results[i].operations,
+			run[i]->operation, (i+1 < run.size()) ? "," : "");
+	fprintf(file, "]}\n");
+
+	return (fclose(file) == 0) ? 0 : -1;
+}
+
+int main(int argc, char *argv[])
+{
+	std::vector<TBenchPosition> positions;
+	std::vector<const TBenchmark *> run;
+	std::vector<TBenchResult> results;
+	std::map<std::string, TBenchResult> baseline;
+	std::map<std::string, TBenchResult>::iterator old;
+	const char *positionFile=DEFAULT_POSITIONS, *output=NULL, *compare=NULL;
+	int samples=15, opt, i, j, regressions=0;
+	double seconds=0.02, threshold=5, change, noise;
+
+	while((opt=getopt(argc, argv, "p:s:t:o:c:r:")) != -1)
+	{
+		switch (opt)
+		{
+			case 'p' : positionFile=optarg; break;
+			case 's' : samples=atoi(optarg); break;
+			case 't' : seconds=atof(optarg); break;
+			case 'o' : output=optarg; break;
+			case 'c' : compare=optarg; break;
+			case 'r' : threshold=atof(optarg); break;
+			default : usage();
+		}
+	}
+	if(samples < 1 || seconds <= 0)
+		usage();
+
+	for(i=optind; i<argc; i++)
+	{
+		for(j=0; benchmarks[j].name != NULL && strcmp(benchmarks[j].name, argv[i]) != 0; j++)
+			;
+		if(benchmarks[j].name == NULL)
+			usage();
+		run.push_back(&benchmarks[j]);
+	}
+	if(run.empty())
+		for(j=0; benchmarks[j].name != NULL; j++)
+			run.push_back(&benchmarks[j]);
+
+	if(readPositions(positionFile, positions) <= 0)
+	{
+		fprintf(stderr, "othello-bench: can't read positions from %s\n", positionFile);
+		return 1;
+	}
+	if(compare != NULL && readBaseline(compare, baseline) == -1)
+	{
+		fprintf(stderr, "othello-bench: can't read %s\n", compare);
+		return 1;
+	}
+
+	printf("%u positions from %s, %d samples of at least %g s\n",
+		(unsigned int)positions.size(), positionFile, samples, seconds);
+	printf("%-17s %12s %10s %12s %9s\n", "benchmark", "ns/op", "+-", "fastest", "op");
+	results.resize(run.size());
+	for(i=0; i<(int)run.size(); i++)
+	{
+		runBenchmark(run[i], positions, samples, seconds, &results[i]);
+		printf("%-17s %12.2f %9.1f%% %12.2f %9s", run[i]->name, results[i].median,
+			100*results[i].deviation/results[i].mean, results[i].fastest, run[i]->operation);
+
+		old=baseline.find(run[i]->name);
+		if(old != baseline.end() && old->second.median > 0)
+		{
+			change=100*(results[i].median/old->second.median-1);
+			/// A change within the spread of the samples is noise.
+			noise=100*(results[i].deviation+old->second.deviation)/old->second.median;
+			printf("  %+6.1f%%", change);
+			if(change > threshold && change > noise)
+			{
+				printf(" slower");
+				regressions++;
+			}
+		}
+		printf("\n");
+		fflush(stdout);
+	}
+
+	if(output != NULL && writeResults(output, positionFile, positions.size(), run, results) == -1)
+	{
+		fprintf(stderr, "othello-bench: can't write %s\n", output);
+		return 1;
+	}
+
+	return (regressions > 0) ? 2 : 0;
+}
@@ -18,13 +18,24 @@
 #include "boardview.h"
 #include "piece.h"
 #include "animpiece.h"
+#include "animclock.h"
 #include "gamerules.h"
+#include "gamestate.h"
 
 #include "aiplayer.h"
+#include "heatmark.h"
+#include "analysis.h"
+#include "position.h"
+#include "gamerecord.h"
+#include "explorerpanel.h"
+#include "turbodemo.h"
+#include "trace.h"
 
 #include <qwidget.h>
 #include <qevent.h>
 #include <qtimer.h>
+#include <qfile.h>
+#include <string.h>
 
 
 ////////
@@ -33,13 +44,34 @@
 
 BoardView::BoardView( QCanvas *canvas, QWidget *parent, const char *name )
     : QCanvasView( canvas, parent, name ),
-    rules(new GameRules()),
+    state(new GameState()),
     players(new QValueList<QObject*>)
 {
   animations=TRUE;
   animSpeed=1;
   animRandomJitter=FALSE;
 
+  weirdGame=FALSE;
+  analysing=FALSE;
+  analysis=NULL;
+  analysisTimer=new QTimer();
+  connect( analysisTimer, SIGNAL(timeout()), this, SLOT(refineAnalysis()) );
+  for (int i=0; i<ROWS*COLUMNS; i++) {
+    heatmarks[i]=NULL;
+  }
+  explorer=NULL;
+  for (int i=0; i<ROWS*COLUMNS; i++) {
+    pieceAt[i]=NULL;
+    distances[i]=0;
+  }
+  maxDistance=0;
+  animClock=new AnimClock(canvas);
+  turbo=NULL;
+  turboTimer=new QTimer();
+  connect( turboTimer, SIGNAL(timeout()), this, SLOT(showTurbo()) );
+  record=new TGameRecord;
+  clearGame(record);
+
   newMove();
   newBlackSingleGame();
 
@@ -51,6 +83,19 @@ BoardView::~BoardView()
   // tell the player objects to bugger off and die
   disconnectAllPlayers();
   delete Timer;
+
+  analysisTimer->stop();
+  delete analysisTimer;
+  delete analysis;
+  for (int i=0; i<ROWS*COLUMNS; i++) {
+    delete heatmarks[i];
+  }
+  turboTimer->stop();
+  delete turboTimer;
+  delete turbo;
+  delete record;
+  delete state;
+  delete animClock;
 }
 
 
@@ -69,40 +114,29 @@ void BoardView::updateView()
 // update board with flip animations
 void BoardView::animateBoard()
 {
-    QCanvasItemList list = canvas()->allItems();
-    QCanvasItemList::iterator it, jt;
+    TRACE_SCOPE("BoardView::animateBoard");
     double i=-1;
     double delay = 0;
-    for ( it = list.begin(); it != list.end(); ++it) {
-      if ( (*it)->rtti() == PIECE_RTTI )
-      {
-        Piece* p = (Piece*) (*it);
-
-        // the color of piece in internal othello board
-        unsigned int newFrame = rules->getPiece(  p->getPosition()  );
-
-        if ( p->getColor() != newFrame ) {
-          if (newFrame == BLANK || p->getColor() == BLANK) {
-            p->setColor(newFrame);
-            p->setFrame(newFrame);
+    measureMove();
+    for (unsigned int pos=0; pos<ROWS*COLUMNS; pos++) {
+      Piece* p = pieceAt[pos];
+      if (p == NULL) {
+        continue;
+      }
+
+      // the color of piece in internal othello board
+      unsigned int newFrame = state->rules()->getPiece( pos );
+
+      if ( p->getColor() != newFrame ) {
+        if (newFrame == BLANK || p->getColor() == BLANK) {
+          p->showColor(newFrame);
+        } else {
+          if (!animRandomJitter) {
+            i = animSpeed * animDelayAlgo(animType, p, &delay);
           } else {
-            for ( jt = list.begin(); jt != list.end(); ++jt) {
-                // find animation that matches the new state of the piece
-                if ( (*jt)->rtti() == ANIM_RTTI ) {
-                    AnimPiece* a = (AnimPiece*) (*jt);
-                    // correctly colored and in the correct position
-                    if ( (a->getResult() == newFrame) && (a->getPosition() == p->getPosition()) ) {
-                      if (!animRandomJitter) {
-                        i = animSpeed * animDelayAlgo(animType, p, &delay);
-                      } else {
-                        i++;
-                      }
-                      a->animPlay(p,i,animRandomJitter);
-                      break;
-                    }
-                }
-            }
+            i++;
           }
+          animClock->play(p,(newFrame == BLACK) ? WTB : BTW,i,animRandomJitter);
         }
       }
     }
@@ -112,19 +146,19 @@ double BoardView::animDelayAlgo(unsigned int algo, Piece* p, double* delay)
 {
   switch (algo) {
     case 1: // logarithmic away from center
-      return ( 5.5*(log10(3.5*distanceFromNew(p->getPosition()) - 3.0)) );
+      return ( 5.5*(log10(3.5*distances[p->getPosition()] - 3.0)) );
       break;
     case 2: // linear away from center
-      return ( distanceFromNew(p->getPosition()) - 1.0);
+      return ( distances[p->getPosition()] - 1.0);
       break;
     case 3: // logarithmic towards center
-      return (4*getMaximumDistance())/( 5.5*(log10(3.5*distanceFromNew(p->getPosition()) - 3.0)) );
+      return (4*maxDistance)/( 5.5*(log10(3.5*distances[p->getPosition()] - 3.0)) );
       break;
     case 4: // linear towards center
-      return (3*getMaximumDistance())/(1 + abs( distanceFromNew(p->getPosition()))) - 1.0;
+      return (3*maxDistance)/(1 + abs( distances[p->getPosition()])) - 1.0;
       break;
     case 5: // linear away from center, angled
-      return (distanceFromNew(p->getPosition()) -1.0) + M_PI + angleFromNew(p->getPosition());
+      return (distances[p->getPosition()] -1.0) + M_PI + angleFromNew(p->getPosition());
       break;
     default:
       double retval = (*delay);
@@ -136,11 +170,9 @@ double BoardView::animDelayAlgo(unsigned int algo, Piece* p, double* delay)
 // angle from new piece
 double BoardView::angleFromNew(unsigned int pos)
 {
-  QValueList<unsigned int>::iterator changes = rules->getChanges();
-  changes++;
-  unsigned int newpos = (*changes);
-  TCoord p = rules->uiToTCoord(pos);
-  TCoord n = rules->uiToTCoord(newpos);
+  unsigned int newpos = state->rules()->getLastMove();
+  TCoord p = state->rules()->uiToTCoord(pos);
+  TCoord n = state->rules()->uiToTCoord(newpos);
 
   double diff_x = p.x - n.y;
   double diff_y = p.y - n.y;
@@ -149,31 +181,26 @@ double BoardView::angleFromNew(unsigned int pos)
   return angle;
 }
 
-// maximum distance from new piece
-double BoardView::getMaximumDistance()
+// distances of the flipped pieces from the new one, for the animation delays
+void BoardView::measureMove()
 {
-  double maxDistance=0, temp=0;
-  QValueList<unsigned int>::iterator changes = rules->getChanges();
-  changes++;
-  changes++;
-  do {
-      temp=distanceFromNew((*changes));
-      if (temp > maxDistance) {
-              maxDistance = temp;
-      }
-      changes++;
-  } while ((*changes) != 0 && (*changes) < 64);
-  return maxDistance;
+  const unsigned int* flipped = state->rules()->getFlipped();
+  unsigned int count = state->rules()->getFlipCount();
+  maxDistance = 0;
+  for (unsigned int i=0; i<count; i++) {
+    distances[flipped[i]] = distanceFromNew(flipped[i]);
+    if (distances[flipped[i]] > maxDistance) {
+      maxDistance = distances[flipped[i]];
+    }
+  }
 }
 
 // distance from new piece in pieces
 double BoardView::distanceFromNew(unsigned int pos)
 {
-  QValueList<unsigned int>::iterator changes = rules->getChanges();
-  changes++;
-  unsigned int newpos = (*changes);
-  TCoord p = rules->uiToTCoord(pos);
-  TCoord n = rules->uiToTCoord(newpos);
+  unsigned int newpos = state->rules()->getLastMove();
+  TCoord p = state->rules()->uiToTCoord(pos);
+  TCoord n = state->rules()->uiToTCoord(newpos);
 
   // double diff  = sqrt( pow((float)p.x-n.x,2) + pow((float)p.y-n.y,2) );
   double abs_x = abs(p.x - n.x);
@@ -184,19 +211,52 @@ double BoardView::distanceFromNew(unsigned int pos)
 // set piece frames and colors according to current state, no animations
 void BoardView::clearBoard()
 {
+  for (unsigned int pos=0; pos<ROWS*COLUMNS; pos++) {
+    if (pieceAt[pos] != NULL) {
+      unsigned int newFrame = state->rules()->getPiece( pos );
+      pieceAt[pos]->showColor( newFrame );
+    }
+  }
+  animClock->stopAll();
+}
+
+// set piece frames and colors to bitboards, no animations
+void BoardView::showPosition(uint64_t black, uint64_t white)
+{
+  for (unsigned int pos=0; pos<ROWS*COLUMNS; pos++) {
+    if (pieceAt[pos] != NULL) {
+      unsigned int newFrame = ((black >> pos) & 1) ? BLACK : ((white >> pos) & 1) ? WHITE : BLANK;
+      pieceAt[pos]->showColor( newFrame );
+    }
+  }
+}
+
+// index the pieces on the canvas by position
+void BoardView::findSprites()
+{
+  for (int pos=0; pos<ROWS*COLUMNS; pos++) {
+    pieceAt[pos] = NULL;
+  }
+
   QCanvasItemList list = canvas()->allItems();
   QCanvasItemList::iterator it;
   for ( it = list.begin(); it != list.end(); ++it) {
     if ( (*it)->rtti() == PIECE_RTTI ) {
-      unsigned int newFrame = rules->getPiece( ((Piece*)(*it))->getPosition() );
-      ((Piece*)(*it))->setColor( newFrame );
-      ((Piece*)(*it))->setFrame( newFrame );
-    } else if ( (*it)->rtti() == ANIM_RTTI ) {
-      ((AnimPiece*)(*it))->stopPlaying();
+      Piece* p = (Piece*)(*it);
+      if (p->getPosition() < ROWS*COLUMNS) {
+        pieceAt[p->getPosition()] = p;
+      }
     }
   }
 }
 
+// the animations are made as the flips need them, from these frames
+void BoardView::setAnimFrames( QCanvasPixmapArray* btw, QCanvasPixmapArray* wtb )
+{
+  animClock->setFrames( BTW, btw );
+  animClock->setFrames( WTB, wtb );
+}
+
 // return true if there's space for another player, else false
 bool BoardView::isSpace()
 {
@@ -220,6 +280,9 @@ bool BoardView::connectPlayer(QObject* newPlayer)
         // listen to the death throes of the player
         connect (newPlayer, SIGNAL( disconnectMe(QObject*) ),
                       this, SLOT( disconnectPlayer(QObject*) ));
+        // and to what it is thinking about
+        connect (newPlayer, SIGNAL( thinking(const QString&) ),
+                      this, SLOT( playerThinking(const QString&) ));
         return true;
        
   } else {
@@ -254,6 +317,74 @@ double BoardView::getAnimSpeed()
   return animSpeed;
 }
 
+// analysis mode on/off, the marks and the analysis are made on first use
+void BoardView::setAnalysis(bool on)
+{
+  analysing = on;
+  if (analysing && analysis == NULL) {
+    analysis = new TAnalysis();
+    for (int i=0; i<ROWS*COLUMNS; i++) {
+      heatmarks[i] = new HeatMark(canvas());
+      heatmarks[i]->setPosition(i);
+    }
+  }
+  restartAnalysis();
+}
+// get analysis mode
+bool BoardView::getAnalysis()
+{
+  return analysing;
+}
+
+// explorer to update on every move, NULL for none
+void BoardView::setExplorer( ExplorerPanel* panel )
+{
+  explorer = panel;
+  showExplorer();
+}
+
+// write the record of the game so far to a file of its own
+bool BoardView::saveGame( const QString& path )
+{
+  TGameWriter writer;
+  if (writer.open(QFile::encodeName(path), false) == -1) {
+    return FALSE;
+  }
+  writer.write(record);
+  return writer.close() == 0;
+}
+
+// replay the first game of a file move by move, checking each move
+bool BoardView::loadGame( const QString& path )
+{
+  TGameReader reader;
+  TGameRecord game;
+  if (reader.open(QFile::encodeName(path)) == -1 || reader.read(&game) != 1) {
+    return FALSE;
+  }
+
+  disconnectAllPlayers();
+  space = 0;
+  newGame(BOTH, game.flags & GAME_WEIRD);
+
+  // the rules pass by themselves, passes in the record only tell whose turn it is
+  unsigned int turn = BLACK;
+  for (int i=0; i<game.count; i++) {
+    if (game.moves[i] != PASS_MOVE &&
+        (state->rules()->getTurn() != turn || !state->play(game.moves[i]))) {
+      newGame(BOTH);
+      return FALSE;
+    }
+    turn = (turn == BLACK) ? WHITE : BLACK;
+  }
+
+  *record = game;
+  moveClock.start();
+  clearBoard();
+  newMove();
+  return TRUE;
+}
+
 
 ////////
 // PROTECTED METHODS
@@ -262,22 +393,22 @@ double BoardView::getAnimSpeed()
 // process mouseclicks
 void BoardView::contentsMousePressEvent( QMouseEvent *e )
 {
-    // a list of all items underneath the mouse when it was pressed
-    QCanvasItemList list = canvas()->collisions(e->pos());
+    // the squares are a grid, the analysis marks on top of them don't matter
+    int x = e->pos().x() / SQUARE_W;
+    int y = e->pos().y() / SQUARE_H;
+    if (e->pos().x() < 0 || e->pos().y() < 0 || x >= COLUMNS || y >= ROWS) {
+      return;
+    }
 
-    // RTTI of a QCanvasSprite is 1
-    if ( !list.isEmpty() && list.first()->rtti() == PIECE_RTTI )
-    {
-       Piece* p = (Piece*)list.first();
-       if (p->frame() == BLANK) {
-         unsigned int pos = p->getPosition();
-         if (player != BLANK &&
-             (player == BOTH || rules->getTurn() == player) &&
-             makeMove(pos)
-            ) { // something to process after move made?
-         }
-       }
-    }    
+    unsigned int pos = x + y*COLUMNS;
+    Piece* p = pieceAt[pos];
+    if (p != NULL && p->frame() == BLANK) {
+      if (player != BLANK &&
+          (player == BOTH || state->rules()->getTurn() == player) &&
+          makeMove(pos)
+         ) { // something to process after move made?
+      }
+    }
 }
 
 
@@ -287,7 +418,7 @@ void BoardView::contentsMousePressEvent( QMouseEvent *e )
 
 // process external move calls
 void BoardView::extMove(unsigned int pos) {
-  if (rules->getTurn() != player || // not local player's turn, ie. external player's turn
+  if (state->rules()->getTurn() != player || // not local player's turn, ie. external player's turn
       player == BLANK) { // [computer vs computer] or [network client vs network client]
       makeMove(pos);
   }
@@ -302,9 +433,7 @@ void BoardView::newBlackSingleGame()
   disconnectAllPlayers();
   space = 1;
 
-  AIPlayer* ai = new AIPlayer(WHITE);
-  connectPlayer(ai);
-  connect( this, SIGNAL(moveMade(unsigned int)), ai, SLOT(extMove(unsigned int)));
+  connectPlayer( new AIPlayer(WHITE, state) );
 
   newGame(BLACK);
 }
@@ -315,9 +444,7 @@ void BoardView::newWhiteSingleGame()
   disconnectAllPlayers();
   space = 1;
 
-  AIPlayer* ai = new AIPlayer(BLACK);
-  connectPlayer(ai);
-  connect( this, SIGNAL(moveMade(unsigned int)), ai, SLOT(extMove(unsigned int)));
+  connectPlayer( new AIPlayer(BLACK, state) );
 
   newGame(WHITE);
 }
@@ -346,14 +473,84 @@ void BoardView::newDemoGame()
   disconnectAllPlayers();
   space = 2;
 
-  AIPlayer* ai = new AIPlayer(WHITE);
-  connectPlayer(ai);
-  connect( this, SIGNAL(moveMade(unsigned int)), ai, SLOT(extMove(unsigned int)));
-  ai = new AIPlayer(BLACK);
-  connectPlayer(ai);
-  connect( this, SIGNAL(moveMade(unsigned int)), ai, SLOT(extMove(unsigned int)));
+  connectPlayer( new AIPlayer(WHITE, state) );
+  connectPlayer( new AIPlayer(BLACK, state) );
+
+  newGame(BLANK);
+}
+
+// computer vs computer as fast as it goes, shown a frame at a time
+void BoardView::newTurboDemo()
+{
+  disconnectAllPlayers();
+  space = 0;
 
   newGame(BLANK);
+  if (turbo == NULL) {
+    turbo = new TTurboDemo();
+  }
+  if (turbo->start(TURBO_DEPTH) == 0) {
+    turboTimer->start( TURBO_FRAME, FALSE );
+  }
+}
+
+// draw the latest position of the turbo demo, no animations
+void BoardView::showTurbo()
+{
+  TTurboSample sample;
+  turbo->sample(&sample);
+  showPosition(sample.black, sample.white);
+  canvas()->update();
+
+  QString msg;
+  msg.sprintf( "Turbo demo: %u games, black won %u, white won %u, %.0f games/min.",
+               sample.games, sample.blackWins, sample.whiteWins,
+               (sample.seconds > 0) ? 60*sample.games/sample.seconds : 0.0 );
+  emit moveUpdate( msg );
+}
+
+// back a ply, against the computer back to the player's turn
+void BoardView::undoMove()
+{
+  unsigned int ply = state->ply();
+  if (ply == 0) {
+    return;
+  }
+  ply--;
+  if (player == BLACK || player == WHITE) {
+    while (ply > 0 && state->snapshot(ply).turn() != player) {
+      ply--;
+    }
+  }
+  jumpTo(ply);
+}
+
+// forward a ply, against the computer up to the player's turn
+void BoardView::redoMove()
+{
+  unsigned int ply = state->ply();
+  if (ply == state->plies()) {
+    return;
+  }
+  ply++;
+  if (player == BLACK || player == WHITE) {
+    while (ply < state->plies() && state->snapshot(ply).turn() != player) {
+      ply++;
+    }
+  }
+  jumpTo(ply);
+}
+
+// the starting position, the moves stay for redo
+void BoardView::firstMove()
+{
+  jumpTo(0);
+}
+
+// the furthest position played
+void BoardView::lastMove()
+{
+  jumpTo(state->plies());
 }
 
 // disconnects player
@@ -362,7 +559,23 @@ void BoardView::disconnectPlayer(QObject* exPlayer) {
                        this, SLOT( disconnectPlayer(QObject*) ));
        disconnect (exPlayer, SIGNAL( makeMove(unsigned int) ),
                        this, SLOT( extMove(unsigned int) ));
-       disconnect (this, SIGNAL(moveMade(unsigned int)), exPlayer, SLOT(extMove(unsigned int)));
+       disconnect (exPlayer, SIGNAL( thinking(const QString&) ),
+                       this, SLOT( playerThinking(const QString&) ));
+       // and stop telling it about the game
+       disconnect (state, 0, exPlayer, 0);
+}
+
+// show what a player is thinking about
+void BoardView::playerThinking(const QString& msg) {
+  emit moveUpdate( msg );
+}
+
+// analyse a bit more, stop the timer when every move is solved
+void BoardView::refineAnalysis() {
+  if (!analysis->refine(ANALYSIS_SLICE)) {
+    analysisTimer->stop();
+  }
+  showAnalysis();
 }
 
 
@@ -375,18 +588,27 @@ void BoardView::disconnectPlayer(QObject* exPlayer) {
 // player values: BLACK, WHITE, BOTH (two player game), BLANK (ai vs ai)
 void BoardView::newGame(unsigned int new_player, bool weird)
 {
+  if (turbo != NULL) {
+    turboTimer->stop();
+    turbo->stop();
+  }
   player = new_player;
+  weirdGame = weird;
   
-  // ditch old rules, make new ones
-  std::auto_ptr<GameRules>temp = rules;
-  rules = std::auto_ptr<GameRules>( new GameRules(weird) );
+
+  // start a new record, named after who plays which colour
+  clearGame(record);
+  strcpy(record->black, (player == BLACK || player == BOTH) ? "Human" : "Computer");
+  strcpy(record->white, (player == WHITE || player == BOTH) ? "Human" : "Computer");
+  record->flags = GAME_TIMES | (weird ? GAME_WEIRD : 0);
+  moveClock.start();
+
+  // the players hear of it and look whose turn it is
+  state->newGame(weird);
 
   // clear board and update
   clearBoard();
   newMove();
-  
-  // tell ai to start
-  if (player != BLACK) { emit moveMade(0); }
 }
 
 
@@ -402,39 +624,150 @@ void BoardView::disconnectAllPlayers () {
 }
 
 
+// analyse the position on the board from scratch, keeping the analysis tables
+void BoardView::restartAnalysis()
+{
+  if (analysis == NULL) {
+    return;
+  }
+
+  unsigned int turn = state->rules()->getTurn();
+  if (analysing && turn != BLANK && !weirdGame) {
+    analysis->setPosition( positionFromRules(*state->rules(), turn) );
+    analysisTimer->start( 0, FALSE );
+    showAnalysis();
+  } else {
+    analysisTimer->stop();
+    for (int i=0; i<ROWS*COLUMNS; i++) {
+      heatmarks[i]->hide();
+    }
+    canvas()->update();
+  }
+}
+
+// put the scores on the empty squares, hide the rest of the marks
+void BoardView::showAnalysis()
+{
+  int best = analysis->best();
+  bool scored[ROWS*COLUMNS];
+
+  for (int i=0; i<ROWS*COLUMNS; i++) {
+    scored[i] = FALSE;
+  }
+  if (best != -1) {
+    int bestScore = analysis->move(best)->score;
+    for (int i=0; i<analysis->count(); i++) {
+      const TMoveScore* m = analysis->move(i);
+      if (m->move < ROWS*COLUMNS && m->depth > 0) {
+        heatmarks[m->move]->setScore(m->score, bestScore, m->exact);
+        heatmarks[m->move]->show();
+        scored[m->move] = TRUE;
+      }
+    }
+  }
+  // marks left as they were don't get their squares redrawn
+  for (int i=0; i<ROWS*COLUMNS; i++) {
+    if (!scored[i]) {
+      heatmarks[i]->hide();
+    }
+  }
+  canvas()->update();
+}
+
+// look the board up in the position index, which has only normal games
+void BoardView::showExplorer()
+{
+  if (explorer == NULL) {
+    return;
+  }
+
+  unsigned int turn = state->rules()->getTurn();
+  if (weirdGame) {
+    explorer->showNothing( "Weird games are not in the index." );
+  } else if (turn == BLANK) {
+    explorer->showNothing( "Game over." );
+  } else {
+    explorer->showPosition( positionFromRules(*state->rules(), turn) );
+  }
+}
+
 // make move to position pos, tell players move was made
 bool BoardView::makeMove(unsigned int pos)
 {
-  bool retval = rules->setPiece(pos);
+  unsigned int mover = state->rules()->getTurn();
+  bool retval = state->play(pos);
   if (retval) {
+      recordMove(pos, mover);
       newMove();
-      emit moveMade( pos ); // tells about the move
   }
   return retval;
 }
 
 
+// add a move to the record, and the opponent's pass if it has no moves
+void BoardView::recordMove(unsigned int pos, unsigned int mover)
+{
+  if (record->count+2 > GAME_MAX_MOVES) {
+    return;
+  }
+  int centis = QMIN(moveClock.restart()/10, 65535);
+  record->times[record->count] = centis;
+  record->moves[record->count++] = pos;
+  if (state->rules()->getTurn() == mover) {
+    record->times[record->count] = 0;
+    record->moves[record->count++] = PASS_MOVE;
+  } else if (state->rules()->getTurn() == BLANK) {
+    record->result = (int)state->rules()->getScore(BLACK) - (int)state->rules()->getScore(WHITE);
+  }
+}
+
+// the game goes to the ply, the players hear of it from the game
+void BoardView::jumpTo(unsigned int ply)
+{
+  if (turbo != NULL && turbo->running()) {
+    return;
+  }
+  if (ply == state->ply() || !state->jumpTo(ply)) {
+    return;
+  }
+
+  // the record still has the moves gone back from, for going forward again
+  GameSnapshot game = state->snapshot();
+  record->count = game.moves();
+  if (game.turn() == BLANK) {
+    record->result = (int)game.score(BLACK) - (int)game.score(WHITE);
+  } else {
+    record->result = GAME_NO_RESULT;
+  }
+  moveClock.start();
+
+  clearBoard();
+  newMove();
+}
+
 // do whatever needs to be done when a new move is made
 void BoardView::newMove()
 {
   updateView();
+  restartAnalysis();
+  showExplorer();
 
   // build statusbar signal message
   QString msg;
-  if (rules->getTurn() != BLANK) {
-    if (rules->getTurn() == BLACK) {
+  if (state->rules()->getTurn() != BLANK) {
+    if (state->rules()->getTurn() == BLACK) {
       msg = "Black's";
-    } else if (rules->getTurn() == WHITE) {
+    } else if (state->rules()->getTurn() == WHITE) {
       msg = "White's";
     }
-    if (rules->getTurn() == player) {
+    if (state->rules()->getTurn() == player) {
       msg += " (your)";
     }
     msg += " turn.";
   } else {
     unsigned int b_score, w_score;
-    b_score = rules->getScore(BLACK);
-    w_score = rules->getScore(WHITE);
+    b_score = state->rules()->getScore(BLACK);
+    w_score = state->rules()->getScore(WHITE);
 
     msg = "Game over! ";
 
@@ -19,9 +19,11 @@
 #define BOARDVIEW_H
 
 #include <memory>
+#include <stdint.h>
 #include <qcanvas.h>
 #include <qpoint.h>
 #include <qqueue.h>
+#include <qdatetime.h>
 
 #include "gamerules.h"
 
@@ -31,9 +33,22 @@ class QWidget;
 class QMouseEvent;
 class QTimer;
 class Piece;
+class AnimClock;
+class HeatMark;
+class TAnalysis;
+struct TGameRecord;
+class ExplorerPanel;
+class GameState;
+class TTurboDemo;
 
 #define BOTH 999999
 
+// seconds of analysis per timer tick, the GUI stays responsive in between
+#define ANALYSIS_SLICE 0.05
+
+// milliseconds between the frames of the turbo demo
+#define TURBO_FRAME 40
+
 /**
 * @short Handles othello game GUI.
 * @author Ilmari Heikkinen
@@ -80,6 +95,17 @@ class BoardView : public QCanvasView
     */
     void animateBoard();
     /**
+    * Finds the pieces on the canvas, so that they can be looked up by position.
+    * Call after putting them on the canvas, the board draws only those found.
+    */
+    void findSprites();
+    /**
+    * Sets the frames of the flip animations, which are made on the canvas as needed.
+    * @param btw The black-to-white frames.
+    * @param wtb The white-to-black frames.
+    */
+    void setAnimFrames( QCanvasPixmapArray* btw, QCanvasPixmapArray* wtb );
+    /**
     * Redraws the board without animations.
     */
     void clearBoard();
@@ -106,6 +132,35 @@ class BoardView : public QCanvasView
     * @return Returns the value of the animSpeed-property.
     */
     double getAnimSpeed();
+    /**
+    * Turns the analysis mode on and off. In analysis mode every legal move
+    * is scored in the background and the scores are shown on the empty squares.
+    * @param on TRUE to analyse, FALSE to stop.
+    */
+    void setAnalysis( bool on );
+    /**
+    * Get analysis mode.
+    * @return Returns TRUE if the moves are being analysed.
+    */
+    bool getAnalysis();
+    /**
+    * Sets the opening explorer to keep up to date with the board.
+    * @param panel The explorer, NULL to stop updating it.
+    */
+    void setExplorer( ExplorerPanel* panel );
+    /**
+    * Saves the game played so far to a game file, see gamerecord.h.
+    * @return TRUE if saved, FALSE if the file could not be written.
+    * @param path The file.
+    */
+    bool saveGame( const QString& path );
+    /**
+    * Replays the first game of a game file as a two player game, so that
+    * it can be looked at and continued.
+    * @return TRUE if loaded, FALSE if the file could not be read or the game has an illegal move.
+    * @param path The file.
+    */
+    bool loadGame( const QString& path );
     
   protected:
     /**
@@ -142,6 +197,30 @@ class BoardView : public QCanvasView
     * Starts a new game between two computer players.
     */
     void newDemoGame();
+    /**
+    * Starts games between two computer players that go as fast as the search does.
+    * The board shows the latest position every TURBO_FRAME milliseconds without
+    * animations, and the statusbar how many games have been played.
+    */
+    void newTurboDemo();
+    /**
+    * Takes back the last move, or in a game against the computer the moves back to
+    * the player's previous turn.
+    */
+    void undoMove();
+    /**
+    * Plays again a move taken back, or in a game against the computer the moves up to
+    * the player's next turn.
+    */
+    void redoMove();
+    /**
+    * Goes back to the start of the game, keeping the moves for redoMove().
+    */
+    void firstMove();
+    /**
+    * Goes forward past every move taken back.
+    */
+    void lastMove();
 
     /**
     * Disconnects a player from the board.
@@ -149,6 +228,21 @@ class BoardView : public QCanvasView
     */
     void disconnectPlayer( QObject* );
 
+    /**
+    * Passes a player's thinking report on to the statusbar.
+    * @param QString& The report.
+    */
+    void playerThinking( const QString& );
+
+    /**
+    * Runs the analysis for ANALYSIS_SLICE seconds and shows the scores. Gets called by analysisTimer.
+    */
+    void refineAnalysis();
+    /**
+    * Shows the latest position of the turbo demo. Gets called by turboTimer.
+    */
+    void showTurbo();
+
     
   signals:
     /**
@@ -156,11 +250,6 @@ class BoardView : public QCanvasView
     * @param QString& The new statusbar text.
     */
     void moveUpdate( const QString& ); // for statusbar textual update from newMove()
-    /**
-    * Updates players about new moves.
-    * @param unsigned Position of the new move.
-    */
-    void moveMade( unsigned int ); // signal to players of the location of the move made
             
   private:
     /**
@@ -182,12 +271,44 @@ class BoardView : public QCanvasView
     * Calls updateBoard to update GUI board. Emits a moveUpdate-signal to update the main window statusbar.
     */
     void newMove();
+    /**
+    * Adds a move to the game record, and a pass for the opponent if it
+    * is the same player's turn again.
+    * @param pos Square of the move.
+    * @param mover Colour that made the move.
+    */
+    void recordMove(unsigned int pos, unsigned int mover);
+    /**
+    * Goes to a ply of the game and redraws the board without animations. The record
+    * ends at the ply too. Does nothing during the turbo demo.
+    * @param ply Number of plies played, see GameState::jumpTo().
+    */
+    void jumpTo(unsigned int ply);
 
     /**
     * Disconnects all players (stops listening to their move requests and clears the player list).
     */
     void disconnectAllPlayers();
 
+    /**
+    * Starts analysing the current position, if in analysis mode.
+    */
+    void restartAnalysis();
+    /**
+    * Shows the analysis scores on the empty squares.
+    */
+    void showAnalysis();
+    /**
+    * Shows the position on the board in the opening explorer.
+    */
+    void showExplorer();
+    /**
+    * Sets the pieces to a position without animations.
+    * @param black Bitboard of the black pieces.
+    * @param white Bitboard of the white pieces.
+    */
+    void showPosition(uint64_t black, uint64_t white);
+
 /**
 * Calculates distance of position pos from the latest move.
 * @return Returns the distance in number of pieces.
@@ -198,15 +319,14 @@ double distanceFromNew(unsigned int pos);
 * Flip animation start delay algorithms. Calculates distance from new and returns a value based on that.
 * @return Returns a value to use as the base delay. Depends on the used algorithm.
 * @param algo The algorithm to use. Possible values are 0 (pseudo-random-fixed based on delay), 1 (logarithmic outwards from new piece), 2 (linear outwards from new piece), 3 (logarithmic towards new piece), 4 (linear towards new piece) and 5 (linear outwards from new piece based on angle).
-* @param p Pointer to piece to find the start delay for.
+* @param p Pointer to piece to find the start delay for, one flipped by the latest move (see measureMove()).
 * @param delay Pointer to delay value to modify. Currently used only with the 0-algorithm.
 */
 double animDelayAlgo(unsigned int algo, Piece* p, double* delay);
 /**
-* Gets maximum flip distance from new piece on the current board state. Used for doing towards-center timings.
-* @return Returns the maximum amount of flips in a single direction possible from the newest move.
+* Fills distances and maxDistance for the pieces flipped by the latest move.
 */
-double getMaximumDistance();
+void measureMove();
 /**
 * Calculates the angle of a given position from the new piece.
 * @return Returns the angle from the new piece. Range [0..2PI[
@@ -230,6 +350,63 @@ double angleFromNew(unsigned int pos);
     bool animRandomJitter;
 
     unsigned int animType;
+
+    /**
+    * Whether the current game uses the modified rules. The analysis only knows the normal ones.
+    */
+    bool weirdGame;
+    /**
+    * Analysis mode toggle.
+    */
+    bool analysing;
+    /**
+    * Background analysis of the current position, NULL until analysis mode is first used.
+    */
+    TAnalysis* analysis;
+    /**
+    * Keeps the analysis going between GUI events.
+    */
+    QTimer* analysisTimer;
+    /**
+    * Score marks of the squares, in GUI-format order.
+    */
+    HeatMark* heatmarks[ROWS*COLUMNS];
+    /**
+    * The piece on each square, in GUI-format order.
+    */
+    Piece* pieceAt[ROWS*COLUMNS];
+    /**
+    * Plays the flip animations.
+    */
+    AnimClock* animClock;
+    /**
+    * Distances of the pieces flipped by the latest move from the new piece, by position.
+    */
+    double distances[ROWS*COLUMNS];
+    /**
+    * Largest of the distances.
+    */
+    double maxDistance;
+    /**
+    * Opening explorer to update, NULL if none.
+    */
+    ExplorerPanel* explorer;
+    /**
+    * Games of the turbo demo, NULL until it is first used.
+    */
+    TTurboDemo* turbo;
+    /**
+    * Shows the turbo demo frame by frame.
+    */
+    QTimer* turboTimer;
+    /**
+    * The moves of the game so far, with the time each took.
+    */
+    TGameRecord* record;
+    /**
+    * Time since the last move.
+    */
+    QTime moveClock;
                                 
     /**
     * Color of player who uses the GUI.
@@ -241,9 +418,9 @@ double angleFromNew(unsigned int pos);
     unsigned int space; // two minus amt_of_players_connected
     QTimer *Timer;
     /**
-    * Internal othello board. The GUI is synchronized against this.
+    * The game, which tells the players about the moves. The GUI is synchronized against its board.
     */
-    auto_ptr<GameRules> rules; // internal othello board
+    GameState* state;
     /**
     * List of pointers to connected player objects.
     */
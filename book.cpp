@@ -0,0 +1,253 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "book.h"
+#include "position.h"
+
+TBook::TBook() : map(NULL), mapSize(0), table(NULL), count(0)
+{
+}
+
+/**
+* Destructor. Unmaps the file.
+*/
+TBook::~TBook()
+{
+	close();
+}
+
+/**
+* Maps the book file. Closes the previous one first.
+* @param const char *path, file name.
+* @return Returns 0 if the file was mapped, -1 if it does not exist or
+* is not a valid book.
+*/
+int TBook::open(const char *path)
+{
+	struct stat info;
+	const TBookHeader *header;
+	void *data;
+	int fd;
+
+	close();
+
+	fd=::open(path, O_RDONLY);
+	if(fd == -1)
+		return -1;
+
+	if(fstat(fd, &info) == -1 || (size_t)info.st_size < sizeof(TBookHeader))
+	{
+		::close(fd);
+		return -1;
+	}
+
+	/// Shared read-only mapping, all processes use the same pages.
+	data=mmap(NULL, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	::close(fd);
+	if(data == MAP_FAILED)
+		return -1;
+
+	header=(const TBookHeader *)data;
+	if(memcmp(header->magic, BOOK_MAGIC, sizeof(header->magic)) != 0 ||
+		header->version != BOOK_VERSION ||
+		header->recordSize != sizeof(TBookRecord) ||
+		sizeof(TBookHeader) + (size_t)header->count*sizeof(TBookRecord) > (size_t)info.st_size)
+	{
+		munmap(data, info.st_size);
+		return -1;
+	}
+
+	map=data;
+	mapSize=info.st_size;
+	table=(const TBookRecord *)((const char *)data + sizeof(TBookHeader));
+	count=header->count;
+
+	return 0;
+}
+
+/**
+* Unmaps the book file.
+*/
+void TBook::close()
+{
+	if(map != NULL)
+		munmap(map, mapSize);
+
+	map=NULL;
+	mapSize=0;
+	table=NULL;
+	count=0;
+}
+
+bool TBook::isOpen()
+{
+	return map != NULL;
+}
+
+unsigned int TBook::size()
+{
+	return count;
+}
+
+const TBookRecord *TBook::records()
+{
+	return table;
+}
+
+/**
+* Finds the book move for a position.
+* @param TPosition pos, position seen from the player to move.
+* @param TBookRecord *record, if not NULL, the record found is copied here.
+* Its move is translated back to the orientation of pos.
+* @return Returns the book move (0..63) for pos, or -1 if pos is not in
+* the book or has no move.
+*/
+int TBook::lookup(TPosition pos, TBookRecord *record)
+{
+	const TBookRecord *found;
+	TPosition key;
+	int sym, move;
+
+	if(table == NULL)
+		return -1;
+
+	key=canonicalPosition(pos, &sym);
+	found=findBookRecord(table, count, key);
+	if(found == NULL)
+		return -1;
+
+	/// The stored move is in canonical orientation, turn it back.
+	move=transformSquare(found->move, inverseSymmetry(sym));
+
+	if(record != NULL)
+	{
+		*record=*found;
+		record->own=pos.own;
+		record->enemy=pos.enemy;
+		record->move=move;
+	}
+
+	if(move < 0 || move >= SQUARES)
+		return -1;
+
+	return move;
+}
+
+/**
+* Finds a record in a sorted array of records by binary search.
+* @param const TBookRecord *table, records sorted by comparePositions().
+* @param unsigned int count, number of records.
+* @param TPosition key, canonical position to find.
+* @return Returns a pointer to the record, NULL if not found.
+*/
+const TBookRecord *findBookRecord(const TBookRecord *table, unsigned int count, TPosition key)
+{
+	unsigned int low=0, high=count, middle;
+	TPosition probe;
+	int order;
+
+	while(low < high)
+	{
+		middle=low+(high-low)/2;
+		probe.own=table[middle].own;
+		probe.enemy=table[middle].enemy;
+		order=comparePositions(probe, key);
+		if(order == 0)
+			return &table[middle];
+		if(order < 0)
+			low=middle+1;
+		else
+			high=middle;
+	}
+
+	return NULL;
+}
+
+/**
+* qsort() comparison for book records.
+*/
+static int compareRecords(const void *a, const void *b)
+{
+	const TBookRecord *ra=(const TBookRecord *)a;
+	const TBookRecord *rb=(const TBookRecord *)b;
+	TPosition pa, pb;
+	int order;
+
+	pa.own=ra->own;
+	pa.enemy=ra->enemy;
+	pb.own=rb->own;
+	pb.enemy=rb->enemy;
+
+	order=comparePositions(pa, pb);
+	if(order != 0)
+		return order;
+
+	/// Deeper records first, so they survive duplicate removal.
+	return (int)rb->depth - (int)ra->depth;
+}
+
+/**
+* Sorts records and writes them as a book file. Duplicate positions
+* keep the record with the greatest depth.
+* The file is written under a temporary name and renamed into place, so
+* readers never map a half-written book.
+* @param const char *path, file name.
+* @param TBookRecord *records, canonical records, sorted in place.
+* @param unsigned int count, number of records.
+* @return Returns 0 on success, -1 on write error.
+*/
+int writeBook(const char *path, TBookRecord *records, unsigned int count)
+{
+	TBookHeader header;
+	unsigned int i, unique=0;
+	char *temp;
+	FILE *file;
+	int retval=0;
+
+	qsort(records, count, sizeof(TBookRecord), compareRecords);
+
+	/// Drop duplicates, the deepest one is first.
+	for(i=0; i<count; i++)
+	{
+		if(unique > 0 && records[unique-1].own == records[i].own &&
+			records[unique-1].enemy == records[i].enemy)
+			continue;
+		records[unique++]=records[i];
+	}
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, BOOK_MAGIC, sizeof(header.magic));
+	header.version=BOOK_VERSION;
+	header.count=unique;
+	header.recordSize=sizeof(TBookRecord);
+
+	temp=(char *)malloc(strlen(path)+5);
+	if(temp == NULL)
+		return -1;
+	sprintf(temp, "%s.tmp", path);
+
+	file=fopen(temp, "wb");
+	if(file == NULL)
+	{
+		free(temp);
+		return -1;
+	}
+
+	if(fwrite(&header, sizeof(header), 1, file) != 1 ||
+		(unique > 0 && fwrite(records, sizeof(TBookRecord), unique, file) != unique))
+		retval=-1;
+	if(fclose(file) != 0)
+		retval=-1;
+
+	if(retval == 0 && rename(temp, path) != 0)
+		retval=-1;
+	if(retval == -1)
+		remove(temp);
+
+	free(temp);
+	return retval;
+}
@@ -0,0 +1,144 @@
+/** @file book.h
+ *  Opening book. The book file is a sorted array of fixed size records
+ *  keyed by canonical position. It is used straight from a read-only
+ *  memory mapping, so opening it costs nothing and the pages are shared
+ *  by every process using the same file.
+*/
+
+#ifndef BOOK_H
+#define BOOK_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "position.h"
+
+/// Book file looked up by the computer players
+#define DEFAULT_BOOK "othello.book"
+
+#define BOOK_MAGIC "OTHBOOK1"
+#define BOOK_VERSION 1
+
+/**
+* @short Header at the start of a book file.
+* @param char magic[8], BOOK_MAGIC without the terminating zero.
+* @param uint32_t version, BOOK_VERSION.
+* @param uint32_t count, number of records following the header.
+* @param uint32_t recordSize, sizeof(TBookRecord), for sanity checks.
+* @param uint32_t reserved, zero.
+*/
+typedef struct{
+	char magic[8];
+	uint32_t version;
+	uint32_t count;
+	uint32_t recordSize;
+	uint32_t reserved;
+	} TBookHeader;
+
+/**
+* @short One book position.
+*
+* The position is stored in canonical form (see canonicalPosition()),
+* and move is a square in that same orientation. Records are sorted by
+* comparePositions(). Fields are in host byte order.
+* @param uint64_t own, stones of the player to move.
+* @param uint64_t enemy, stones of the opponent.
+* @param int16_t score, value of the position for the player to move, in
+* the units of the search that built the book.
+* @param uint8_t move, best move (0..63), PASS_MOVE or NO_MOVE.
+* @param uint8_t depth, search depth the score came from.
+* @param uint32_t games, number of times the position has been expanded.
+*/
+typedef struct{
+	uint64_t own;
+	uint64_t enemy;
+	int16_t score;
+	uint8_t move;
+	uint8_t depth;
+	uint32_t games;
+	} TBookRecord;
+
+/**
+* @short Read-only view of a book file.
+*
+* open() maps the file into memory and lookup() does a binary search
+* directly in the mapping. Nothing is parsed or copied.
+*/
+class TBook
+{
+	public:
+
+TBook();
+
+/**
+* Destructor. Unmaps the file.
+*/
+~TBook();
+
+/**
+* Maps the book file. Closes the previous one first.
+* @param const char *path, file name.
+* @return Returns 0 if the file was mapped, -1 if it does not exist or
+* is not a valid book.
+*/
+int open(const char *path);
+
+/**
+* Unmaps the book file.
+*/
+void close();
+
+/**
+* @return Returns TRUE if a book file is mapped.
+*/
+bool isOpen();
+
+/**
+* @return Returns the number of positions in the book.
+*/
+unsigned int size();
+
+/**
+* Finds the book move for a position.
+* @param TPosition pos, position seen from the player to move.
+* @param TBookRecord *record, if not NULL, the record found is copied here.
+* Its move is translated back to the orientation of pos.
+* @return Returns the book move (0..63) for pos, or -1 if pos is not in
+* the book or has no move.
+*/
+int lookup(TPosition pos, TBookRecord *record);
+
+/**
+* @return Returns the records in file order, NULL if no book is open.
+*/
+const TBookRecord *records();
+
+	private:
+
+void *map;
+size_t mapSize;
+const TBookRecord *table;
+unsigned int count;
+};
+
+/**
+* Finds a record in a sorted array of records by binary search.
+* @param const TBookRecord *table, records sorted by comparePositions().
+* @param unsigned int count, number of records.
+* @param TPosition key, canonical position to find.
+* @return Returns a pointer to the record, NULL if not found.
+*/
+const TBookRecord *findBookRecord(const TBookRecord *table, unsigned int count, TPosition key);
+
+/**
+* Sorts records and writes them as a book file. Duplicate positions
+* keep the record with the greatest depth.
+* The file is written under a temporary name and renamed into place, so
+* readers never map a half-written book.
+* @param const char *path, file name.
+* @param TBookRecord *records, canonical records, sorted in place.
+* @param unsigned int count, number of records.
+* @return Returns 0 on success, -1 on write error.
+*/
+int writeBook(const char *path, TBookRecord *records, unsigned int count);
+
+#endif /* BOOK_H */
@@ -0,0 +1,522 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <algorithm>
+#include "bookbuilder.h"
+#include "book.h"
+#include "search.h"
+#include "position.h"
+#include "rules.h"
+#include "workpool.h"
+
+#define NODES_VERSION 1
+
+/**
+* @short Header of a builder checkpoint file.
+*/
+typedef struct{
+	char magic[8];
+	uint32_t version;
+	uint32_t count;
+	uint32_t nodeSize;
+	uint32_t depth;
+	} TNodesHeader;
+
+/**
+* @short Positions shared by the search threads.
+*/
+typedef struct{
+	const TPosition *positions;
+	const uint64_t *exclude;
+	int *scores;
+	int *moves;
+	int depth;
+	} TSearchJobs;
+
+/**
+* @short An out-of-book move waiting for expansion.
+*/
+typedef struct{
+	int cost;
+	TPosition pos;
+	} TCandidate;
+
+static bool cheaper(const TCandidate &a, const TCandidate &b)
+{
+	return a.cost < b.cost;
+}
+
+/**
+* Canonical position after a move.
+*/
+static TPosition childPosition(TPosition pos, int move)
+{
+	return canonicalPosition(playMove(pos, move), NULL);
+}
+
+/**
+* Searches position i of the job list.
+*/
+static void searchJob(int i, void *data)
+{
+	TSearchJobs *jobs=(TSearchJobs *)data;
+
+	jobs->scores[i]=searchPosition(jobs->positions[i], jobs->depth,
+		jobs->exclude[i], &jobs->moves[i], NULL);
+}
+
+/**
+* Clamps a score into a book field.
+*/
+static int16_t shortScore(int score)
+{
+	if(score > SCORE_INF)
+		return SCORE_INF;
+	if(score < -SCORE_INF)
+		return -SCORE_INF;
+	return (int16_t)score;
+}
+
+/**
+* Constructor. Puts the starting position in the book.
+* @param int depth, search depth for new positions.
+* @param int threads, number of searches run in parallel.
+*/
+TBookBuilder::TBookBuilder(int depth, int threads) : depth(depth), threads(threads)
+{
+	TRules start;
+
+	if(this->threads < 1)
+		this->threads=1;
+
+	root=canonicalPosition(positionFromRules(start, BLACK), NULL);
+	node(root);
+}
+
+TBookBuilder::~TBookBuilder()
+{
+}
+
+unsigned int TBookBuilder::size()
+{
+	return nodes.size();
+}
+
+int TBookBuilder::rootValue()
+{
+	return node(root)->value;
+}
+
+/**
+* Finds or creates the node for a canonical position.
+*/
+TBookNode *TBookBuilder::node(TPosition pos)
+{
+	TNodeMap::iterator it=nodes.find(pos);
+	TBookNode fresh;
+
+	if(it != nodes.end())
+		return &it->second;
+
+	memset(&fresh, 0, sizeof(fresh));
+	fresh.own=pos.own;
+	fresh.enemy=pos.enemy;
+	fresh.move=NO_MOVE;
+	fresh.altMove=NO_MOVE;
+	fresh.altValue=-SCORE_INF;
+
+	return &nodes.insert(TNodeMap::value_type(pos, fresh)).first->second;
+}
+
+/**
+* Returns the node of a position if it is in the book.
+*/
+TBookNode *TBookBuilder::findNode(TPosition pos)
+{
+	TNodeMap::iterator it=nodes.find(pos);
+
+	if(it == nodes.end())
+		return NULL;
+	return &it->second;
+}
+
+/**
+* Returns the moves of pos whose positions are already in the book.
+*/
+uint64_t TBookBuilder::bookMoves(TPosition pos)
+{
+	uint64_t moves=legalMoves(pos), inBook=0;
+	int sq;
+
+	while(moves)
+	{
+		sq=__builtin_ctzll(moves);
+		moves&=moves-1;
+		if(findNode(childPosition(pos, sq)) != NULL)
+			inBook|=1ULL << sq;
+	}
+
+	return inBook;
+}
+
+/**
+* Adds the positions of a game to the book. They are searched on the
+* next call to expand().
+* @param const int *moves, squares (0..63) or PASS_MOVE from the start.
+* @param int count, number of moves.
+* @param int maxPly, positions after this many moves are not added.
+* @return Returns the number of moves added, less than count if an
+* illegal move was found.
+*/
+int TBookBuilder::addGame(const int *moves, int count, int maxPly)
+{
+	TRules start;
+	TPosition pos=positionFromRules(start, BLACK);
+	int i;
+
+	node(root)->games++;
+
+	/// Game moves are in real orientation, only the nodes are canonical.
+	for(i=0; i<count && i<maxPly; i++)
+	{
+		if(moves[i] == PASS_MOVE)
+		{
+			if(legalMoves(pos) != 0)
+				return i;
+		} else if(moves[i] < 0 || moves[i] >= SQUARES || !((legalMoves(pos) >> moves[i]) & 1))
+			return i;
+
+		pos=playMove(pos, moves[i]);
+		node(canonicalPosition(pos, NULL))->games++;
+	}
+
+	return i;
+}
+
+/**
+* Searches the given nodes' out-of-book moves in parallel.
+*/
+int TBookBuilder::searchNodes(TPosition *list, int count)
+{
+	std::vector<uint64_t> exclude(count);
+	std::vector<int> scores(count), moves(count);
+	TSearchJobs jobs;
+	TBookNode *n;
+	int i;
+
+	if(count == 0)
+		return 0;
+
+	for(i=0; i<count; i++)
+		exclude[i]=bookMoves(list[i]);
+
+	jobs.positions=list;
+	jobs.exclude=&exclude[0];
+	jobs.scores=&scores[0];
+	jobs.moves=&moves[0];
+	jobs.depth=depth;
+	runJobs(searchJob, &jobs, count, threads);
+
+	for(i=0; i<count; i++)
+	{
+		n=node(list[i]);
+		n->altMove=moves[i];
+		n->altValue=shortScore(scores[i]);
+		n->depth=depth;
+		n->flags|=NODE_SEARCHED;
+
+		/// A pass can't be excluded from the search, drop it here.
+		if(moves[i] == PASS_MOVE && findNode(childPosition(list[i], PASS_MOVE)) != NULL)
+		{
+			n->altMove=NO_MOVE;
+			n->altValue=-SCORE_INF;
+		}
+	}
+
+	return count;
+}
+
+/**
+* Negamax of one node. Values already computed in this pass are in seen.
+*/
+int TBookBuilder::propagateNode(TPosition pos, std::map<TPosition, int, TPositionLess> &seen)
+{
+	std::map<TPosition, int, TPositionLess>::iterator it=seen.find(pos);
+	TBookNode *n=findNode(pos), *child;
+	uint64_t moves;
+	int best, bestMove, score, sq;
+
+	if(it != seen.end())
+		return it->second;
+
+	moves=legalMoves(pos);
+	best=n->altValue;
+	bestMove=n->altMove;
+
+	if(moves == 0)
+	{
+		child=findNode(childPosition(pos, PASS_MOVE));
+		if(legalMoves(playMove(pos, PASS_MOVE)) == 0)
+		{
+			/// Game over, the value is exact.
+			best=finalScore(pos);
+			bestMove=NO_MOVE;
+		} else if(child != NULL)
+		{
+			best=-propagateNode(childPosition(pos, PASS_MOVE), seen);
+			bestMove=PASS_MOVE;
+		}
+	}
+
+	while(moves)
+	{
+		sq=__builtin_ctzll(moves);
+		moves&=moves-1;
+
+		child=findNode(childPosition(pos, sq));
+		if(child == NULL)
+			continue;
+
+		score=-propagateNode(childPosition(pos, sq), seen);
+		if(score > best)
+		{
+			best=score;
+			bestMove=sq;
+		}
+	}
+
+	n->value=shortScore(best);
+	n->move=bestMove;
+	seen[pos]=n->value;
+
+	return n->value;
+}
+
+/**
+* Recomputes every value and best move from the leaves to the root.
+*/
+void TBookBuilder::propagate()
+{
+	std::map<TPosition, int, TPositionLess> seen;
+
+	propagateNode(root, seen);
+}
+
+/**
+* Finds the cheapest path cost from the root to every book position.
+* Following a book move costs what the player to move loses by it
+* compared to the best move, plus PLY_PENALTY.
+*/
+void TBookBuilder::rankNode(TPosition pos, int cost, std::map<TPosition, int, TPositionLess> &costs)
+{
+	std::map<TPosition, int, TPositionLess>::iterator it=costs.find(pos);
+	TBookNode *n, *child;
+	TPosition next;
+	uint64_t moves;
+	int sq;
+
+	if(it != costs.end() && it->second <= cost)
+		return;
+	costs[pos]=cost;
+
+	n=findNode(pos);
+	moves=legalMoves(pos);
+
+	if(moves == 0)
+	{
+		next=childPosition(pos, PASS_MOVE);
+		child=findNode(next);
+		if(child != NULL)
+			rankNode(next, cost+n->value+child->value, costs);
+		return;
+	}
+
+	while(moves)
+	{
+		sq=__builtin_ctzll(moves);
+		moves&=moves-1;
+
+		next=childPosition(pos, sq);
+		child=findNode(next);
+		if(child != NULL)
+			rankNode(next, cost+n->value+child->value+PLY_PENALTY, costs);
+	}
+}
+
+/**
+* Runs one round of expansion: searches the positions added by addGame(),
+* then adds up to count cheapest out-of-book moves and searches the new
+* positions and their parents in parallel.
+* @param int count, most positions to add.
+* @param int maxPly, positions deeper than this are not expanded.
+* @return Returns the number of positions searched.
+*/
+int TBookBuilder::expand(int count, int maxPly)
+{
+	std::map<TPosition, int, TPositionLess> costs;
+	std::map<TPosition, int, TPositionLess>::iterator it;
+	std::vector<TCandidate> candidates;
+	std::vector<TPosition> list;
+	TNodeMap::iterator nt;
+	TCandidate candidate;
+	TBookNode *n;
+	TPosition next;
+	int searched=0, i;
+
+	/// Seed positions first, expansion needs their values.
+	for(nt=nodes.begin(); nt != nodes.end(); ++nt)
+		if(!(nt->second.flags & NODE_SEARCHED))
+			list.push_back(nt->first);
+	if(!list.empty())
+	{
+		searched+=searchNodes(&list[0], list.size());
+		list.clear();
+	}
+	propagate();
+
+	/// Cheapest ways out of the book.
+	rankNode(root, 0, costs);
+	for(it=costs.begin(); it != costs.end(); ++it)
+	{
+		n=findNode(it->first);
+		if(n->altMove == NO_MOVE || countBits(n->own|n->enemy)-4 >= maxPly)
+			continue;
+		candidate.cost=it->second+n->value-n->altValue+PLY_PENALTY;
+		candidate.pos=it->first;
+		candidates.push_back(candidate);
+	}
+	std::sort(candidates.begin(), candidates.end(), cheaper);
+
+	/// Each new position is searched, and so is its parent, which needs
+	/// a new way out of the book.
+	for(i=0; i<(int)candidates.size() && i<count; i++)
+	{
+		n=findNode(candidates[i].pos);
+		next=childPosition(candidates[i].pos, n->altMove);
+		if(findNode(next) == NULL)
+		{
+			node(next);
+			list.push_back(next);
+		}
+		list.push_back(candidates[i].pos);
+	}
+	if(!list.empty())
+		searched+=searchNodes(&list[0], list.size());
+
+	propagate();
+
+	return searched;
+}
+
+/**
+* Reads a checkpoint written by save(). Nodes are added to the book.
+* @param const char *path, checkpoint file.
+* @return Returns 0 on success, -1 if the file can't be read.
+*/
+int TBookBuilder::load(const char *path)
+{
+	TNodesHeader header;
+	TBookNode n;
+	TPosition pos;
+	FILE *file;
+	uint32_t i;
+
+	file=fopen(path, "rb");
+	if(file == NULL)
+		return -1;
+
+	if(fread(&header, sizeof(header), 1, file) != 1 ||
+		memcmp(header.magic, NODES_MAGIC, sizeof(header.magic)) != 0 ||
+		header.version != NODES_VERSION || header.nodeSize != sizeof(TBookNode))
+	{
+		fclose(file);
+		return -1;
+	}
+
+	for(i=0; i<header.count; i++)
+	{
+		if(fread(&n, sizeof(n), 1, file) != 1)
+		{
+			fclose(file);
+			return -1;
+		}
+		pos.own=n.own;
+		pos.enemy=n.enemy;
+		*node(pos)=n;
+	}
+
+	fclose(file);
+	return 0;
+}
+
+/**
+* Writes all nodes to a checkpoint file, atomically.
+* @param const char *path, checkpoint file.
+* @return Returns 0 on success, -1 on write error.
+*/
+int TBookBuilder::save(const char *path)
+{
+	TNodesHeader header;
+	TNodeMap::iterator it;
+	std::vector<char> temp(strlen(path)+5);
+	FILE *file;
+	int retval=0;
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, NODES_MAGIC, sizeof(header.magic));
+	header.version=NODES_VERSION;
+	header.count=nodes.size();
+	header.nodeSize=sizeof(TBookNode);
+	header.depth=depth;
+
+	sprintf(&temp[0], "%s.tmp", path);
+	file=fopen(&temp[0], "wb");
+	if(file == NULL)
+		return -1;
+
+	if(fwrite(&header, sizeof(header), 1, file) != 1)
+		retval=-1;
+	for(it=nodes.begin(); retval == 0 && it != nodes.end(); ++it)
+		if(fwrite(&it->second, sizeof(TBookNode), 1, file) != 1)
+			retval=-1;
+	if(fclose(file) != 0)
+		retval=-1;
+
+	/// Replace the old checkpoint only when the new one is complete.
+	if(retval == 0 && rename(&temp[0], path) != 0)
+		retval=-1;
+	if(retval == -1)
+		remove(&temp[0]);
+
+	return retval;
+}
+
+/**
+* Writes the book in the TBook file format.
+* @param const char *path, book file.
+* @return Returns 0 on success, -1 on write error.
+*/
+int TBookBuilder::exportBook(const char *path)
+{
+	std::vector<TBookRecord> records;
+	TNodeMap::iterator it;
+	TBookRecord record;
+
+	for(it=nodes.begin(); it != nodes.end(); ++it)
+	{
+		if(!(it->second.flags & NODE_SEARCHED))
+			continue;
+		record.own=it->second.own;
+		record.enemy=it->second.enemy;
+		record.score=it->second.value;
+		record.move=it->second.move;
+		record.depth=it->second.depth;
+		record.games=it->second.games;
+		records.push_back(record);
+	}
+
+	if(records.empty())
+		return writeBook(path, NULL, 0);
+	return writeBook(path, &records[0], records.size());
+}
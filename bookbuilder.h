@@ -0,0 +1,168 @@
+/** @file bookbuilder.h
+ *  Grows an opening book by drop-out expansion. Every book position
+ *  remembers the best move that leads out of the book. The builder
+ *  repeatedly adds the out-of-book moves that cost the least compared to
+ *  the best line, searches the new positions on all processors and
+ *  negamaxes the values back to the root.
+*/
+
+#ifndef BOOKBUILDER_H
+#define BOOKBUILDER_H
+
+#include <stdint.h>
+#include <map>
+#include "position.h"
+#include "book.h"
+
+#define NODES_MAGIC "OTHBNOD1"
+
+/// Cost added for every ply away from the starting position
+#define PLY_PENALTY 20
+
+/// Node flags
+#define NODE_SEARCHED 1
+
+/**
+* @short A book position with its way out of the book.
+*
+* Positions and moves are in canonical orientation.
+* @param uint64_t own, stones of the player to move.
+* @param uint64_t enemy, stones of the opponent.
+* @param int16_t value, negamax value for the player to move.
+* @param int16_t altValue, searched value of altMove.
+* @param uint8_t move, best move, book or not.
+* @param uint8_t altMove, best move that leaves the book, NO_MOVE if all
+* moves are in the book.
+* @param uint8_t depth, search depth of altValue.
+* @param uint8_t flags, NODE_SEARCHED once altMove is known.
+* @param uint32_t games, number of seed games through the position.
+*/
+typedef struct{
+	uint64_t own;
+	uint64_t enemy;
+	int16_t value;
+	int16_t altValue;
+	uint8_t move;
+	uint8_t altMove;
+	uint8_t depth;
+	uint8_t flags;
+	uint32_t games;
+	} TBookNode;
+
+/**
+* @short Drop-out expansion book builder.
+*
+* The builder state is saved to a checkpoint file with save(), and an
+* interrupted build continues from it with load().
+*/
+class TBookBuilder
+{
+	public:
+
+/**
+* Constructor. Puts the starting position in the book.
+* @param int depth, search depth for new positions.
+* @param int threads, number of searches run in parallel.
+*/
+TBookBuilder(int depth, int threads);
+
+~TBookBuilder();
+
+/**
+* Reads a checkpoint written by save(). Nodes are added to the book.
+* @param const char *path, checkpoint file.
+* @return Returns 0 on success, -1 if the file can't be read.
+*/
+int load(const char *path);
+
+/**
+* Writes all nodes to a checkpoint file, atomically.
+* @param const char *path, checkpoint file.
+* @return Returns 0 on success, -1 on write error.
+*/
+int save(const char *path);
+
+/**
+* Writes the book in the TBook file format.
+* @param const char *path, book file.
+* @return Returns 0 on success, -1 on write error.
+*/
+int exportBook(const char *path);
+
+/**
+* Adds the positions of a game to the book. They are searched on the
+* next call to expand().
+* @param const int *moves, squares (0..63) or PASS_MOVE from the start.
+* @param int count, number of moves.
+* @param int maxPly, positions after this many moves are not added.
+* @return Returns the number of moves added, less than count if an
+* illegal move was found.
+*/
+int addGame(const int *moves, int count, int maxPly);
+
+/**
+* Runs one round of expansion: searches the positions added by addGame(),
+* then adds up to count cheapest out-of-book moves and searches the new
+* positions and their parents in parallel.
+* @param int count, most positions to add.
+* @param int maxPly, positions deeper than this are not expanded.
+* @return Returns the number of positions searched.
+*/
+int expand(int count, int maxPly);
+
+/**
+* Recomputes every value and best move from the leaves to the root.
+*/
+void propagate();
+
+/**
+* @return Returns the number of positions in the book.
+*/
+unsigned int size();
+
+/**
+* @return Returns the value of the starting position.
+*/
+int rootValue();
+
+	private:
+
+typedef std::map<TPosition, TBookNode, TPositionLess> TNodeMap;
+
+/**
+* Finds or creates the node for a canonical position.
+*/
+TBookNode *node(TPosition pos);
+
+/**
+* Returns the node of a position if it is in the book.
+*/
+TBookNode *findNode(TPosition pos);
+
+/**
+* Returns the moves of pos whose positions are already in the book.
+*/
+uint64_t bookMoves(TPosition pos);
+
+/**
+* Negamax of one node. Values already computed in this pass are in seen.
+*/
+int propagateNode(TPosition pos, std::map<TPosition, int, TPositionLess> &seen);
+
+/**
+* Finds the cheapest path cost from the root to every book position.
+*/
+void rankNode(TPosition pos, int cost, std::map<TPosition, int, TPositionLess> &costs);
+
+/**
+* Searches the given nodes' out-of-book moves in parallel.
+*/
+int searchNodes(TPosition *list, int count);
+
+TNodeMap nodes;
+TPosition root;
+int depth;
+int threads;
+};
+
+#endif /* BOOKBUILDER_H */
@@ -0,0 +1,185 @@
+/** @file bookmain.cpp
+ *  othello-book, the opening book builder. Grows a book by drop-out
+ *  expansion using every processor, saves a checkpoint as it goes and
+ *  continues from it when started again.
+ *
+ *  usage: othello-book [options] book-file
+ *    -d depth      search depth for new positions (default 14)
+ *    -t threads    parallel searches (default: number of processors)
+ *    -n positions  stop after adding this many positions (default: never)
+ *    -p plies      deepest book position (default 30)
+ *    -b batch      positions added per round (default 4 per thread)
+ *    -s games      seed games, one per line, moves like "f5d6c3"
+ *    -c file       checkpoint file (default book-file.nodes)
+ *    -i seconds    checkpoint interval (default 300)
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+#include "bookbuilder.h"
+#include "position.h"
+#include "search.h"
+
+/// Longest game, with passes
+#define MAX_GAME 120
+
+/// Set by SIGINT/SIGTERM, the build stops after the current round
+static volatile sig_atomic_t interrupted=0;
+
+static void onSignal(int)
+{
+	interrupted=1;
+}
+
+/**
+* Reads seed games and adds them to the book.
+* @return Returns the number of games read, -1 if the file can't be opened.
+*/
+static int readSeedGames(TBookBuilder &builder, const char *path, int maxPly)
+{
+	char line[4*MAX_GAME];
+	int moves[MAX_GAME];
+	int games=0, count, square;
+	char *c;
+	FILE *file;
+
+	file=fopen(path, "r");
+	if(file == NULL)
+		return -1;
+
+	while(fgets(line, sizeof(line), file) != NULL)
+	{
+		count=0;
+		for(c=line; c[0] != 0 && c[1] != 0 && count < MAX_GAME; )
+		{
+			square=parseSquare(c);
+			if(square == -1)
+			{
+				c++;
+				continue;
+			}
+			moves[count++]=square;
+			c+=2;
+		}
+		if(count == 0)
+			continue;
+
+		if(builder.addGame(moves, count, maxPly) < count && count <= maxPly)
+			fprintf(stderr, "othello-book: illegal move in game %d\n", games+1);
+		games++;
+	}
+
+	fclose(file);
+	return games;
+}
+
+static void usage()
+{
+	fprintf(stderr, "usage: othello-book [-d depth] [-t threads] [-n positions] [-p plies]\n"
+		"                    [-b batch] [-s games] [-c checkpoint] [-i seconds] book-file\n");
+	exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+	int depth=14, threads=sysconf(_SC_NPROCESSORS_ONLN);
+	int limit=-1, maxPly=30, batch=0, interval=300;
+	const char *seed=NULL, *book=NULL;
+	std::vector<char> defaultCheckpoint;
+	const char *checkpoint=NULL;
+	unsigned int start;
+	time_t saved;
+	int opt, added;
+
+	while((opt=getopt(argc, argv, "d:t:n:p:b:s:c:i:")) != -1)
+	{
+		switch (opt)
+		{
+			case 'd' : depth=atoi(optarg); break;
+			case 't' : threads=atoi(optarg); break;
+			case 'n' : limit=atoi(optarg); break;
+			case 'p' : maxPly=atoi(optarg); break;
+			case 'b' : batch=atoi(optarg); break;
+			case 's' : seed=optarg; break;
+			case 'c' : checkpoint=optarg; break;
+			case 'i' : interval=atoi(optarg); break;
+			default : usage();
+		}
+	}
+	if(optind != argc-1)
+		usage();
+	book=argv[optind];
+
+	if(threads < 1)
+		threads=1;
+	if(batch < 1)
+		batch=4*threads;
+	if(checkpoint == NULL)
+	{
+		defaultCheckpoint.resize(strlen(book)+7);
+		sprintf(&defaultCheckpoint[0], "%s.nodes", book);
+		checkpoint=&defaultCheckpoint[0];
+	}
+
+	TBookBuilder builder(depth, threads);
+
+	/// Continue an interrupted build.
+	if(access(checkpoint, F_OK) == 0)
+	{
+		if(builder.load(checkpoint) == -1)
+		{
+			fprintf(stderr, "othello-book: can't read checkpoint %s\n", checkpoint);
+			return 1;
+		}
+		printf("resumed %u positions from %s\n", builder.size(), checkpoint);
+	}
+
+	if(seed != NULL && readSeedGames(builder, seed, maxPly) == -1)
+	{
+		fprintf(stderr, "othello-book: can't read %s\n", seed);
+		return 1;
+	}
+
+	signal(SIGINT, onSignal);
+	signal(SIGTERM, onSignal);
+
+	start=builder.size();
+	saved=time(NULL);
+
+	while(!interrupted && (limit < 0 || (int)(builder.size()-start) < limit))
+	{
+		added=builder.expand(batch, maxPly);
+		printf("%u positions, root %+.2f\n", builder.size(),
+			(double)builder.rootValue()/SCORE_DISC);
+		fflush(stdout);
+
+		if(added == 0)
+			break;
+
+		if(time(NULL)-saved >= interval)
+		{
+			if(builder.save(checkpoint) == -1 || builder.exportBook(book) == -1)
+				fprintf(stderr, "othello-book: checkpoint failed\n");
+			saved=time(NULL);
+		}
+	}
+
+	if(builder.save(checkpoint) == -1)
+	{
+		fprintf(stderr, "othello-book: can't write %s\n", checkpoint);
+		return 1;
+	}
+	if(builder.exportBook(book) == -1)
+	{
+		fprintf(stderr, "othello-book: can't write %s\n", book);
+		return 1;
+	}
+
+	printf("%u positions written to %s\n", builder.size(), book);
+	return 0;
+}
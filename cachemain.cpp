@@ -0,0 +1,39 @@
+/** @file cachemain.cpp
+ *  othello-cache, offline maintenance of the solved position cache.
+ *  Merges the log of new results into the sorted file that the game and
+ *  the tools map at startup. Run it while nothing else uses the cache.
+ *
+ *  usage: othello-cache [cache-file]
+*/
+
+#include <stdio.h>
+#include "solvedcache.h"
+
+int main(int argc, char *argv[])
+{
+	const char *path=DEFAULT_SOLVED;
+	TSolvedCache cache;
+
+	if(argc > 2)
+	{
+		fprintf(stderr, "usage: othello-cache [cache-file]\n");
+		return 1;
+	}
+	if(argc == 2)
+		path=argv[1];
+
+	if(TSolvedCache::compact(path) == -1)
+	{
+		fprintf(stderr, "othello-cache: can't compact %s\n", path);
+		return 1;
+	}
+
+	if(cache.open(path) == -1)
+	{
+		fprintf(stderr, "othello-cache: %s is not a valid cache\n", path);
+		return 1;
+	}
+	printf("%u positions in %s\n", cache.size(), path);
+
+	return 0;
+}
@@ -0,0 +1,479 @@
+/** @file enginemain.cpp
+ *  othello-engine, the computer player without a window. Speaks the
+ *  NBoard protocol on standard input and output, so tournament managers
+ *  and scripts can drive it. Searches run on a thread of their own, the
+ *  input is read all the time and stop is honoured within milliseconds.
+ *
+ *  usage: othello-engine [-t seconds] [-d depth] [-c cache-file]
+ *
+ *  Commands understood, one per line:
+ *    nboard version      start, answered with "set myname"
+ *    set game ggf        position and moves of a GGF game record
+ *    set depth n         deepest search, 0 for no limit
+ *    set time seconds    time for each move (not in NBoard)
+ *    move mv[/eval/time] play a move for the side to move
+ *    go                  search, answered with nodestats and "=== mv/eval/time"
+ *    hint n              score the moves, answered with n "search" lines
+ *                        after each round and "status" when done
+ *    ponder              like hint 1, but until stop or the next command
+ *    stop                end the search, go still answers with its move
+ *    ping n              end the search, answered with "pong n"
+ *    stats               answered with nodestats of the last search
+ *    quit                exit
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <string>
+#include "analysis.h"
+#include "position.h"
+#include "search.h"
+#include "solvedcache.h"
+#include "rules.h"
+
+#define ENGINE_NAME "othello"
+
+/// Analysis slice, how late hint and ponder notice stop
+#define HINT_SLICE 0.01
+
+/// Jobs of the search thread
+#define JOB_NONE 0
+#define JOB_GO 1
+#define JOB_HINT 2
+#define JOB_PONDER 3
+#define JOB_QUIT 4
+
+/**
+* @short State shared by the reader and the search thread.
+*
+* The reader only changes the position while the search thread is idle.
+* @param pthread_mutex_t lock, guards the fields below stop.
+* @param pthread_cond_t changed, signalled when job or busy changes.
+* @param int stop, set to make the running search return, only accessed
+* with the __atomic builtins.
+* @param int job, next job for the search thread, JOB_NONE if none.
+* @param int busy, 1 while the search thread works on a job.
+* @param TPosition pos, current position, seen from the side to move.
+* @param int black, 1 if black is to move.
+* @param int depth, deepest search, 0 for no limit.
+* @param double seconds, time for a move.
+* @param int hints, moves to report for a hint.
+* @param TSearchStats last, statistics of the last search.
+*/
+typedef struct{
+	pthread_mutex_t lock;
+	pthread_cond_t changed;
+	int stop;
+	int job;
+	int busy;
+	TPosition pos;
+	int black;
+	int depth;
+	double seconds;
+	int hints;
+	TSearchStats last;
+	} TEngine;
+
+static pthread_mutex_t outputLock=PTHREAD_MUTEX_INITIALIZER;
+
+/**
+* Writes a line of the protocol. Both threads write, lines never mix.
+*/
+static void reply(const char *format, ...)
+{
+	va_list args;
+
+	pthread_mutex_lock(&outputLock);
+	va_start(args, format);
+	vprintf(format, args);
+	va_end(args);
+	putchar('\n');
+	fflush(stdout);
+	pthread_mutex_unlock(&outputLock);
+}
+
+/**
+* Writes a move in NBoard notation, passes as "PA".
+*/
+static std::string moveName(int move)
+{
+	char name[3];
+
+	if(move == NO_MOVE || move == PASS_MOVE)
+		return "PA";
+	squareName(move, name);
+	return name;
+}
+
+/**
+* Sets up the starting position.
+*/
+static void startPosition(TEngine *engine)
+{
+	TRules start;
+
+	engine->pos=positionFromRules(start, BLACK);
+	engine->black=1;
+}
+
+/**
+* Plays a move for the side to move.
+* @param const char *text, the move, anything after the square is ignored.
+* @return Returns 0, or -1 if the move is not legal.
+*/
+static int playText(TEngine *engine, const char *text)
+{
+	uint64_t moves=legalMoves(engine->pos);
+	int move=parseSquare(text);
+
+	if(move == PASS_MOVE)
+	{
+		if(moves != 0)
+			return -1;
+	} else if(move == -1 || !((moves >> move) & 1))
+		return -1;
+
+	engine->pos=playMove(engine->pos, move);
+	engine->black=!engine->black;
+	return 0;
+}
+
+/**
+* Reads a GGF game record: the starting board of BO[] and the moves
+* of the B[] and W[] tags.
+* @return Returns 0, or -1 if the record is broken or has an illegal move.
+*/
+static int readGame(TEngine *engine, const char *ggf)
+{
+	std::string name, value;
+	const char *c=ggf;
+	int found=0, read;
+
+	while(*c != 0)
+	{
+		name.clear();
+		while(*c >= 'A' && *c <= 'Z')
+			name+=*c++;
+		if(*c != '[')
+		{
+			if(*c != 0)
+				c++;
+			continue;
+		}
+		value.clear();
+		for(c++; *c != 0 && *c != ']'; c++)
+			value+=*c;
+		if(*c == ']')
+			c++;
+
+		if(name == "BO")
+		{
+			/// "8 board side", the board uses * for black.
+			if(value.size() < 2 || value[0] != '8')
+				return -1;
+			read=parsePosition(value.c_str()+2, &engine->pos);
+			if(read == -1)
+				return -1;
+			engine->black=(value[1+read] == '*' || value[1+read] == 'X' || value[1+read] == 'x');
+			found=1;
+		} else if(found && (name == "B" || name == "W")) {
+			/// A missing pass is played for the player who had to.
+			if((name == "B") != (engine->black != 0))
+			{
+				if(legalMoves(engine->pos) != 0)
+					return -1;
+				engine->pos=playMove(engine->pos, PASS_MOVE);
+				engine->black=!engine->black;
+			}
+			if(playText(engine, value.c_str()) == -1)
+				return -1;
+		}
+	}
+
+	return found ? 0 : -1;
+}
+
+/**
+* Search progress of go: a status line after each iteration.
+*/
+static void goProgress(const TSearchStats *stats, void *data)
+{
+	int *depth=(int *)data;
+	char text[256];
+
+	if(stats->depth == *depth)
+		return;
+	*depth=stats->depth;
+	formatStats(stats, text, sizeof(text));
+	reply("status %s", text);
+}
+
+/**
+* Searches for a move and answers with it.
+*/
+static void runGo(TEngine *engine, TPosition pos, int depth, double seconds)
+{
+	TSearchLimits limits;
+	TSearchStats stats;
+	int move, score, reported=-1;
+
+	limits.depth=depth;
+	limits.seconds=seconds;
+	limits.weights=NULL;
+	limits.stop=&engine->stop;
+
+	score=searchLimited(pos, &limits, &move, &stats, goProgress, &reported);
+
+	pthread_mutex_lock(&engine->lock);
+	engine->last=stats;
+	pthread_mutex_unlock(&engine->lock);
+
+	reply("nodestats %llu %.3f", (unsigned long long)stats.nodes, stats.seconds);
+	reply("=== %s/%.2f/%.3f", moveName(move).c_str(), (double)score/SCORE_DISC, stats.seconds);
+}
+
+/**
+* Writes the count best moves of an analysis as "search" lines.
+*/
+static void reportHints(TAnalysis &analysis, int count)
+{
+	const TMoveScore *sorted[SQUARES];
+	std::string pv;
+	int i, j, n=analysis.count();
+
+	for(i=0; i<n; i++)
+	{
+		sorted[i]=analysis.move(i);
+		for(j=i; j>0 && sorted[j]->score > sorted[j-1]->score; j--)
+		{
+			const TMoveScore *swap=sorted[j];
+			sorted[j]=sorted[j-1];
+			sorted[j-1]=swap;
+		}
+	}
+
+	for(i=0; i<n && i<count; i++)
+	{
+		pv.clear();
+		for(j=0; j<sorted[i]->pvLength; j++)
+			pv+=moveName(sorted[i]->pv[j]);
+		if(pv.empty())
+			pv=moveName(sorted[i]->move);
+		reply("search %s %.2f 0 %d%s", pv.c_str(), (double)sorted[i]->score/SCORE_DISC,
+			sorted[i]->depth, sorted[i]->exact ? "@100%" : "");
+	}
+}
+
+/**
+* Scores the moves of a position until stopped, out of time or solved,
+* reporting after each round.
+*/
+static void runHint(TEngine *engine, TAnalysis &analysis, TPosition pos, int count,
+	int depth, double seconds)
+{
+	double deadline=searchClock()+seconds;
+	int reported=0, more=1;
+
+	analysis.setPosition(pos);
+	while(more && !__atomic_load_n(&engine->stop, __ATOMIC_RELAXED) && analysis.count() > 0)
+	{
+		more=analysis.refine(HINT_SLICE);
+		if(analysis.depth() > reported)
+		{
+			reported=analysis.depth();
+			reportHints(analysis, count);
+		}
+		if(depth > 0 && reported >= depth)
+			break;
+		if(seconds > 0 && searchClock() >= deadline)
+			break;
+	}
+	reply("status");
+}
+
+/**
+* The search thread, runs one job at a time.
+*/
+static void *searchThread(void *arg)
+{
+	TEngine *engine=(TEngine *)arg;
+	TAnalysis analysis;
+	TPosition pos;
+	int job, depth, hints;
+	double seconds;
+
+	for(;;)
+	{
+		pthread_mutex_lock(&engine->lock);
+		while(engine->job == JOB_NONE)
+			pthread_cond_wait(&engine->changed, &engine->lock);
+		job=engine->job;
+		engine->job=JOB_NONE;
+		engine->busy=1;
+		pos=engine->pos;
+		depth=engine->depth;
+		seconds=engine->seconds;
+		hints=engine->hints;
+		pthread_mutex_unlock(&engine->lock);
+
+		if(job == JOB_QUIT)
+			break;
+		if(job == JOB_GO)
+			runGo(engine, pos, depth, seconds);
+		else if(job == JOB_HINT)
+			runHint(engine, analysis, pos, hints, depth, seconds);
+		else if(job == JOB_PONDER)
+			runHint(engine, analysis, pos, 1, 0, 0);
+
+		pthread_mutex_lock(&engine->lock);
+		engine->busy=0;
+		pthread_cond_broadcast(&engine->changed);
+		pthread_mutex_unlock(&engine->lock);
+	}
+
+	return NULL;
+}
+
+/**
+* Stops the running search and waits until the search thread is idle.
+* A go not picked up yet still runs with stop set, so it answers with the
+* move of its first iteration; waiting hint and ponder jobs are dropped.
+*/
+static void stopSearch(TEngine *engine)
+{
+	pthread_mutex_lock(&engine->lock);
+	__atomic_store_n(&engine->stop, 1, __ATOMIC_RELAXED);
+	if(engine->job == JOB_HINT || engine->job == JOB_PONDER)
+		engine->job=JOB_NONE;
+	while(engine->busy || engine->job == JOB_GO)
+		pthread_cond_wait(&engine->changed, &engine->lock);
+	__atomic_store_n(&engine->stop, 0, __ATOMIC_RELAXED);
+	pthread_mutex_unlock(&engine->lock);
+}
+
+/**
+* Hands a job to the search thread, stopping the one before.
+*/
+static void startJob(TEngine *engine, int job)
+{
+	stopSearch(engine);
+
+	pthread_mutex_lock(&engine->lock);
+	engine->job=job;
+	pthread_cond_broadcast(&engine->changed);
+	pthread_mutex_unlock(&engine->lock);
+}
+
+static void usage()
+{
+	fprintf(stderr, "usage: othello-engine [-t seconds] [-d depth] [-c cache-file]\n");
+	exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+	TEngine engine;
+	TSolvedCache cache;
+	pthread_t worker;
+	const char *cachePath=NULL;
+	char line[4096], *command, *args;
+	int opt;
+
+	memset(&engine, 0, sizeof(engine));
+	pthread_mutex_init(&engine.lock, NULL);
+	pthread_cond_init(&engine.changed, NULL);
+	engine.seconds=5;
+	startPosition(&engine);
+
+	while((opt=getopt(argc, argv, "t:d:c:")) != -1)
+	{
+		switch (opt)
+		{
+			case 't' : engine.seconds=atof(optarg); break;
+			case 'd' : engine.depth=atoi(optarg); break;
+			case 'c' : cachePath=optarg; break;
+			default : usage();
+		}
+	}
+	if(optind != argc)
+		usage();
+
+	if(cachePath != NULL)
+	{
+		if(cache.open(cachePath) == -1)
+		{
+			fprintf(stderr, "othello-engine: %s is not a valid cache\n", cachePath);
+			return 1;
+		}
+		setSolvedCache(&cache);
+	}
+
+	if(pthread_create(&worker, NULL, searchThread, &engine) != 0)
+	{
+		fprintf(stderr, "othello-engine: can't start the search thread\n");
+		return 1;
+	}
+
+	while(fgets(line, sizeof(line), stdin) != NULL)
+	{
+		line[strcspn(line, "\r\n")]=0;
+		command=line+strspn(line, " \t");
+		args=command+strcspn(command, " \t");
+		if(*args != 0)
+			*args++=0;
+		args+=strspn(args, " \t");
+
+		if(strcmp(command, "nboard") == 0)
+		{
+			stopSearch(&engine);
+			reply("set myname " ENGINE_NAME);
+		} else if(strcmp(command, "set") == 0) {
+			stopSearch(&engine);
+			if(strncmp(args, "game ", 5) == 0)
+			{
+				if(readGame(&engine, args+5) == -1)
+				{
+					startPosition(&engine);
+					reply("status bad game record");
+				}
+			} else if(strncmp(args, "depth ", 6) == 0)
+				engine.depth=atoi(args+6);
+			else if(strncmp(args, "time ", 5) == 0)
+				engine.seconds=atof(args+5);
+		} else if(strcmp(command, "move") == 0) {
+			stopSearch(&engine);
+			if(playText(&engine, args) == -1)
+				reply("status illegal move %s", args);
+		} else if(strcmp(command, "go") == 0) {
+			startJob(&engine, JOB_GO);
+		} else if(strcmp(command, "hint") == 0) {
+			engine.hints=(atoi(args) > 0) ? atoi(args) : 1;
+			startJob(&engine, JOB_HINT);
+		} else if(strcmp(command, "ponder") == 0) {
+			startJob(&engine, JOB_PONDER);
+		} else if(strcmp(command, "stop") == 0) {
+			stopSearch(&engine);
+		} else if(strcmp(command, "ping") == 0) {
+			stopSearch(&engine);
+			reply("pong %s", args);
+		} else if(strcmp(command, "stats") == 0) {
+			pthread_mutex_lock(&engine.lock);
+			reply("nodestats %llu %.3f", (unsigned long long)engine.last.nodes,
+				engine.last.seconds);
+			pthread_mutex_unlock(&engine.lock);
+		} else if(strcmp(command, "quit") == 0) {
+			break;
+		}
+		/// learn, analyze and others are not needed to play, they are ignored.
+	}
+
+	startJob(&engine, JOB_QUIT);
+	pthread_join(worker, NULL);
+	setSolvedCache(NULL);
+
+	return 0;
+}
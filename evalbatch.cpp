@@ -0,0 +1,84 @@
+#include <stdio.h>
+#include <string.h>
+#include "evalbatch.h"
+#include "search.h"
+#include "workpool.h"
+
+/// Static evaluations a thread takes at a time, they are too quick to lock for each
+#define EVAL_CHUNK 64
+
+/**
+* @short Positions shared by the threads.
+*/
+typedef struct{
+	const TPosition *positions;
+	TEvalResult *results;
+	const TEvalLimits *limits;
+	} TEvalJobs;
+
+/**
+* Scores one position.
+* @param TPosition pos, the position.
+* @param const TEvalLimits *limits, how to score it.
+* @param TEvalResult *result, the score is saved here.
+* @param TSearchStats *stats, if not NULL, the search statistics are
+* saved here, cleared for a static evaluation.
+*/
+void evaluateOne(TPosition pos, const TEvalLimits *limits, TEvalResult *result,
+	TSearchStats *stats)
+{
+	TSearchStats own;
+
+	if(stats == NULL)
+		stats=&own;
+
+	if(limits->mode == EVAL_STATIC)
+	{
+		memset(stats, 0, sizeof(TSearchStats));
+		stats->nodes=1;
+		stats->score=evaluatePosition(pos);
+		result->score=stats->score;
+		result->move=NO_MOVE;
+		result->depth=0;
+		result->exact=0;
+		result->nodes=1;
+		return;
+	}
+
+	if(limits->mode == EVAL_TIME)
+		result->score=searchTimed(pos, limits->seconds, &result->move, stats);
+	else if(limits->mode == EVAL_SOLVE)
+		result->score=solvePosition(pos, &result->move, stats);
+	else
+		result->score=searchPosition(pos, limits->depth, 0, &result->move, stats);
+	result->depth=stats->depth;
+	result->exact=stats->exact;
+	result->nodes=stats->nodes;
+}
+
+static void evalJob(int i, void *data)
+{
+	TEvalJobs *jobs=(TEvalJobs *)data;
+
+	evaluateOne(jobs->positions[i], jobs->limits, &jobs->results[i], NULL);
+}
+
+/**
+* Scores positions in parallel. Returns when all are done.
+* @param const TPosition *positions, the positions.
+* @param TEvalResult *results, result i is saved for position i.
+* @param int count, number of positions.
+* @param const TEvalLimits *limits, how to score them.
+* @param int threads, number of threads to use.
+*/
+void evaluateBatch(const TPosition *positions, TEvalResult *results, int count,
+	const TEvalLimits *limits, int threads)
+{
+	TEvalJobs jobs;
+
+	jobs.positions=positions;
+	jobs.results=results;
+	jobs.limits=limits;
+	/// Searches are slow enough to hand out one by one.
+	runJobs(evalJob, &jobs, count, threads, (limits->mode == EVAL_STATIC) ? EVAL_CHUNK : 1);
+}
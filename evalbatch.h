@@ -0,0 +1,72 @@
+/** @file evalbatch.h
+ *  Scores many positions at once on a pool of threads: static
+ *  evaluation, a fixed depth search or a fixed time search for each.
+ *  Results come back in the order of the positions.
+*/
+
+#ifndef EVALBATCH_H
+#define EVALBATCH_H
+
+#include <stdint.h>
+#include "position.h"
+
+struct TSearchStats;
+
+/// Evaluation modes
+#define EVAL_STATIC 0
+#define EVAL_DEPTH 1
+#define EVAL_TIME 2
+#define EVAL_SOLVE 3
+
+/**
+* @short How to score the positions.
+* @param int mode, EVAL_STATIC, EVAL_DEPTH, EVAL_TIME or EVAL_SOLVE.
+* @param int depth, plies to search for EVAL_DEPTH.
+* @param double seconds, time to search each position for EVAL_TIME.
+*/
+typedef struct{
+	int mode;
+	int depth;
+	double seconds;
+	} TEvalLimits;
+
+/**
+* @short Score of one position.
+* @param int score, value for the player to move, in search units.
+* @param int move, best move, PASS_MOVE, or NO_MOVE if the game is over
+* or the evaluation was static.
+* @param int depth, plies searched, empty squares if exact, 0 if static.
+* @param int exact, 1 if score is the perfect play result.
+* @param uint64_t nodes, positions visited.
+*/
+typedef struct{
+	int score;
+	int move;
+	int depth;
+	int exact;
+	uint64_t nodes;
+	} TEvalResult;
+
+/**
+* Scores one position.
+* @param TPosition pos, the position.
+* @param const TEvalLimits *limits, how to score it.
+* @param TEvalResult *result, the score is saved here.
+* @param TSearchStats *stats, if not NULL, the search statistics are
+* saved here, cleared for a static evaluation.
+*/
+void evaluateOne(TPosition pos, const TEvalLimits *limits, TEvalResult *result,
+	TSearchStats *stats);
+
+/**
+* Scores positions in parallel. Returns when all are done.
+* @param const TPosition *positions, the positions.
+* @param TEvalResult *results, result i is saved for position i.
+* @param int count, number of positions.
+* @param const TEvalLimits *limits, how to score them.
+* @param int threads, number of threads to use.
+*/
+void evaluateBatch(const TPosition *positions, TEvalResult *results, int count,
+	const TEvalLimits *limits, int threads);
+
+#endif /* EVALBATCH_H */
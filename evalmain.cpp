@@ -0,0 +1,163 @@
+/** @file evalmain.cpp
+ *  othello-eval, scores a stream of positions on every processor.
+ *  Prints one line per position in input order:
+ *  score move depth exact nodes, the score in hundredths of a disc for
+ *  the player to move, "invalid" for text lines that are not positions.
+ *
+ *  usage: othello-eval [options] [file]
+ *    -e            static evaluation (default)
+ *    -d depth      search every position to depth
+ *    -t seconds    search every position for this long
+ *    -x            solve every position exactly
+ *    -j threads    parallel searches (default: number of processors)
+ *    -n positions  positions read before scoring them (default 1024)
+ *    -b            binary input, own and enemy as two native 64-bit
+ *                  words per position, instead of text lines like
+ *                  "---------------------------OX------XO--------------------------- X"
+ *  Reads standard input if file is missing or "-". Text lines that are
+ *  empty or start with # are skipped.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <vector>
+#include "evalbatch.h"
+#include "position.h"
+
+static void usage()
+{
+	fprintf(stderr, "usage: othello-eval [-e | -d depth | -t seconds | -x] [-j threads]\n"
+		"                    [-n positions] [-b] [file]\n");
+	exit(1);
+}
+
+/**
+* Reads up to count positions.
+* @param FILE *file, the input.
+* @param bool binary, true for binary input.
+* @param std::vector<TPosition> &positions, the positions are saved here.
+* @param std::vector<char> &valid, 0 is saved here for lines that are not positions.
+* @param int count, most positions to read.
+* @return Returns the number of positions read, 0 at end of input.
+*/
+static int readPositions(FILE *file, bool binary, std::vector<TPosition> &positions,
+	std::vector<char> &valid, int count)
+{
+	char line[256];
+	uint64_t words[2];
+	int read=0;
+
+	while(read < count)
+	{
+		if(binary)
+		{
+			if(fread(words, sizeof(words), 1, file) != 1)
+				break;
+			positions[read].own=words[0];
+			positions[read].enemy=words[1];
+			valid[read]=(words[0] & words[1]) == 0;
+		} else {
+			if(fgets(line, sizeof(line), file) == NULL)
+				break;
+			if(line[0] == '#' || line[strspn(line, " \t\r\n")] == 0)
+				continue;
+			valid[read]=parsePosition(line, &positions[read]) != -1;
+		}
+		/// Invalid positions are still scored, as empty boards, to keep the order simple.
+		if(!valid[read])
+			positions[read].own=positions[read].enemy=0;
+		read++;
+	}
+
+	return read;
+}
+
+int main(int argc, char *argv[])
+{
+	int threads=sysconf(_SC_NPROCESSORS_ONLN), batch=1024;
+	bool binary=false;
+	TEvalLimits limits;
+	std::vector<TPosition> positions;
+	std::vector<TEvalResult> results;
+	std::vector<char> valid;
+	const char *path="-";
+	char move[3];
+	FILE *file;
+	int opt, count, i;
+
+	limits.mode=EVAL_STATIC;
+	limits.depth=0;
+	limits.seconds=0;
+
+	while((opt=getopt(argc, argv, "ed:t:xj:n:b")) != -1)
+	{
+		switch (opt)
+		{
+			case 'e' : limits.mode=EVAL_STATIC; break;
+			case 'd' : limits.mode=EVAL_DEPTH; limits.depth=atoi(optarg); break;
+			case 't' : limits.mode=EVAL_TIME; limits.seconds=atof(optarg); break;
+			case 'x' : limits.mode=EVAL_SOLVE; break;
+			case 'j' : threads=atoi(optarg); break;
+			case 'n' : batch=atoi(optarg); break;
+			case 'b' : binary=true; break;
+			default : usage();
+		}
+	}
+	if(optind < argc-1)
+		usage();
+	if(optind == argc-1)
+		path=argv[optind];
+
+	if(threads < 1)
+		threads=1;
+	if(batch < 1)
+		batch=1;
+
+	if(strcmp(path, "-") == 0)
+		file=stdin;
+	else
+		file=fopen(path, binary ? "rb" : "r");
+	if(file == NULL)
+	{
+		fprintf(stderr, "othello-eval: can't read %s\n", path);
+		return 1;
+	}
+
+	positions.resize(batch);
+	results.resize(batch);
+	valid.resize(batch);
+
+	/// One batch at a time, so that output starts early and memory stays small.
+	while((count=readPositions(file, binary, positions, valid, batch)) > 0)
+	{
+		evaluateBatch(&positions[0], &results[0], count, &limits, threads);
+
+		for(i=0; i<count; i++)
+		{
+			if(!valid[i])
+			{
+				printf("invalid\n");
+				continue;
+			}
+			if(results[i].move == NO_MOVE)
+				strcpy(move, "--");
+			else
+				squareName(results[i].move, move);
+			printf("%d %s %d %d %llu\n", results[i].score, move, results[i].depth,
+				results[i].exact, (unsigned long long)results[i].nodes);
+		}
+		fflush(stdout);
+	}
+
+	if(ferror(file))
+	{
+		fprintf(stderr, "othello-eval: error reading %s\n", path);
+		return 1;
+	}
+	if(file != stdin)
+		fclose(file);
+
+	return 0;
+}
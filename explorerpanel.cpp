@@ -0,0 +1,85 @@
+#include "explorerpanel.h"
+#include "posindex.h"
+
+#include <qlabel.h>
+#include <qlistview.h>
+#include <stdio.h>
+
+ExplorerPanel::ExplorerPanel( QWidget *parent, const char *name )
+    : QVBox( parent, name )
+{
+  index = new TPositionIndex();
+  summary = new QLabel( this );
+  moveList = new QListView( this );
+  moveList->addColumn( "Move" );
+  moveList->addColumn( "Games" );
+  moveList->addColumn( "Share" );
+  moveList->addColumn( "Score" );
+  moveList->addColumn( "Discs" );
+  // keep the most played move on top, as the index lists them
+  moveList->setSorting( -1 );
+  moveList->setAllColumnsShowFocus( TRUE );
+
+  // no index file just means there is nothing to explore
+  if (index->open(DEFAULT_INDEX) == -1) {
+    summary->setText( "No position index (" DEFAULT_INDEX ")." );
+  }
+}
+
+ExplorerPanel::~ExplorerPanel()
+{
+  delete index;
+}
+
+// the games through pos, and one row for every move played from it
+void ExplorerPanel::showPosition( TPosition pos )
+{
+  TIndexStats stats, next;
+  char buf[128];
+
+  if (!index->isOpen()) {
+    return;
+  }
+  moveList->clear();
+  if (index->lookup(pos, &stats) == NULL) {
+    summary->setText( "Not in any game." );
+    return;
+  }
+
+  unsigned int finished = stats.wins + stats.draws + stats.losses;
+  if (finished > 0) {
+    snprintf( buf, sizeof(buf), "%u games, %.0f%% won by the player to move, %+.1f discs",
+              stats.games, 100.0*(stats.wins + 0.5*stats.draws)/finished, stats.discs );
+  } else {
+    snprintf( buf, sizeof(buf), "%u games, none finished", stats.games );
+  }
+  summary->setText( buf );
+
+  // a move scores what the position after it scores for the other player;
+  // items go in at the top, so the least played move is added first
+  for (int i=stats.count-1; i>=0; i--) {
+    char name[3], games[16], share[16], score[16], discs[16];
+    squareName( stats.moves[i], name );
+    snprintf( games, sizeof(games), "%u", stats.moveGames[i] );
+    snprintf( share, sizeof(share), "%.1f%%", 100.0*stats.moveGames[i]/stats.games );
+    score[0] = discs[0] = 0;
+    if (index->lookup(playMove(pos, stats.moves[i]), &next) != NULL) {
+      finished = next.wins + next.draws + next.losses;
+      if (finished > 0) {
+        snprintf( score, sizeof(score), "%.0f%%", 100.0*(next.losses + 0.5*next.draws)/finished );
+        snprintf( discs, sizeof(discs), "%+.1f", -next.discs );
+      }
+    }
+    new QListViewItem( moveList, name, games, share, score, discs );
+  }
+}
+
+// empty the list and say why
+void ExplorerPanel::showNothing( const QString& why )
+{
+  if (!index->isOpen()) {
+    return;
+  }
+  moveList->clear();
+  summary->setText( why );
+}
@@ -0,0 +1,48 @@
+/** @file explorerpanel.h
+ *  Opening explorer: what the games in the position index say about the
+ *  position on the board.
+*/
+
+#ifndef EXPLORERPANEL_H
+#define EXPLORERPANEL_H
+
+#include <qvbox.h>
+
+#include "position.h"
+
+class QLabel;
+class QListView;
+class TPositionIndex;
+
+/**
+* @short Shows the position index statistics of a position.
+*
+* The panel maps DEFAULT_INDEX when it is made. It shows how many games
+* reached the position and how they ended, and lists the moves played
+* from it with how often each was played and how it scored for the
+* player who made it.
+*/
+class ExplorerPanel : public QVBox
+{
+public:
+    ExplorerPanel( QWidget *parent, const char *name );
+    ~ExplorerPanel();
+
+    /**
+    * Shows the statistics of a position.
+    * @param pos Position seen from the player to move.
+    */
+    void showPosition( TPosition pos );
+    /**
+    * Shows that there is nothing to look up, like at the end of a game.
+    * @param why What to say instead.
+    */
+    void showNothing( const QString& why );
+
+private:
+    TPositionIndex* index;
+    QLabel* summary;
+    QListView* moveList;
+};
+
+#endif  // EXPLORERPANEL_H
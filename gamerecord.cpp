@@ -0,0 +1,462 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "gamerecord.h"
+#include "position.h"
+
+/// Size of the read and write buffers
+#define GAME_BUFFER (1 << 20)
+/// Bytes of a record before the names
+#define RECORD_FIXED 5
+/// Bytes of the header in a file
+#define HEADER_SIZE 16
+
+/**
+* Writes a header as it is stored in a file, numbers little-endian.
+* @param const TGameHeader *header, the header.
+* @param uint8_t *bytes, HEADER_SIZE bytes are saved here.
+*/
+static void encodeHeader(const TGameHeader *header, uint8_t *bytes)
+{
+	int i;
+
+	memcpy(bytes, header->magic, sizeof(header->magic));
+	for(i=0; i<4; i++)
+	{
+		bytes[8+i]=(header->version >> (8*i)) & 0xff;
+		bytes[12+i]=(header->reserved >> (8*i)) & 0xff;
+	}
+}
+
+/**
+* Reads a header as it is stored in a file.
+* @param const uint8_t *bytes, HEADER_SIZE bytes.
+* @param TGameHeader *header, the header is saved here.
+*/
+static void decodeHeader(const uint8_t *bytes, TGameHeader *header)
+{
+	int i;
+
+	memcpy(header->magic, bytes, sizeof(header->magic));
+	header->version=0;
+	header->reserved=0;
+	for(i=0; i<4; i++)
+	{
+		header->version|=(uint32_t)bytes[8+i] << (8*i);
+		header->reserved|=(uint32_t)bytes[12+i] << (8*i);
+	}
+}
+
+/**
+* Empties a game: no names, no moves, no result.
+*/
+void clearGame(TGameRecord *game)
+{
+	game->black[0]=0;
+	game->white[0]=0;
+	game->flags=0;
+	game->result=GAME_NO_RESULT;
+	game->count=0;
+}
+
+/**
+* Copies a name into text, tabs and line breaks turned into spaces.
+* @return Returns the number of characters written.
+*/
+static int copyName(const char *name, char *text, int size)
+{
+	int i;
+
+	for(i=0; name[i] != 0 && i < size-1; i++)
+		text[i]=(name[i] == '\t' || name[i] == '\n' || name[i] == '\r') ? ' ' : name[i];
+	text[i]=0;
+	return i;
+}
+
+/**
+* Writes a game as a line of text: black, white, result, "normal" or
+* "weird", the moves like "f5d6pa", and the times in seconds if known,
+* separated by tabs. Tabs in names become spaces.
+* @param const TGameRecord *game, the game.
+* @param char *text, the line is saved here, without newline.
+* @param int size, size of text, GAME_TEXT_SIZE is always enough.
+*/
+void gameToText(const TGameRecord *game, char *text, int size)
+{
+	char line[GAME_TEXT_SIZE];
+	int length, i;
+
+	length=copyName(game->black, line, GAME_MAX_NAME+1);
+	line[length++]='\t';
+	length+=copyName(game->white, line+length, GAME_MAX_NAME+1);
+
+	if(game->result == GAME_NO_RESULT)
+		length+=sprintf(line+length, "\t?");
+	else
+		length+=sprintf(line+length, "\t%+d", game->result);
+	length+=sprintf(line+length, "\t%s\t", (game->flags & GAME_WEIRD) ? "weird" : "normal");
+
+	for(i=0; i<game->count; i++)
+	{
+		squareName(game->moves[i], line+length);
+		length+=2;
+	}
+
+	if(game->flags & GAME_TIMES)
+		for(i=0; i<game->count; i++)
+			length+=sprintf(line+length, "%c%.2f", (i == 0) ? '\t' : ',', game->times[i]/100.0);
+
+	snprintf(text, size, "%s", line);
+}
+
+/**
+* Reads a game written by gameToText().
+* @param const char *text, the line.
+* @param TGameRecord *game, the game is saved here.
+* @return Returns 0, or -1 if the line is not a game.
+*/
+int gameFromText(const char *text, TGameRecord *game)
+{
+	const char *fields[6];
+	int lengths[6];
+	int count=0, i, square;
+	const char *c=text;
+	char *next;
+	double seconds;
+
+	/// Split at tabs, the line break ends the last field.
+	while(count < 6)
+	{
+		fields[count]=c;
+		lengths[count]=strcspn(c, "\t\r\n");
+		c+=lengths[count];
+		count++;
+		if(*c != '\t')
+			break;
+		c++;
+	}
+	if(count < 5 || lengths[0] > GAME_MAX_NAME || lengths[1] > GAME_MAX_NAME)
+		return -1;
+
+	clearGame(game);
+	memcpy(game->black, fields[0], lengths[0]);
+	game->black[lengths[0]]=0;
+	memcpy(game->white, fields[1], lengths[1]);
+	game->white[lengths[1]]=0;
+
+	if(fields[2][0] != '?')
+	{
+		game->result=strtol(fields[2], &next, 10);
+		if(next == fields[2] || game->result < -SQUARES || game->result > SQUARES)
+			return -1;
+	}
+
+	if(lengths[3] == 5 && strncmp(fields[3], "weird", 5) == 0)
+		game->flags|=GAME_WEIRD;
+	else if(lengths[3] != 6 || strncmp(fields[3], "normal", 6) != 0)
+		return -1;
+
+	if(lengths[4] % 2 != 0 || lengths[4]/2 > GAME_MAX_MOVES)
+		return -1;
+	for(i=0; i<lengths[4]/2; i++)
+	{
+		square=parseSquare(fields[4]+2*i);
+		if(square == -1)
+			return -1;
+		game->moves[game->count++]=square;
+	}
+
+	if(count == 6 && lengths[5] > 0)
+	{
+		c=fields[5];
+		for(i=0; i<game->count; i++)
+		{
+			seconds=strtod(c, &next);
+			if(next == c || seconds < 0 || seconds > 655.35)
+				return -1;
+			game->times[i]=(uint16_t)(seconds*100+0.5);
+			c=next;
+			if(*c == ',')
+				c++;
+		}
+		game->flags|=GAME_TIMES;
+	}
+
+	return 0;
+}
+
+TGameWriter::TGameWriter() : file(NULL), failed(false)
+{
+}
+
+/**
+* Destructor. Closes the file.
+*/
+TGameWriter::~TGameWriter()
+{
+	close();
+}
+
+/**
+* Creates a file, or opens one to add games to.
+* @param const char *path, the file, "-" for standard output.
+* @param bool append, true to keep the games already in the file.
+* @return Returns 0, or -1 if the file can't be written or is not a game file.
+*/
+int TGameWriter::open(const char *path, bool append)
+{
+	TGameHeader header;
+	uint8_t bytes[HEADER_SIZE];
+	FILE *old;
+	size_t read=0;
+
+	close();
+	failed=false;
+
+	if(strcmp(path, "-") == 0)
+	{
+		file=stdout;
+	} else {
+		/// Games are only added to a file of the same format.
+		if(append && (old=fopen(path, "rb")) != NULL)
+		{
+			read=fread(bytes, 1, HEADER_SIZE, old);
+			fclose(old);
+			if(read == HEADER_SIZE)
+				decodeHeader(bytes, &header);
+			if(read != 0 && (read != HEADER_SIZE ||
+				memcmp(header.magic, GAME_MAGIC, sizeof(header.magic)) != 0 ||
+				header.version != GAME_VERSION))
+				return -1;
+		}
+		file=fopen(path, append ? "ab" : "wb");
+		if(file == NULL)
+			return -1;
+		setvbuf(file, NULL, _IOFBF, GAME_BUFFER);
+	}
+
+	if(read == 0)
+	{
+		memset(&header, 0, sizeof(header));
+		memcpy(header.magic, GAME_MAGIC, sizeof(header.magic));
+		header.version=GAME_VERSION;
+		encodeHeader(&header, bytes);
+		if(fwrite(bytes, HEADER_SIZE, 1, file) != 1)
+			failed=true;
+	}
+
+	return failed ? -1 : 0;
+}
+
+/**
+* Adds a game.
+* @return Returns 0, or -1 on write error.
+*/
+int TGameWriter::write(const TGameRecord *game)
+{
+	uint8_t record[2+RECORD_FIXED+2*GAME_MAX_NAME+3*GAME_MAX_MOVES];
+	int black=strlen(game->black), white=strlen(game->white);
+	int length=2, count=game->count, i;
+
+	if(black > GAME_MAX_NAME)
+		black=GAME_MAX_NAME;
+	if(white > GAME_MAX_NAME)
+		white=GAME_MAX_NAME;
+	if(count > GAME_MAX_MOVES)
+		count=GAME_MAX_MOVES;
+
+	record[length++]=game->flags & (GAME_WEIRD|GAME_TIMES);
+	record[length++]=(uint8_t)(int8_t)game->result;
+	record[length++]=count;
+	record[length++]=black;
+	record[length++]=white;
+	memcpy(record+length, game->black, black);
+	length+=black;
+	memcpy(record+length, game->white, white);
+	length+=white;
+	memcpy(record+length, game->moves, count);
+	length+=count;
+	if(game->flags & GAME_TIMES)
+		for(i=0; i<count; i++)
+		{
+			record[length++]=game->times[i] & 0xff;
+			record[length++]=game->times[i] >> 8;
+		}
+
+	record[0]=(length-2) & 0xff;
+	record[1]=(length-2) >> 8;
+
+	if(file == NULL || fwrite(record, length, 1, file) != 1)
+		failed=true;
+	return failed ? -1 : 0;
+}
+
+/**
+* Flushes and closes the file.
+* @return Returns 0, or -1 if something could not be written.
+*/
+int TGameWriter::close()
+{
+	int retval=failed ? -1 : 0;
+
+	if(file == NULL)
+		return retval;
+
+	if(file == stdout)
+	{
+		if(fflush(file) != 0)
+			retval=-1;
+	} else if(fclose(file) != 0)
+		retval=-1;
+
+	file=NULL;
+	return retval;
+}
+
+TGameReader::TGameReader() : fd(-1), buffer(GAME_BUFFER), start(0), end(0)
+{
+}
+
+/**
+* Destructor. Closes the file.
+*/
+TGameReader::~TGameReader()
+{
+	close();
+}
+
+/**
+* Opens a file and checks its header.
+* @param const char *path, the file, "-" for standard input.
+* @return Returns 0, or -1 if the file can't be read or is not a game file.
+*/
+int TGameReader::open(const char *path)
+{
+	TGameHeader header;
+
+	close();
+
+	fd=(strcmp(path, "-") == 0) ? 0 : ::open(path, O_RDONLY);
+	if(fd == -1)
+		return -1;
+
+	while(end-start < HEADER_SIZE)
+		if(fill() <= 0)
+		{
+			close();
+			return -1;
+		}
+
+	decodeHeader(&buffer[start], &header);
+	if(memcmp(header.magic, GAME_MAGIC, sizeof(header.magic)) != 0 ||
+		header.version != GAME_VERSION)
+	{
+		close();
+		return -1;
+	}
+	start+=HEADER_SIZE;
+
+	return 0;
+}
+
+/**
+* Moves the unread bytes to the front of the buffer and reads more.
+* @return Returns the number of bytes read, 0 at the end, -1 on error.
+*/
+int TGameReader::fill()
+{
+	ssize_t got;
+
+	if(start > 0)
+	{
+		memmove(&buffer[0], &buffer[start], end-start);
+		end-=start;
+		start=0;
+	}
+
+	do
+		got=::read(fd, &buffer[end], buffer.size()-end);
+	while(got == -1 && errno == EINTR);
+
+	if(got > 0)
+		end+=got;
+	return got;
+}
+
+/**
+* Reads the next game.
+* @param TGameRecord *game, the game is saved here.
+* @return Returns 1, 0 at the end of the file, -1 if the file is broken.
+*/
+int TGameReader::read(TGameRecord *game)
+{
+	const uint8_t *record;
+	unsigned int size, black, white, count, need, i;
+	int got;
+
+	if(fd == -1)
+		return -1;
+
+	/// Records never span more than the buffer, a record is at most 64 kB.
+	while(end-start < 2 || end-start < 2+(unsigned int)(buffer[start] | (buffer[start+1] << 8)))
+	{
+		got=fill();
+		if(got == -1)
+			return -1;
+		if(got == 0)
+			return (end == start) ? 0 : -1;
+	}
+
+	record=&buffer[start];
+	size=record[0] | (record[1] << 8);
+	start+=2+size;
+	record+=2;
+
+	if(size < RECORD_FIXED)
+		return -1;
+	count=record[2];
+	black=record[3];
+	white=record[4];
+	need=RECORD_FIXED+black+white+count;
+	if(record[0] & GAME_TIMES)
+		need+=2*count;
+	/// Later versions may add fields at the end.
+	if(need > size || count > GAME_MAX_MOVES)
+		return -1;
+
+	game->flags=record[0] & (GAME_WEIRD|GAME_TIMES);
+	game->result=(int8_t)record[1];
+	game->count=count;
+	record+=RECORD_FIXED;
+	memcpy(game->black, record, black);
+	game->black[black]=0;
+	record+=black;
+	memcpy(game->white, record, white);
+	game->white[white]=0;
+	record+=white;
+	memcpy(game->moves, record, count);
+	record+=count;
+	for(i=0; i<count; i++)
+		if(game->moves[i] > PASS_MOVE)
+			return -1;
+	if(game->flags & GAME_TIMES)
+		for(i=0; i<count; i++)
+			game->times[i]=record[2*i] | (record[2*i+1] << 8);
+
+	return 1;
+}
+
+/**
+* Closes the file.
+*/
+void TGameReader::close()
+{
+	if(fd > 0)
+		::close(fd);
+	fd=-1;
+	start=0;
+	end=0;
+}
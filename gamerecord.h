@@ -0,0 +1,190 @@
+/** @file gamerecord.h
+ *  Compact game record files. A game takes one byte per move after a
+ *  short header, so archives of millions of games stay small and are
+ *  read at disk speed. Records are framed by their size and read and
+ *  written one at a time, files of any size can be streamed.
+ *
+ *  File layout: TGameHeader, 16 bytes, then records of
+ *    uint16 size, bytes that follow
+ *    uint8 flags, GAME_WEIRD, GAME_TIMES
+ *    int8 result, black's disc difference or GAME_NO_RESULT
+ *    uint8 moves, number of moves
+ *    uint8 black, uint8 white, lengths of the player names
+ *    the names, without terminating zeros
+ *    the moves, squares 0..63 or PASS_MOVE
+ *    if GAME_TIMES, uint16 hundredths of a second for each move
+ *  Numbers in the header and the records are little-endian.
+*/
+
+#ifndef GAMERECORD_H
+#define GAMERECORD_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <vector>
+#include "position.h"
+
+#define GAME_MAGIC "OTHGAME1"
+#define GAME_VERSION 1
+
+/// Longest game, 60 moves and a pass before each
+#define GAME_MAX_MOVES 120
+/// Longest player name
+#define GAME_MAX_NAME 255
+/// Room for a game as text
+#define GAME_TEXT_SIZE 2048
+
+/// Game flags
+#define GAME_WEIRD 1
+#define GAME_TIMES 2
+
+/// Result of an unfinished game
+#define GAME_NO_RESULT -128
+
+/**
+* @short Header at the start of a game file.
+* @param char magic[8], GAME_MAGIC without the terminating zero.
+* @param uint32_t version, GAME_VERSION.
+* @param uint32_t reserved, zero.
+*/
+typedef struct{
+	char magic[8];
+	uint32_t version;
+	uint32_t reserved;
+	} TGameHeader;
+
+/**
+* @short One game.
+* @param char black, char white, the player names.
+* @param int flags, GAME_WEIRD for the modified rules, GAME_TIMES if
+* times are known.
+* @param int result, final disc difference for black, GAME_NO_RESULT if
+* the game did not finish.
+* @param int count, number of moves.
+* @param uint8_t moves, squares 0..63 from the start, PASS_MOVE for passes.
+* @param uint16_t times, hundredths of a second taken by each move.
+*/
+typedef struct TGameRecord{
+	char black[GAME_MAX_NAME+1];
+	char white[GAME_MAX_NAME+1];
+	int flags;
+	int result;
+	int count;
+	uint8_t moves[GAME_MAX_MOVES];
+	uint16_t times[GAME_MAX_MOVES];
+	} TGameRecord;
+
+/**
+* Empties a game: no names, no moves, no result.
+*/
+void clearGame(TGameRecord *game);
+
+/**
+* Writes a game as a line of text: black, white, result, "normal" or
+* "weird", the moves like "f5d6pa", and the times in seconds if known,
+* separated by tabs. Tabs in names become spaces.
+* @param const TGameRecord *game, the game.
+* @param char *text, the line is saved here, without newline.
+* @param int size, size of text, GAME_TEXT_SIZE is always enough.
+*/
+void gameToText(const TGameRecord *game, char *text, int size);
+
+/**
+* Reads a game written by gameToText().
+* @param const char *text, the line.
+* @param TGameRecord *game, the game is saved here.
+* @return Returns 0, or -1 if the line is not a game.
+*/
+int gameFromText(const char *text, TGameRecord *game);
+
+/**
+* @short Writes game files, buffered.
+*/
+class TGameWriter
+{
+	public:
+
+TGameWriter();
+
+/**
+* Destructor. Closes the file.
+*/
+~TGameWriter();
+
+/**
+* Creates a file, or opens one to add games to.
+* @param const char *path, the file, "-" for standard output.
+* @param bool append, true to keep the games already in the file.
+* @return Returns 0, or -1 if the file can't be written or is not a game file.
+*/
+int open(const char *path, bool append);
+
+/**
+* Adds a game.
+* @return Returns 0, or -1 on write error.
+*/
+int write(const TGameRecord *game);
+
+/**
+* Flushes and closes the file.
+* @return Returns 0, or -1 if something could not be written.
+*/
+int close();
+
+	private:
+
+FILE *file;
+bool failed;
+};
+
+/**
+* @short Reads game files, buffered.
+*
+* Records are decoded straight from a big buffer, there is one read()
+* system call per buffer and no per-game allocation.
+*/
+class TGameReader
+{
+	public:
+
+TGameReader();
+
+/**
+* Destructor. Closes the file.
+*/
+~TGameReader();
+
+/**
+* Opens a file and checks its header.
+* @param const char *path, the file, "-" for standard input.
+* @return Returns 0, or -1 if the file can't be read or is not a game file.
+*/
+int open(const char *path);
+
+/**
+* Reads the next game.
+* @param TGameRecord *game, the game is saved here.
+* @return Returns 1, 0 at the end of the file, -1 if the file is broken.
+*/
+int read(TGameRecord *game);
+
+/**
+* Closes the file.
+*/
+void close();
+
+	private:
+
+/**
+* Moves the unread bytes to the front of the buffer and reads more.
+* @return Returns the number of bytes read, 0 at the end, -1 on error.
+*/
+int fill();
+
+int fd;
+std::vector<uint8_t> buffer;
+unsigned int start;
+unsigned int end;
+};
+
+#endif /* GAMERECORD_H */
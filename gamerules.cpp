@@ -16,21 +16,19 @@
  ***************************************************************************/
 
 #include <qvaluelist.h>
-#include <memory>
 
 #include "gamerules.h"
 #include "rules.h"
 #include "board.h"
+#include "trace.h"
 
 
-GameRules::GameRules(bool weird) : TRules(weird),
-                         board(new QValueList<unsigned int>),
-                         changes(new QValueList<unsigned int>)
+GameRules::GameRules(bool weird) : TRules(weird)
 {
-  for (int i=0; i<ROWS*COLUMNS; i++) {
-    board->append(getPiece(i));
-  }
   turn = BLACK;
+  lastMove = ROWS*COLUMNS;
+  lastMover = BLANK;
+  flipCount = 0;
 }
 
 GameRules::~GameRules() {}
@@ -79,20 +77,74 @@ unsigned int GameRules::getScore(unsigned int color)
 }
 
 
+// position of the last move, ROWS*COLUMNS if none
+unsigned int GameRules::getLastMove()
+{
+  return lastMove;
+}
+
+
+// pieces flipped by the last move
+const unsigned int* GameRules::getFlipped()
+{
+  return flipped;
+}
+
+
+// number of pieces flipped by the last move
+unsigned int GameRules::getFlipCount()
+{
+  return flipCount;
+}
+
+
+// put the pieces of a position on the board as they are, no rules checked
+void GameRules::setPosition(uint64_t black, uint64_t white, unsigned int turn)
+{
+  for (unsigned int pos=0; pos<ROWS*COLUMNS; pos++) {
+    TCoord c = uiToTCoord(pos);
+    TBoard::board[c.x][c.y] = ((black >> pos) & 1) ? BLACK : ((white >> pos) & 1) ? WHITE : BLANK;
+  }
+  this->turn = turn;
+  lastMove = ROWS*COLUMNS;
+  lastMover = BLANK;
+  flipCount = 0;
+}
+
+
 // get changed positions, first item in list is the new piece color followed by position
 // uses BLACK BLANK WHITE
 QValueList<unsigned int>::iterator GameRules::getChanges()
 {
-  QValueList<unsigned int>::iterator it = changes->begin();
-  return it;
+  changes.clear();
+  if (lastMove < ROWS*COLUMNS) {
+    changes.append(lastMover);
+    changes.append(lastMove);
+    // every changed position in order, the new piece among them
+    bool placed = false;
+    for (unsigned int i=0; i<flipCount; i++) {
+      if (!placed && lastMove < flipped[i]) {
+        changes.append(lastMove);
+        placed = true;
+      }
+      changes.append(flipped[i]);
+    }
+    if (!placed) {
+      changes.append(lastMove);
+    }
+  }
+  return changes.begin();
 }
 
 
 // get current board status.
 QValueList<unsigned int>::iterator GameRules::getBoard()
 {
-  QValueList<unsigned int>::iterator it = board->begin();
-  return it;
+  board.clear();
+  for (int i=0; i<ROWS*COLUMNS; i++) {
+    board.append(getPiece(i));
+  }
+  return board.begin();
 }
 
 
@@ -118,39 +170,18 @@ unsigned int GameRules::TCoordToUi(TCoord pos)
 
 // PRIVATE
 
-// updates Board, updates Changes 
+// remembers the move and unpacks its flip mask
 void GameRules::updateBoard(unsigned int pos)
 {
-  int i;
-  
-  std::auto_ptr< QValueList<unsigned int> > temp( new QValueList<unsigned int> );
-  
-  QValueList<unsigned int>::iterator itt;
-  QValueList<unsigned int>::iterator itb;
-
-  for ( itb = board->begin(); itb != board->end(); ++itb ) {
-    temp->append((*itb));
-  }
-  
-  // clear & update board
-  board->clear();
-  for (i=0; i<ROWS*COLUMNS; i++) {
-    board->append(getPiece(i));
-  }
-
-  // clear & update changes to board
-  changes->clear();
-  changes->append(getTurn());
-  changes->append(pos);
-  
-  // i is current position
-  for ( itt = temp->begin(), itb = board->begin(), i=0;
-        itt != temp->end();
-        ++itt, ++itb, i++
-      ) {
-    if ( (*itt)!=(*itb) ) {
-      changes->append(i);
-    }
+  TRACE_SCOPE("GameRules::updateBoard");
+  uint64_t flips = lastFlips();
+
+  lastMove = pos;
+  lastMover = turn;
+  flipCount = 0;
+  while (flips) {
+    flipped[flipCount++] = __builtin_ctzll(flips);
+    flips &= flips-1;
   }
 }
 
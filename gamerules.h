@@ -79,9 +79,35 @@ class GameRules : public TRules
     */
     unsigned int getScore(unsigned int color);
 
+    /**
+    * Get the position of the last move.
+    * @return Returns the GUI-format (0..63) position of the last move, ROWS*COLUMNS before the first move.
+    */
+    unsigned int getLastMove();
+
+    /**
+    * Get the pieces the last move flipped, see also lastFlips() for them as a bit mask.
+    * @return Returns the GUI-format positions of the flipped pieces in ascending order, getFlipCount() of them.
+    */
+    const unsigned int* getFlipped();
+
+    /**
+    * Get the number of pieces the last move flipped.
+    * @return Returns the length of the getFlipped() array.
+    */
+    unsigned int getFlipCount();
+
+    /**
+    * Sets the pieces and the turn, as for going back to an earlier position. The last move is forgotten.
+    * @param black Bitboard of the black pieces.
+    * @param white Bitboard of the white pieces.
+    * @param turn BLACK or WHITE to move, BLANK if the game is over.
+    */
+    void setPosition(uint64_t black, uint64_t white, unsigned int turn);
+
     /**
     * Get a list of positions changed since the last move. First item in the list is the new piece's color, followed
-    * by GUI-format positions for the changed pieces.
+    * by GUI-format positions for the changed pieces. Built on every call from getFlipped(), which is cheaper.
     * @return Returns a QValueListIterator with the last move's color followed by its position and positions of changed pieces.
     */
     // get changed positions, first item in list is the new piece
@@ -89,6 +115,7 @@ class GameRules : public TRules
 
     /**
     * Get the current status of the board. Ordered from 0 to 63 according to GUI-format.
+    * Built on every call, getPiece() is cheaper.
     * @return Returns a QValueListIterator with the colors of pieces, ordered from 0 to 63. Possible values BLANK, BLACK and WHITE.
     */
     // get current board status. uses BLANK, BLACK and WHITE from piece.h
@@ -112,7 +139,7 @@ class GameRules : public TRules
 
   private:
     /**
-    * Updates getBoard-list and getChanges-list.
+    * Records the last move and the pieces it flipped.
     * @param pos Position of the new move.
     */
     void updateBoard(unsigned int pos);
@@ -121,10 +148,14 @@ class GameRules : public TRules
     */
     void updateTurn();
 
-    auto_ptr< QValueList<unsigned int> > board;
-    auto_ptr< QValueList<unsigned int> > changes;
+    QValueList<unsigned int> board;
+    QValueList<unsigned int> changes;
 
     unsigned int turn;
+    unsigned int lastMove;
+    unsigned int lastMover;
+    unsigned int flipped[ROWS*COLUMNS];
+    unsigned int flipCount;
 };
 
 #endif // GAMERULES_H
@@ -0,0 +1,144 @@
+/** @file gamesmain.cpp
+ *  othello-games, converts game files to text and back. Text has one
+ *  game per line, see gameToText().
+ *
+ *  usage: othello-games [-b] [-a] [input [output]]
+ *    -b            text to binary (default: binary to text)
+ *    -a            add to the output file instead of replacing it
+ *  "-" or a missing name is standard input or output.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "gamerecord.h"
+
+static void usage()
+{
+	fprintf(stderr, "usage: othello-games [-b] [-a] [input [output]]\n");
+	exit(1);
+}
+
+/**
+* Converts text lines to a game file.
+* @return Returns the number of games, -1 on error.
+*/
+static int textToGames(const char *input, const char *output, bool append)
+{
+	char line[GAME_TEXT_SIZE];
+	TGameWriter writer;
+	TGameRecord game;
+	FILE *file;
+	int games=0, lines=0;
+
+	file=(strcmp(input, "-") == 0) ? stdin : fopen(input, "r");
+	if(file == NULL)
+	{
+		fprintf(stderr, "othello-games: can't read %s\n", input);
+		return -1;
+	}
+	if(writer.open(output, append) == -1)
+	{
+		fprintf(stderr, "othello-games: can't write %s\n", output);
+		return -1;
+	}
+
+	while(fgets(line, sizeof(line), file) != NULL)
+	{
+		lines++;
+		if(line[0] == '#' || line[strspn(line, " \t\r\n")] == 0)
+			continue;
+		if(gameFromText(line, &game) == -1)
+		{
+			fprintf(stderr, "othello-games: %s:%d: not a game\n", input, lines);
+			continue;
+		}
+		if(writer.write(&game) == -1)
+			break;
+		games++;
+	}
+
+	if(file != stdin)
+		fclose(file);
+	if(writer.close() == -1)
+	{
+		fprintf(stderr, "othello-games: can't write %s\n", output);
+		return -1;
+	}
+	return games;
+}
+
+/**
+* Converts a game file to text lines.
+* @return Returns the number of games, -1 on error.
+*/
+static int gamesToText(const char *input, const char *output, bool append)
+{
+	char line[GAME_TEXT_SIZE];
+	TGameReader reader;
+	TGameRecord game;
+	FILE *file;
+	int games=0, status;
+
+	if(reader.open(input) == -1)
+	{
+		fprintf(stderr, "othello-games: %s is not a game file\n", input);
+		return -1;
+	}
+	file=(strcmp(output, "-") == 0) ? stdout : fopen(output, append ? "a" : "w");
+	if(file == NULL)
+	{
+		fprintf(stderr, "othello-games: can't write %s\n", output);
+		return -1;
+	}
+
+	while((status=reader.read(&game)) == 1)
+	{
+		gameToText(&game, line, sizeof(line));
+		fprintf(file, "%s\n", line);
+		games++;
+	}
+	if(status == -1)
+		fprintf(stderr, "othello-games: %s is broken after %d games\n", input, games);
+
+	if((file == stdout) ? fflush(file) != 0 : fclose(file) != 0)
+	{
+		fprintf(stderr, "othello-games: can't write %s\n", output);
+		return -1;
+	}
+	return (status == -1) ? -1 : games;
+}
+
+int main(int argc, char *argv[])
+{
+	const char *input="-", *output="-";
+	bool binary=false, append=false;
+	int opt, games;
+
+	while((opt=getopt(argc, argv, "ba")) != -1)
+	{
+		switch (opt)
+		{
+			case 'b' : binary=true; break;
+			case 'a' : append=true; break;
+			default : usage();
+		}
+	}
+	if(argc-optind > 2)
+		usage();
+	if(optind < argc)
+		input=argv[optind];
+	if(optind+1 < argc)
+		output=argv[optind+1];
+
+	if(binary)
+		games=textToGames(input, output, append);
+	else
+		games=gamesToText(input, output, append);
+
+	if(games == -1)
+		return 1;
+	fprintf(stderr, "%d games\n", games);
+	return 0;
+}
@@ -0,0 +1,207 @@
+#include "gamestate.h"
+#include "gamerules.h"
+#include "trace.h"
+
+#include <string.h>
+
+// the empty snapshot, shared by every default-made one and never freed
+static GameSnapshotData* emptySnapshot()
+{
+  static GameSnapshotData* empty = NULL;
+  if (empty == NULL) {
+    GameLog* log = new GameLog;
+    log->length = 0;
+    empty = new GameSnapshotData;
+    empty->black = empty->white = 0;
+    empty->turn = BLANK;
+    empty->weird = FALSE;
+    empty->moves = 0;
+    empty->log = log;
+  }
+  return empty;
+}
+
+GameSnapshot::GameSnapshot()
+    : d( emptySnapshot() )
+{
+  d->ref();
+}
+
+// takes over the reference of data
+GameSnapshot::GameSnapshot( GameSnapshotData* data )
+    : d( data )
+{
+}
+
+GameSnapshot::GameSnapshot( const GameSnapshot& other )
+    : d( other.d )
+{
+  d->ref();
+}
+
+// the last snapshot of a log frees it
+GameSnapshot::~GameSnapshot()
+{
+  if (d->deref()) {
+    if (d->log->deref()) {
+      delete d->log;
+    }
+    delete d;
+  }
+}
+
+GameSnapshot& GameSnapshot::operator=( const GameSnapshot& other )
+{
+  other.d->ref();
+  // old takes the reference this held and drops it on the way out
+  GameSnapshot old( d );
+  d = other.d;
+  return *this;
+}
+
+// color of a square from the bitboards
+unsigned int GameSnapshot::piece( unsigned int pos ) const
+{
+  if ((d->black >> pos) & 1) {
+    return BLACK;
+  } else if ((d->white >> pos) & 1) {
+    return WHITE;
+  }
+  return BLANK;
+}
+
+// pieces of a color
+unsigned int GameSnapshot::score( unsigned int color ) const
+{
+  return countBits( (color == BLACK) ? d->black : d->white );
+}
+
+// the bitboards, the side asked for first
+TPosition GameSnapshot::position( unsigned int color ) const
+{
+  TPosition pos;
+  pos.own = (color == BLACK) ? d->black : d->white;
+  pos.enemy = (color == BLACK) ? d->white : d->black;
+  return pos;
+}
+
+
+GameState::GameState()
+    : QObject(), board(new GameRules()), log(new GameLog), at(0), last(0), weird(FALSE)
+{
+  log->length = 0;
+  TPosition start = positionFromRules(*board, BLACK);
+  takeSnapshot(start.own, start.enemy);
+}
+
+GameState::~GameState()
+{
+  if (log->deref()) {
+    delete log;
+  }
+  delete board;
+}
+
+// fresh rules and log, the old snapshots keep the old ones
+void GameState::newGame( bool weird )
+{
+  delete board;
+  board = new GameRules(weird);
+  this->weird = weird;
+  if (log->deref()) {
+    delete log;
+  }
+  log = new GameLog;
+  log->length = 0;
+  // the old game's snapshots go, unless somebody else still has them
+  for (unsigned int i=1; i<=last; i++) {
+    history[i] = GameSnapshot();
+  }
+  at = last = 0;
+  TPosition start = positionFromRules(*board, BLACK);
+  takeSnapshot(start.own, start.enemy);
+  emit gameStarted();
+}
+
+// the only place moves are checked
+bool GameState::play( unsigned int pos )
+{
+  TRACE_SCOPE("GameState::play");
+  unsigned int mover = board->getTurn();
+  if (!board->setPiece(pos)) {
+    return FALSE;
+  }
+  branchLog();
+  logMove(pos);
+  if (board->getTurn() == mover) {
+    logMove(PASS_MOVE);
+  }
+
+  // the new piece and the flips change sides, nothing else does
+  uint64_t changed = board->lastFlips() | (1ULL << pos);
+  uint64_t black = current.d->black, white = current.d->white;
+  if (mover == BLACK) {
+    black |= changed;
+    white &= ~changed;
+  } else {
+    white |= changed;
+    black &= ~changed;
+  }
+  at++;
+  takeSnapshot(black, white);
+  emit moveMade( pos );
+  return TRUE;
+}
+
+// the board from the snapshot, nothing replayed
+bool GameState::jumpTo( unsigned int ply )
+{
+  TRACE_SCOPE("GameState::jumpTo");
+  if (ply > last) {
+    return FALSE;
+  }
+  at = ply;
+  current = history[at];
+  board->setPosition(current.d->black, current.d->white, current.d->turn);
+  emit jumped();
+  return TRUE;
+}
+
+// append, the snapshots don't see past their own moves
+void GameState::logMove( unsigned int move )
+{
+  if (log->length < GAME_MAX_MOVES) {
+    log->moves[log->length++] = move;
+  }
+}
+
+// copy on write, the moves past the current one belong to the snapshots gone back from
+void GameState::branchLog()
+{
+  if (log->length == current.moves()) {
+    return;
+  }
+  GameLog* branch = new GameLog;
+  branch->length = current.moves();
+  memcpy(branch->moves, log->moves, branch->length);
+  if (log->deref()) {
+    delete log;
+  }
+  log = branch;
+}
+
+// one allocation per move, shared by everybody who looks
+void GameState::takeSnapshot( uint64_t black, uint64_t white )
+{
+  GameSnapshotData* data = new GameSnapshotData;
+  data->black = black;
+  data->white = white;
+  data->turn = board->getTurn();
+  data->weird = weird;
+  data->moves = log->length;
+  data->log = log;
+  log->ref();
+  current = GameSnapshot( data );
+  history[at] = current;
+  last = at;
+}
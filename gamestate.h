@@ -0,0 +1,218 @@
+/** @file gamestate.h
+ *  The one game everybody looks at. The board view plays the moves into
+ *  a GameState, and the players and views read it through snapshots
+ *  instead of replaying the moves into boards of their own. The snapshot
+ *  of every move is kept, so the game can go back and forth in time.
+*/
+
+#ifndef GAMESTATE_H
+#define GAMESTATE_H
+
+#include <qobject.h>
+#include <qshared.h>
+
+#include "position.h"
+#include "gamerecord.h"
+
+class GameRules;
+
+/**
+* @short Moves of a game, shared by the snapshots taken of it.
+*
+* Moves are only ever added to the end of the log, so a snapshot sees
+* the moves up to its own count however many are added after it. A new
+* game gets a new log, and so does a move played after going back, the
+* snapshots that were gone back from keep the old one.
+*/
+struct GameLog : public QShared
+{
+    /**
+    * Moves in GUI-format (0..63), PASS_MOVE for a pass.
+    */
+    unsigned char moves[GAME_MAX_MOVES];
+    /**
+    * Moves in the log.
+    */
+    unsigned int length;
+};
+
+/**
+* @short Data of a snapshot, shared by its copies.
+*/
+struct GameSnapshotData : public QShared
+{
+    uint64_t black;
+    uint64_t white;
+    unsigned int turn;
+    bool weird;
+    unsigned int moves;
+    GameLog* log;
+};
+
+/**
+* @short An unchanging view of the game after some move.
+*
+* Copying a snapshot only counts a reference, so snapshots can be passed
+* around and kept freely.
+*/
+class GameSnapshot
+{
+public:
+    /**
+    * Makes an empty board with nobody to move.
+    */
+    GameSnapshot();
+    GameSnapshot( const GameSnapshot& other );
+    ~GameSnapshot();
+    GameSnapshot& operator=( const GameSnapshot& other );
+
+    /**
+    * Get the color to move.
+    * @return Returns BLACK or WHITE, or BLANK when the game is over.
+    */
+    unsigned int turn() const { return d->turn; }
+    /**
+    * Get the color of a square.
+    * @return Returns BLANK, BLACK or WHITE.
+    * @param pos GUI-format (0..63) square.
+    */
+    unsigned int piece( unsigned int pos ) const;
+    /**
+    * Get the score of a player.
+    * @return Returns the number of pieces of color.
+    * @param color BLACK or WHITE.
+    */
+    unsigned int score( unsigned int color ) const;
+    /**
+    * Get the board as a bitboard position.
+    * @return Returns the position seen from color.
+    * @param color BLACK or WHITE.
+    */
+    TPosition position( unsigned int color ) const;
+    /**
+    * Whether the game is played with the modified rules.
+    */
+    bool weird() const { return d->weird; }
+    /**
+    * Get the number of moves made, passes included.
+    */
+    unsigned int moves() const { return d->moves; }
+    /**
+    * Get a move made.
+    * @return Returns the GUI-format square, or PASS_MOVE.
+    * @param i Number of the move, from 0.
+    */
+    unsigned int move( unsigned int i ) const { return d->log->moves[i]; }
+
+private:
+    friend class GameState;
+    GameSnapshot( GameSnapshotData* data );
+
+    GameSnapshotData* d;
+};
+
+/**
+* @short The game being played.
+*
+* Moves are checked against the rules once, here. Whoever wants to know
+* about them connects to moveMade(), gameStarted() and jumped() and reads
+* snapshot().
+*
+* The snapshots after each ply, a move and the pass that may follow it,
+* are kept in order. Going to any of them puts its pieces back on the
+* board without replaying anything. Playing a move drops the snapshots
+* after the current one.
+*/
+class GameState : public QObject
+{
+    Q_OBJECT
+public:
+    GameState();
+    ~GameState();
+
+    /**
+    * Starts a new game and emits gameStarted().
+    * @param weird TRUE for modified rules, FALSE for normal rules.
+    */
+    void newGame( bool weird=FALSE );
+    /**
+    * Plays a move for the player to move, and a pass for the opponent if it
+    * has no move. Emits moveMade() if the move is legal.
+    * @return Returns TRUE on success, FALSE on illegal move.
+    * @param pos GUI-format (0..63) square.
+    */
+    bool play( unsigned int pos );
+    /**
+    * Goes back or forward to an earlier position of the game and emits jumped().
+    * @return Returns FALSE if there is no such ply, TRUE otherwise.
+    * @param ply Number of plies played to the position, 0 for the start, up to plies().
+    */
+    bool jumpTo( unsigned int ply );
+    /**
+    * Get the ply the game is at.
+    * @return Returns the number of plies played to the current position.
+    */
+    unsigned int ply() const { return at; }
+    /**
+    * Get the number of plies that can be gone to, the ones after ply() are the ones gone back from.
+    */
+    unsigned int plies() const { return last; }
+    /**
+    * Get the game as it is now.
+    */
+    GameSnapshot snapshot() const { return current; }
+    /**
+    * Get the game as it was after a ply.
+    * @param ply Number of plies played, up to plies().
+    */
+    GameSnapshot snapshot( unsigned int ply ) const { return history[ply]; }
+    /**
+    * Get the rules the game is played with, for looking only.
+    */
+    GameRules* rules() { return board; }
+
+signals:
+    /**
+    * Tells that a move was played.
+    * @param unsigned GUI-format (0..63) square of the move.
+    */
+    void moveMade( unsigned int );
+    /**
+    * Tells that a new game has started.
+    */
+    void gameStarted();
+    /**
+    * Tells that the game went back or forward to an earlier position, see jumpTo().
+    */
+    void jumped();
+
+private:
+    /**
+    * Adds a move to the end of the log.
+    * @param move GUI-format (0..63) square, or PASS_MOVE.
+    */
+    void logMove( unsigned int move );
+    /**
+    * Swaps the log for a copy without the moves gone back from, if it has any.
+    */
+    void branchLog();
+    /**
+    * Makes current from the board, the log and the pieces and adds it to the history after ply().
+    * @param black Bitboard of the black pieces.
+    * @param white Bitboard of the white pieces.
+    */
+    void takeSnapshot( uint64_t black, uint64_t white );
+
+    GameRules* board;
+    GameLog* log;
+    GameSnapshot current;
+    /**
+    * Snapshots of the plies, up to last. Each ply places a piece, so there are no more plies than moves.
+    */
+    GameSnapshot history[GAME_MAX_MOVES+1];
+    unsigned int at;
+    unsigned int last;
+    bool weird;
+};
+
+#endif  // GAMESTATE_H
@@ -0,0 +1,62 @@
+#include "heatmark.h"
+#include "search.h"
+
+#include <qpainter.h>
+#include <stdio.h>
+
+HeatMark::HeatMark( QCanvas *canvas ) : QCanvasRectangle( canvas )
+{
+  setSize( SQUARE_W, SQUARE_H );
+  setZ( HEAT_Z );
+}
+
+HeatMark::~HeatMark()
+{
+  hide();
+}
+
+// move onto square pos, same place as the piece there
+void HeatMark::setPosition( unsigned int pos )
+{
+  move( (pos % COLUMNS)*SQUARE_W+1, (pos / ROWS)*SQUARE_H+1 );
+}
+
+// green for the best move, red for HEAT_RANGE discs worse or more
+void HeatMark::setScore( int score, int best, bool exact )
+{
+  char buf[16];
+  double loss = (double)(best - score) / (HEAT_RANGE*SCORE_DISC);
+
+  if (loss < 0) loss = 0;
+  if (loss > 1) loss = 1;
+  QColor newColor( (int)(loss < 0.5 ? 2*loss*220 : 220), (int)(loss < 0.5 ? 200 : 2*(1-loss)*200), 0 );
+
+  if (exact) {
+    snprintf( buf, sizeof(buf), "%+d", score/SCORE_DISC );
+  } else {
+    snprintf( buf, sizeof(buf), "%+.1f", (double)score/SCORE_DISC );
+  }
+  // the same mark again needs no redraw
+  if (newColor == color && text == buf) {
+    return;
+  }
+  color = newColor;
+  text = buf;
+  update();
+}
+
+int HeatMark::rtti() const {
+  return HEAT_RTTI;
+}
+
+void HeatMark::drawShape( QPainter &p )
+{
+  int d = SQUARE_W/2;
+  QRect square( (int)x(), (int)y(), SQUARE_W, SQUARE_H );
+
+  p.setPen( Qt::black );
+  p.setBrush( color );
+  p.drawEllipse( (int)x()+(SQUARE_W-d)/2, (int)y()+(SQUARE_H-d)/2, d, d );
+  p.setFont( QFont( "Helvetica", 8, QFont::Bold ) );
+  p.drawText( square, Qt::AlignCenter, text );
+}
@@ -0,0 +1,63 @@
+/** @file heatmark.h
+ *  Analysis score shown on an empty square.
+*/
+
+#ifndef HEATMARK_H
+#define HEATMARK_H
+
+#include <qcanvas.h>
+#include <qstring.h>
+#include <qcolor.h>
+
+#include "piece.h"
+
+#define HEAT_RTTI 1003
+
+// above the pieces, below the flip animations
+#define HEAT_Z 99
+
+// score difference to the best move, in discs, at which the mark is fully red
+#define HEAT_RANGE 8
+
+/**
+* @short Coloured score mark for the analysis heatmap.
+*
+* A HeatMark covers one square of the board. It shows how a move there
+* scores, green for the best move shading to red for bad ones.
+*/
+class HeatMark : public QCanvasRectangle
+{
+public:
+    HeatMark( QCanvas *canvas );
+    ~HeatMark();
+
+    /**
+    * Moves the mark onto a square.
+    * @param pos GUI-format (0..63) position of the square.
+    */
+    void setPosition( unsigned int pos );
+    /**
+    * Sets the score to show.
+    * @param score Score of the move, in search units.
+    * @param best Score of the best move, in search units.
+    * @param exact TRUE if the score is a perfect play result, shown in whole discs.
+    */
+    void setScore( int score, int best, bool exact );
+    /**
+    * Gets HEAT_RTTI to identify a HeatMark from other QCanvasItems
+    * @return Returns HEAT_RTTI
+    */
+    int rtti() const;
+
+protected:
+    /**
+    * Draws a coloured disc with the score on it.
+    */
+    void drawShape( QPainter & );
+
+private:
+    QString text;
+    QColor color;
+};
+
+#endif  // HEATMARK_H
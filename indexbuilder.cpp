@@ -0,0 +1,429 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <queue>
+#include <algorithm>
+#include "indexbuilder.h"
+#include "posindex.h"
+#include "gamerecord.h"
+#include "position.h"
+#include "workpool.h"
+
+/// Buffer of each file read or written while merging
+#define MERGE_BUFFER (1 << 20)
+/// Fewest games replayed by a thread at a time
+#define MIN_CHUNK 1024
+
+/**
+* @short A position reached in a game, as sorted into the runs.
+* @param uint64_t hash, positionHash() of the canonical position.
+* @param uint32_t game, number of the game in the game file.
+* @param uint8_t ply, moves played before the position.
+* @param uint8_t move, next move in canonical orientation, NO_MOVE at the end.
+* @param int8_t result, final disc difference for the player to move,
+* GAME_NO_RESULT if the game did not finish.
+*/
+typedef struct{
+	uint64_t hash;
+	uint32_t game;
+	uint8_t ply;
+	uint8_t move;
+	int8_t result;
+	uint8_t reserved;
+	} TIndexItem;
+
+/**
+* @short Games replayed by one thread into one run.
+* @param std::vector<TGameRecord> games, the games.
+* @param uint32_t first, number of the first game.
+* @param std::string run, the run file to write.
+* @param uint64_t positions, positions written.
+* @param uint64_t skipped, games left out.
+* @param int status, 0, or -1 if the run could not be written.
+*/
+typedef struct{
+	std::vector<TGameRecord> games;
+	uint32_t first;
+	std::string run;
+	uint64_t positions;
+	uint64_t skipped;
+	int status;
+	} TIndexChunk;
+
+/**
+* Orders items by hash, then by game and ply.
+*/
+static bool itemBefore(const TIndexItem &a, const TIndexItem &b)
+{
+	if(a.hash != b.hash)
+		return a.hash < b.hash;
+	if(a.game != b.game)
+		return a.game < b.game;
+	return a.ply < b.ply;
+}
+
+/**
+* Replays a game and adds the positions it reaches.
+* @return Returns 0, or -1 if the game has an illegal move.
+*/
+static int addGame(const TGameRecord *game, uint32_t number, std::vector<TIndexItem> &items)
+{
+	TRules start;
+	TPosition pos=positionFromRules(start, BLACK), key;
+	bool blackToMove=true;
+	uint64_t legal;
+	TIndexItem item;
+	int i, sym, move;
+
+	memset(&item, 0, sizeof(item));
+	item.game=number;
+	for(i=0; i<=game->count; i++)
+	{
+		move=(i < game->count) ? game->moves[i] : NO_MOVE;
+		key=canonicalPosition(pos, &sym);
+		item.hash=positionHash(key);
+		item.ply=i;
+		item.move=transformSquare(move, sym);
+		if(game->result == GAME_NO_RESULT)
+			item.result=GAME_NO_RESULT;
+		else
+			item.result=blackToMove ? game->result : -game->result;
+		items.push_back(item);
+
+		if(move == NO_MOVE)
+			break;
+		legal=legalMoves(pos);
+		if(move == PASS_MOVE ? legal != 0 : (legal & ((uint64_t)1 << move)) == 0)
+			return -1;
+		pos=playMove(pos, move);
+		blackToMove=!blackToMove;
+	}
+
+	return 0;
+}
+
+/**
+* Replays chunk index of the chunks in data and writes the sorted run.
+*/
+static void chunkJob(int index, void *data)
+{
+	TIndexChunk *chunk=(TIndexChunk *)data+index;
+	std::vector<TIndexItem> items;
+	unsigned int i, mark;
+	FILE *file;
+
+	items.reserve(chunk->games.size()*(SQUARES-3));
+	for(i=0; i<chunk->games.size(); i++)
+	{
+		mark=items.size();
+		if((chunk->games[i].flags & GAME_WEIRD) ||
+			addGame(&chunk->games[i], chunk->first+i, items) == -1)
+		{
+			items.resize(mark);
+			chunk->skipped++;
+		}
+	}
+	std::sort(items.begin(), items.end(), itemBefore);
+
+	chunk->positions=items.size();
+	file=fopen(chunk->run.c_str(), "wb");
+	if(file == NULL)
+	{
+		chunk->status=-1;
+		return;
+	}
+	if((!items.empty() && fwrite(&items[0], sizeof(TIndexItem), items.size(), file) != items.size()) ||
+		fclose(file) != 0)
+		chunk->status=-1;
+}
+
+/**
+* @short The next item of a run, while merging.
+*/
+typedef struct{
+	TIndexItem item;
+	int run;
+	} TMergeHead;
+
+/**
+* Orders merge heads for a priority queue, smallest first.
+*/
+struct TMergeAfter
+{
+	bool operator()(const TMergeHead &a, const TMergeHead &b) const
+	{
+		return itemBefore(b.item, a.item);
+	}
+};
+
+/**
+* Writes the entry of a finished group of items, with its next moves.
+* @return Returns 0, or -1 on write error.
+*/
+static int writeEntry(TIndexEntry *entry, const uint32_t *moveGames, FILE *entries,
+	FILE *moves, uint64_t *moveCount)
+{
+	TIndexMove list[INDEX_MAX_MOVES];
+	int count=0, i, j;
+
+	memset(list, 0, sizeof(list));
+	for(i=0; i<INDEX_MAX_MOVES; i++)
+		if(moveGames[i] > 0)
+		{
+			/// Insertion sort, most played first.
+			for(j=count; j > 0 && list[j-1].games < moveGames[i]; j--)
+				list[j]=list[j-1];
+			list[j].games=moveGames[i];
+			list[j].move=i;
+			count++;
+		}
+
+	entry->move=*moveCount;
+	entry->moves=count;
+	*moveCount+=count;
+
+	if((count > 0 && fwrite(list, sizeof(TIndexMove), count, moves) != (size_t)count) ||
+		fwrite(entry, sizeof(TIndexEntry), 1, entries) != 1)
+		return -1;
+	return 0;
+}
+
+/**
+* Appends a whole file to another.
+* @return Returns 0, or -1 on read or write error.
+*/
+static int appendFile(FILE *to, FILE *from)
+{
+	std::vector<char> buffer(MERGE_BUFFER);
+	size_t got;
+
+	rewind(from);
+	while((got=fread(&buffer[0], 1, buffer.size(), from)) > 0)
+		if(fwrite(&buffer[0], 1, got, to) != got)
+			return -1;
+	return ferror(from) ? -1 : 0;
+}
+
+/**
+* Merges the sorted runs into the index file.
+* @return Returns 0, or -1 on read or write error.
+*/
+static int mergeRuns(const std::vector<std::string> &runs, const char *path, uint64_t games,
+	TIndexBuildStats *stats)
+{
+	std::priority_queue<TMergeHead, std::vector<TMergeHead>, TMergeAfter> heads;
+	std::vector<FILE *> files(runs.size(), (FILE *)NULL);
+	std::string temp=std::string(path)+".tmp";
+	std::string moveTemp=std::string(path)+".moves";
+	std::string occurrenceTemp=std::string(path)+".occurrences";
+	uint32_t moveGames[INDEX_MAX_MOVES];
+	FILE *out, *moves, *occurrences;
+	TIndexHeader header;
+	TIndexEntry entry;
+	TIndexOccurrence occurrence;
+	TMergeHead head;
+	bool open=false, failed=false;
+	unsigned int i;
+
+	out=fopen(temp.c_str(), "w+b");
+	moves=fopen(moveTemp.c_str(), "w+b");
+	occurrences=fopen(occurrenceTemp.c_str(), "w+b");
+	if(out == NULL || moves == NULL || occurrences == NULL)
+		failed=true;
+
+	for(i=0; i<runs.size() && !failed; i++)
+	{
+		files[i]=fopen(runs[i].c_str(), "rb");
+		if(files[i] == NULL)
+		{
+			failed=true;
+			break;
+		}
+		setvbuf(files[i], NULL, _IOFBF, MERGE_BUFFER);
+		head.run=i;
+		if(fread(&head.item, sizeof(TIndexItem), 1, files[i]) == 1)
+			heads.push(head);
+	}
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, INDEX_MAGIC, sizeof(header.magic));
+	header.version=INDEX_VERSION;
+	header.entrySize=sizeof(TIndexEntry);
+	header.games=games;
+	memset(&entry, 0, sizeof(entry));
+	memset(&occurrence, 0, sizeof(occurrence));
+	if(!failed)
+	{
+		setvbuf(out, NULL, _IOFBF, MERGE_BUFFER);
+		setvbuf(moves, NULL, _IOFBF, MERGE_BUFFER);
+		setvbuf(occurrences, NULL, _IOFBF, MERGE_BUFFER);
+		failed=fwrite(&header, sizeof(header), 1, out) != 1;
+	}
+
+	/// Items come out by hash, each hash gathered into one entry.
+	while(!heads.empty() && !failed)
+	{
+		head=heads.top();
+		heads.pop();
+
+		if(!open || head.item.hash != entry.hash)
+		{
+			if(open && writeEntry(&entry, moveGames, out, moves, &header.moves) == -1)
+				failed=true;
+			header.entries+=open ? 1 : 0;
+			memset(&entry, 0, sizeof(entry));
+			memset(moveGames, 0, sizeof(moveGames));
+			entry.hash=head.item.hash;
+			entry.occurrence=header.occurrences;
+			open=true;
+		}
+
+		entry.games++;
+		if(head.item.move < INDEX_MAX_MOVES)
+			moveGames[head.item.move]++;
+		if(head.item.result != GAME_NO_RESULT)
+		{
+			entry.discs+=head.item.result;
+			if(head.item.result > 0)
+				entry.wins++;
+			else if(head.item.result < 0)
+				entry.losses++;
+			else
+				entry.draws++;
+		}
+
+		occurrence.game=head.item.game;
+		occurrence.ply=head.item.ply;
+		if(fwrite(&occurrence, sizeof(occurrence), 1, occurrences) != 1)
+			failed=true;
+		header.occurrences++;
+
+		if(fread(&head.item, sizeof(TIndexItem), 1, files[head.run]) == 1)
+			heads.push(head);
+	}
+	if(open && !failed)
+	{
+		if(writeEntry(&entry, moveGames, out, moves, &header.moves) == -1)
+			failed=true;
+		header.entries++;
+	}
+
+	for(i=0; i<files.size(); i++)
+		if(files[i] != NULL)
+		{
+			if(ferror(files[i]))
+				failed=true;
+			fclose(files[i]);
+		}
+
+	/// The sections are appended in order, then the header gets its counts.
+	if(!failed && (appendFile(out, moves) == -1 || appendFile(out, occurrences) == -1 ||
+		fseek(out, 0, SEEK_SET) != 0 || fwrite(&header, sizeof(header), 1, out) != 1))
+		failed=true;
+	if(out != NULL && fclose(out) != 0)
+		failed=true;
+	if(moves != NULL)
+		fclose(moves);
+	if(occurrences != NULL)
+		fclose(occurrences);
+	remove(moveTemp.c_str());
+	remove(occurrenceTemp.c_str());
+
+	if(failed || rename(temp.c_str(), path) != 0)
+	{
+		remove(temp.c_str());
+		return -1;
+	}
+
+	if(stats != NULL)
+		stats->entries=header.entries;
+	return 0;
+}
+
+/**
+* Builds an index of every position in a game file. The file is written
+* under a temporary name and renamed into place, so readers never map a
+* half-written index.
+* @param const char *games, the game file.
+* @param const char *path, the index file to write.
+* @param int threads, threads replaying and sorting.
+* @param size_t memory, bytes to use at most, roughly.
+* @param TIndexBuildStats *stats, if not NULL, what was done is saved here.
+* @return Returns 0, or -1 if the games can't be read or the index written.
+*/
+int buildPositionIndex(const char *games, const char *path, int threads, size_t memory,
+	TIndexBuildStats *stats)
+{
+	TGameReader reader;
+	TIndexBuildStats done;
+	std::vector<TIndexChunk> chunks;
+	std::vector<std::string> runs;
+	unsigned int chunkGames, i;
+	uint32_t next=0;
+	int status=1, used, retval=0;
+	char name[32];
+
+	memset(&done, 0, sizeof(done));
+	if(reader.open(games) == -1)
+		return -1;
+
+	if(threads < 1)
+		threads=1;
+	/// Each thread holds its games and the items of every position in them.
+	chunkGames=memory/threads/(sizeof(TGameRecord)+(SQUARES-3)*sizeof(TIndexItem));
+	if(chunkGames < MIN_CHUNK)
+		chunkGames=MIN_CHUNK;
+	chunks.resize(threads);
+
+	while(status == 1 && retval == 0)
+	{
+		/// Fill a chunk for every thread, then sort them all at once.
+		for(used=0; used<threads && status == 1; used++)
+		{
+			TIndexChunk &chunk=chunks[used];
+			chunk.games.resize(chunkGames);
+			chunk.first=next;
+			for(i=0; i<chunkGames && (status=reader.read(&chunk.games[i])) == 1; i++)
+				;
+			chunk.games.resize(i);
+			next+=i;
+			chunk.positions=0;
+			chunk.skipped=0;
+			chunk.status=0;
+			snprintf(name, sizeof(name), ".run%u", (unsigned int)runs.size());
+			chunk.run=std::string(path)+name;
+			runs.push_back(chunk.run);
+			if(i == 0)
+			{
+				used++;
+				break;
+			}
+		}
+
+		runJobs(chunkJob, &chunks[0], used, used);
+
+		for(i=0; i<(unsigned int)used; i++)
+		{
+			if(chunks[i].status == -1)
+				retval=-1;
+			done.games+=chunks[i].games.size()-chunks[i].skipped;
+			done.skipped+=chunks[i].skipped;
+			done.positions+=chunks[i].positions;
+		}
+	}
+	if(status == -1)
+		retval=-1;
+	std::vector<TIndexChunk>().swap(chunks);
+
+	done.runs=runs.size();
+	if(retval == 0)
+		retval=mergeRuns(runs, path, next, &done);
+	for(i=0; i<runs.size(); i++)
+		remove(runs[i].c_str());
+
+	if(stats != NULL)
+		*stats=done;
+	return retval;
+}
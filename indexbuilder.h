@@ -0,0 +1,48 @@
+/** @file indexbuilder.h
+ *  Builds a position index (see posindex.h) from a game file in bounded
+ *  memory, however big the game file is. Games are read in chunks, and
+ *  threads replay the chunks, sort the positions they reach by hash and
+ *  write them to run files next to the index. One merge pass over the
+ *  runs then writes the index.
+*/
+
+#ifndef INDEXBUILDER_H
+#define INDEXBUILDER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/// Memory used by default, in megabytes
+#define INDEX_MEMORY 1024
+
+/**
+* @short What building an index did.
+* @param uint64_t games, games indexed.
+* @param uint64_t skipped, games left out: weird rules or an illegal move.
+* @param uint64_t positions, positions reached in the games.
+* @param uint64_t entries, different positions.
+* @param int runs, sorted run files written.
+*/
+typedef struct{
+	uint64_t games;
+	uint64_t skipped;
+	uint64_t positions;
+	uint64_t entries;
+	int runs;
+	} TIndexBuildStats;
+
+/**
+* Builds an index of every position in a game file. The file is written
+* under a temporary name and renamed into place, so readers never map a
+* half-written index.
+* @param const char *games, the game file.
+* @param const char *path, the index file to write.
+* @param int threads, threads replaying and sorting.
+* @param size_t memory, bytes to use at most, roughly.
+* @param TIndexBuildStats *stats, if not NULL, what was done is saved here.
+* @return Returns 0, or -1 if the games can't be read or the index written.
+*/
+int buildPositionIndex(const char *games, const char *path, int threads, size_t memory,
+	TIndexBuildStats *stats);
+
+#endif /* INDEXBUILDER_H */
@@ -0,0 +1,157 @@
+/** @file indexmain.cpp
+ *  othello-index, builds a position index from a game file and looks
+ *  positions up in it.
+ *
+ *  usage: othello-index -b [-j threads] [-m megabytes] games index
+ *         othello-index [-n games] index [position]
+ *    -b            build index from the game file games
+ *    -j threads    threads replaying and sorting (default: number of processors)
+ *    -m megabytes  memory to use while building (default 1024)
+ *    -n games      games to list that reached the position (default 10)
+ *  The position is moves from the start like "f5d6c3", or a board as
+ *  read by parsePosition(). Without one the starting position is shown.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "posindex.h"
+#include "indexbuilder.h"
+#include "position.h"
+#include "search.h"
+
+static void usage()
+{
+	fprintf(stderr, "usage: othello-index -b [-j threads] [-m megabytes] games index\n"
+		"       othello-index [-n games] index [position]\n");
+	exit(1);
+}
+
+/**
+* Reads a position given as a board or as moves from the start.
+* @return Returns 0, or -1 if it is neither or a move is illegal.
+*/
+static int readPosition(const char *text, TPosition *pos)
+{
+	TRules start;
+	uint64_t legal;
+	int square;
+
+	if(parsePosition(text, pos) != -1)
+		return 0;
+
+	*pos=positionFromRules(start, BLACK);
+	for(; *text != 0; text+=2)
+	{
+		square=parseSquare(text);
+		if(square == -1)
+			return -1;
+		legal=legalMoves(*pos);
+		if(square == PASS_MOVE ? legal != 0 : (legal & ((uint64_t)1 << square)) == 0)
+			return -1;
+		*pos=playMove(*pos, square);
+	}
+	return 0;
+}
+
+/**
+* Prints what the index knows about a position.
+* @return Returns 0, or 1 if the position is in no game.
+*/
+static int showPosition(const TPositionIndex &index, TPosition pos, int list)
+{
+	TIndexStats stats;
+	const TIndexEntry *entry;
+	const TIndexOccurrence *games;
+	unsigned int finished, count, i;
+	double start=searchClock(), took;
+	char name[3];
+
+	entry=index.lookup(pos, &stats);
+	took=searchClock()-start;
+	if(entry == NULL)
+	{
+		printf("in none of %llu games (lookup %.1f us)\n",
+			(unsigned long long)index.games(), took*1e6);
+		return 1;
+	}
+
+	printf("in %u of %llu games (lookup %.1f us)\n", stats.games,
+		(unsigned long long)index.games(), took*1e6);
+	finished=stats.wins+stats.draws+stats.losses;
+	if(finished > 0)
+		printf("player to move: %.1f%% wins, %.1f%% draws, %.1f%% losses, %+.2f discs on average\n",
+			100.0*stats.wins/finished, 100.0*stats.draws/finished,
+			100.0*stats.losses/finished, stats.discs);
+
+	for(i=0; i<(unsigned int)stats.count; i++)
+	{
+		squareName(stats.moves[i], name);
+		printf("%s %8u %5.1f%%\n", name, stats.moveGames[i], 100.0*stats.moveGames[i]/stats.games);
+	}
+
+	games=index.occurrences(entry, &count);
+	for(i=0; i<count && (int)i<list; i++)
+		printf("game %u ply %u\n", games[i].game, games[i].ply);
+	if(count > (unsigned int)list)
+		printf("... %u more\n", count-list);
+
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	TIndexBuildStats stats;
+	TPositionIndex index;
+	TPosition pos;
+	int threads=sysconf(_SC_NPROCESSORS_ONLN), megabytes=INDEX_MEMORY, list=10;
+	bool build=false;
+	double start;
+	int opt;
+
+	while((opt=getopt(argc, argv, "bj:m:n:")) != -1)
+	{
+		switch (opt)
+		{
+			case 'b' : build=true; break;
+			case 'j' : threads=atoi(optarg); break;
+			case 'm' : megabytes=atoi(optarg); break;
+			case 'n' : list=atoi(optarg); break;
+			default : usage();
+		}
+	}
+
+	if(build)
+	{
+		if(argc-optind != 2 || megabytes < 1)
+			usage();
+		start=searchClock();
+		if(buildPositionIndex(argv[optind], argv[optind+1], threads,
+			(size_t)megabytes << 20, &stats) == -1)
+		{
+			fprintf(stderr, "othello-index: can't index %s into %s\n", argv[optind], argv[optind+1]);
+			return 1;
+		}
+		printf("%llu games, %llu skipped, %llu positions, %llu different, %d runs, %.2f s\n",
+			(unsigned long long)stats.games, (unsigned long long)stats.skipped,
+			(unsigned long long)stats.positions, (unsigned long long)stats.entries,
+			stats.runs, searchClock()-start);
+		return 0;
+	}
+
+	if(argc-optind < 1 || argc-optind > 2)
+		usage();
+	if(index.open(argv[optind]) == -1)
+	{
+		fprintf(stderr, "othello-index: %s is not an index\n", argv[optind]);
+		return 1;
+	}
+	if(readPosition((optind+1 < argc) ? argv[optind+1] : "", &pos) == -1)
+	{
+		fprintf(stderr, "othello-index: bad position or illegal move\n");
+		return 1;
+	}
+
+	return showPosition(index, pos, list);
+}
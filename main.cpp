@@ -18,6 +18,9 @@
 #include <qapplication.h>
 
 #include "othello.h"
+#include "search.h"
+#include "solvedcache.h"
+#include "trace.h"
 
 
 /**
@@ -27,11 +30,22 @@
 int main(int argc, char *argv[])
 {
   QApplication a( argc, argv );
+  traceThreadName( "GUI" );
+
+  // endgame solves from earlier sessions, new ones are appended to its log
+  TSolvedCache solved;
+  solved.open(DEFAULT_SOLVED);
+  setSolvedCache(&solved);
+
   Othello *othello = new Othello();
   a.setMainWidget(othello);
   othello->show();
   othello->setMaximumSize(othello->size());
   othello->setMinimumSize(othello->size());
 
-  return a.exec();
+  int retval = a.exec();
+  // writes a file only when built with OTHELLO_TRACE
+  traceDump( DEFAULT_TRACE );
+  setSolvedCache(NULL);
+  return retval;
 }
@@ -0,0 +1,523 @@
+/** @file matchmain.cpp
+ *  othello-match, plays two computer players against each other to see
+ *  which is stronger. Games run in parallel from a set of balanced
+ *  openings, each opening twice with colours swapped. Reports the Elo
+ *  difference with its 95% confidence interval and stops early once a
+ *  sequential probability ratio test decides between elo0 and elo1.
+ *
+ *  usage: othello-match [options]
+ *    -a player     first player (default depth=6)
+ *    -b player     second player (default depth=6)
+ *    -g games      most games to play (default 1000)
+ *    -j threads    parallel games (default: number of processors)
+ *    -o file       openings, one per line, moves like "f5d6c3"
+ *                  (default: the most balanced positions after -p plies)
+ *    -p plies      plies of generated openings (default 6)
+ *    -e elo0,elo1  SPRT hypotheses (default 0,5)
+ *    -s alpha      SPRT error rates, alpha and beta alike (default 0.05)
+ *
+ *  A player is "depth=n" or "time=seconds" for the bitboard search, or
+ *  "classic" for findMove(). ",weights=file" makes the search evaluate
+ *  with weights read by loadWeights().
+ *
+ *  Built with OTHELLO_TRACE, the games are traced to othello-trace.json.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include "ai.h"
+#include "position.h"
+#include "search.h"
+#include "rules.h"
+#include "trace.h"
+#include "workpool.h"
+
+/// Longest game, with passes
+#define MAX_GAME 120
+/// Depth that rates the generated openings
+#define OPENING_DEPTH 6
+/// Seconds between progress lines
+#define REPORT_INTERVAL 5
+
+/// Kinds of player
+#define PLAYER_SEARCH 0
+#define PLAYER_CLASSIC 1
+
+/**
+* @short A computer player.
+* @param std::string name, as given on the command line.
+* @param int kind, PLAYER_SEARCH or PLAYER_CLASSIC.
+* @param int depth, search depth, 0 if limited by time.
+* @param double seconds, time for each move if depth is 0.
+* @param bool weighted, true if weights are used.
+* @param TEvalWeights weights, evaluation of the search.
+*/
+typedef struct{
+	std::string name;
+	int kind;
+	int depth;
+	double seconds;
+	bool weighted;
+	TEvalWeights weights;
+	} TPlayer;
+
+/**
+* @short An opening, moves from the starting position.
+*/
+typedef std::vector<int> TOpening;
+
+/**
+* @short The match, shared by the game threads.
+* @param const TPlayer *players, the two players.
+* @param const std::vector<TOpening> *openings, openings played in turn.
+* @param int games, most games.
+* @param int wins, int draws, int losses, results of the first player.
+* @param int decided, 1 or -1 when the test has accepted H1 or H0.
+* @param double elo0, double elo1, double alpha, test settings.
+* @param double reported, time of the last progress line.
+* @param pthread_mutex_t lock, guards the counts.
+*/
+typedef struct{
+	const TPlayer *players;
+	const std::vector<TOpening> *openings;
+	int games;
+	int wins;
+	int draws;
+	int losses;
+	int decided;
+	double elo0;
+	double elo1;
+	double alpha;
+	double reported;
+	pthread_mutex_t lock;
+	} TMatch;
+
+static void usage()
+{
+	fprintf(stderr, "usage: othello-match [-a player] [-b player] [-g games] [-j threads]\n"
+		"                     [-o openings] [-p plies] [-e elo0,elo1] [-s alpha]\n");
+	exit(1);
+}
+
+/**
+* Reads a player description.
+* @return Returns 0, or -1 if it is not understood.
+*/
+static int parsePlayer(const char *text, TPlayer *player)
+{
+	std::string spec(text), item;
+	size_t start=0, end;
+
+	player->name=spec;
+	player->kind=PLAYER_SEARCH;
+	player->depth=6;
+	player->seconds=0;
+	player->weighted=false;
+
+	while(start <= spec.size())
+	{
+		end=spec.find(',', start);
+		if(end == std::string::npos)
+			end=spec.size();
+		item=spec.substr(start, end-start);
+		start=end+1;
+
+		if(item == "classic")
+			player->kind=PLAYER_CLASSIC;
+		else if(item.compare(0, 6, "depth=") == 0)
+		{
+			player->depth=atoi(item.c_str()+6);
+			if(player->depth < 1)
+				return -1;
+		} else if(item.compare(0, 5, "time=") == 0) {
+			player->seconds=atof(item.c_str()+5);
+			player->depth=0;
+			if(player->seconds <= 0)
+				return -1;
+		} else if(item.compare(0, 8, "weights=") == 0) {
+			if(loadWeights(item.c_str()+8, &player->weights) == -1)
+				return -1;
+			player->weighted=true;
+		} else
+			return -1;
+	}
+
+	return 0;
+}
+
+/**
+* Reads openings, one game per line.
+* @return Returns the number of openings, -1 if the file can't be read
+* or has an illegal move.
+*/
+static int readOpenings(const char *path, std::vector<TOpening> &openings)
+{
+	char line[4*MAX_GAME];
+	TOpening opening;
+	TRules start;
+	TPosition pos;
+	char *c;
+	int square;
+	FILE *file;
+
+	file=fopen(path, "r");
+	if(file == NULL)
+		return -1;
+
+	while(fgets(line, sizeof(line), file) != NULL)
+	{
+		opening.clear();
+		pos=positionFromRules(start, BLACK);
+		for(c=line; c[0] != 0 && c[1] != 0; )
+		{
+			square=parseSquare(c);
+			if(square == -1)
+			{
+				c++;
+				continue;
+			}
+			if(square == PASS_MOVE ? legalMoves(pos) != 0 : !((legalMoves(pos) >> square) & 1))
+			{
+				fclose(file);
+				return -1;
+			}
+			pos=playMove(pos, square);
+			opening.push_back(square);
+			c+=2;
+		}
+		if(!opening.empty())
+			openings.push_back(opening);
+	}
+
+	fclose(file);
+	return openings.size();
+}
+
+/**
+* Lists every position plies moves from the start, once per symmetry.
+*/
+static void listOpenings(TPosition pos, TOpening &moves, int plies,
+	std::map<TPosition, TOpening, TPositionLess> &found)
+{
+	uint64_t legal=legalMoves(pos);
+	int square;
+
+	if((int)moves.size() == plies)
+	{
+		found.insert(std::make_pair(canonicalPosition(pos, NULL), moves));
+		return;
+	}
+
+	while(legal)
+	{
+		square=__builtin_ctzll(legal);
+		legal&=legal-1;
+		moves.push_back(square);
+		listOpenings(playMove(pos, square), moves, plies, found);
+		moves.pop_back();
+	}
+}
+
+/**
+* Picks the count most balanced positions after plies moves.
+*/
+static void makeOpenings(int plies, int count, std::vector<TOpening> &openings)
+{
+	std::map<TPosition, TOpening, TPositionLess> found;
+	std::map<TPosition, TOpening, TPositionLess>::iterator it;
+	std::vector<std::pair<int, int> > rated;
+	std::vector<TOpening> all;
+	TOpening moves;
+	TRules start;
+	int i;
+
+	listOpenings(positionFromRules(start, BLACK), moves, plies, found);
+
+	for(it=found.begin(); it!=found.end(); ++it)
+	{
+		rated.push_back(std::make_pair(abs(searchPosition(it->first, OPENING_DEPTH, 0, NULL, NULL)),
+			(int)all.size()));
+		all.push_back(it->second);
+	}
+	/// Ties are broken by position, so the set is the same every time.
+	std::sort(rated.begin(), rated.end());
+
+	for(i=0; i<count && i<(int)rated.size(); i++)
+		openings.push_back(all[rated[i].second]);
+}
+
+/**
+* Chooses a move.
+* @param const TPlayer *player, the player.
+* @param TPosition pos, the position, which has legal moves.
+* @param TRules &board, the same position for findMove().
+* @param unsigned int colour, the colour to move.
+* @return Returns the square.
+*/
+static int chooseMove(const TPlayer *player, TPosition pos, TRules &board, unsigned int colour)
+{
+	TSearchLimits limits;
+	TCoord place;
+	int move;
+
+	if(player->kind == PLAYER_CLASSIC)
+	{
+		place=findMove(board, colour);
+		return place.x+place.y*BOARDSIZE;
+	}
+
+	limits.depth=player->depth;
+	limits.seconds=player->seconds;
+	limits.weights=player->weighted ? &player->weights : NULL;
+	limits.stop=NULL;
+	searchLimited(pos, &limits, &move, NULL, NULL, NULL);
+	return move;
+}
+
+/**
+* Plays one game.
+* @param const TPlayer *black, const TPlayer *white, the players.
+* @param const TOpening &opening, the first moves.
+* @return Returns black's disc difference.
+*/
+static int playGame(const TPlayer *black, const TPlayer *white, const TOpening &opening)
+{
+	TRules board;
+	TPosition pos=positionFromRules(board, BLACK);
+	unsigned int colour=BLACK;
+	TCoord place;
+	unsigned int i;
+	int move, score;
+
+	for(i=0; ; i++)
+	{
+		if(legalMoves(pos) == 0)
+		{
+			if(legalMoves(playMove(pos, PASS_MOVE)) == 0)
+				break;
+			move=PASS_MOVE;
+		} else if(i < opening.size())
+			move=opening[i];
+		else
+			move=chooseMove((colour == BLACK) ? black : white, pos, board, colour);
+
+		if(move != PASS_MOVE)
+		{
+			place.x=move % BOARDSIZE;
+			place.y=move / BOARDSIZE;
+			board.rulesSetStone(place, colour);
+		}
+		pos=playMove(pos, move);
+		colour=(colour == BLACK) ? WHITE : BLACK;
+	}
+
+	score=finalScore(pos)/SCORE_DISC;
+	return (colour == BLACK) ? score : -score;
+}
+
+/**
+* Elo difference of a score share, infinite for a share of 0 or 1.
+*/
+static double eloDifference(double share)
+{
+	if(share <= 0)
+		return -HUGE_VAL;
+	if(share >= 1)
+		return HUGE_VAL;
+	return -400*log10(1/share-1);
+}
+
+/**
+* Expected score share of an Elo difference.
+*/
+static double expectedShare(double elo)
+{
+	return 1/(1+pow(10, -elo/400));
+}
+
+/**
+* Score share of the first player and its variance per game. The variance
+* counts one more drawn game, otherwise it is 0 while every game ends the
+* same and the test can't tell a sweep from chance.
+*/
+static void matchShare(const TMatch *match, double *share, double *variance)
+{
+	int games=match->wins+match->draws+match->losses;
+	double prior=(match->wins+0.5*(match->draws+1))/(games+1);
+
+	*share=(match->wins+0.5*match->draws)/games;
+	*variance=(match->wins*(1-prior)*(1-prior) + (match->draws+1)*(0.5-prior)*(0.5-prior) +
+		match->losses*prior*prior)/(games+1);
+}
+
+/**
+* Log likelihood ratio of elo1 against elo0, by the normal approximation.
+*/
+static double likelihoodRatio(const TMatch *match)
+{
+	int games=match->wins+match->draws+match->losses;
+	double share, variance, s0, s1;
+
+	if(games == 0)
+		return 0;
+	matchShare(match, &share, &variance);
+
+	s0=expectedShare(match->elo0);
+	s1=expectedShare(match->elo1);
+	return games*(s1-s0)*(2*share-s0-s1)/(2*variance);
+}
+
+/**
+* Writes the standing of the match. The Elo interval is unbounded on the
+* side where the share could be 0 or 1.
+*/
+static void report(const TMatch *match)
+{
+	int games=match->wins+match->draws+match->losses;
+	double share, variance, margin;
+	double lower=log(match->alpha/(1-match->alpha));
+
+	if(games == 0)
+		return;
+	matchShare(match, &share, &variance);
+	margin=1.96*sqrt(variance/games);
+
+	printf("%d games: +%d =%d -%d, score %.1f%%, elo %+.1f (%+.1f, %+.1f), llr %.2f (%.2f, %.2f)\n",
+		games, match->wins, match->draws, match->losses, 100*share, eloDifference(share),
+		eloDifference(share-margin), eloDifference(share+margin),
+		likelihoodRatio(match), lower, -lower);
+	fflush(stdout);
+}
+
+/**
+* Plays one game and adds its result, unless the test is decided.
+*/
+static void gameJob(int game, void *data)
+{
+	TMatch *match=(TMatch *)data;
+	const TOpening *opening;
+	double llr, bound=log((1-match->alpha)/match->alpha);
+	int score, decided;
+
+	pthread_mutex_lock(&match->lock);
+	decided=match->decided;
+	pthread_mutex_unlock(&match->lock);
+	if(decided)
+		return;
+
+	traceThreadName("game");
+	/// Both games of an opening are next to each other, colours swapped.
+	opening=&(*match->openings)[(game/2) % match->openings->size()];
+	if(game % 2 == 0)
+		score=playGame(&match->players[0], &match->players[1], *opening);
+	else
+		score=-playGame(&match->players[1], &match->players[0], *opening);
+
+	pthread_mutex_lock(&match->lock);
+	if(score > 0)
+		match->wins++;
+	else if(score < 0)
+		match->losses++;
+	else
+		match->draws++;
+
+	llr=likelihoodRatio(match);
+	if(!match->decided && llr >= bound)
+		match->decided=1;
+	else if(!match->decided && llr <= -bound)
+		match->decided=-1;
+
+	if(searchClock()-match->reported >= REPORT_INTERVAL)
+	{
+		report(match);
+		match->reported=searchClock();
+	}
+	pthread_mutex_unlock(&match->lock);
+}
+
+int main(int argc, char *argv[])
+{
+	TPlayer players[2];
+	std::vector<TOpening> openings;
+	const char *openingFile=NULL;
+	const char *first="depth=6", *second="depth=6";
+	int threads=sysconf(_SC_NPROCESSORS_ONLN), plies=6;
+	TMatch match;
+	int opt;
+
+	memset(&match, 0, sizeof(match));
+	match.games=1000;
+	match.elo0=0;
+	match.elo1=5;
+	match.alpha=0.05;
+
+	while((opt=getopt(argc, argv, "a:b:g:j:o:p:e:s:")) != -1)
+	{
+		switch (opt)
+		{
+			case 'a' : first=optarg; break;
+			case 'b' : second=optarg; break;
+			case 'g' : match.games=atoi(optarg); break;
+			case 'j' : threads=atoi(optarg); break;
+			case 'o' : openingFile=optarg; break;
+			case 'p' : plies=atoi(optarg); break;
+			case 'e' :
+				if(sscanf(optarg, "%lf,%lf", &match.elo0, &match.elo1) != 2)
+					usage();
+				break;
+			case 's' : match.alpha=atof(optarg); break;
+			default : usage();
+		}
+	}
+	if(optind != argc || match.games < 1 || plies < 0 ||
+		match.alpha <= 0 || match.alpha >= 0.5 || match.elo1 <= match.elo0)
+		usage();
+
+	if(parsePlayer(first, &players[0]) == -1 || parsePlayer(second, &players[1]) == -1)
+	{
+		fprintf(stderr, "othello-match: bad player, or weights can't be read\n");
+		return 1;
+	}
+
+	/// Every opening is played with both colours.
+	match.games+=match.games % 2;
+	if(openingFile != NULL)
+	{
+		if(readOpenings(openingFile, openings) <= 0)
+		{
+			fprintf(stderr, "othello-match: can't read openings from %s\n", openingFile);
+			return 1;
+		}
+	} else
+		makeOpenings(plies, match.games/2, openings);
+
+	printf("%s vs %s, %d games from %u openings\n", players[0].name.c_str(),
+		players[1].name.c_str(), match.games, (unsigned int)openings.size());
+	fflush(stdout);
+
+	match.players=players;
+	match.openings=&openings;
+	match.reported=searchClock();
+	pthread_mutex_init(&match.lock, NULL);
+	runJobs(gameJob, &match, match.games, threads);
+	pthread_mutex_destroy(&match.lock);
+	traceDump(DEFAULT_TRACE);
+
+	report(&match);
+	if(match.decided > 0)
+		printf("SPRT: H1 accepted, %s is at least %+g Elo\n", players[0].name.c_str(), match.elo1);
+	else if(match.decided < 0)
+		printf("SPRT: H0 accepted, %s is not %+g Elo stronger\n", players[0].name.c_str(), match.elo1);
+	else
+		printf("SPRT: no decision\n");
+
+	return 0;
+}
@@ -22,12 +22,16 @@
 #include <qpixmap.h>
 #include <qlayout.h>
 #include <qvbox.h>
+#include <qdockwindow.h>
 #include <qmessagebox.h>
+#include <qfiledialog.h>
 
 #include "othello.h"
+#include "atlas.h"
 #include "animpiece.h"
 #include "piece.h"
 #include "boardview.h"
+#include "explorerpanel.h"
 #include "gamerules.h"
 #include "rules.h"
 
@@ -46,16 +50,12 @@ Othello::Othello(const char *name) : QMainWindow(0L , name)
     // Create and setup canvas and view
     Canvas = new QCanvas( this, "Canvas" );
     Canvas->setBackgroundColor( Qt::black );
-    Canvas->setBackgroundPixmap( QPixmap(  DEFAULT_BG ) );
-    Canvas->setAdvancePeriod( 10 );
+    Canvas->setBackgroundPixmap( atlasPixmap( ATLAS_BOARD ) );
     Canvas->resize( 450, 450 );
     OthelloBoard = new BoardView( Canvas, this, "OthelloBoard");
 
     // setup list of gamepiece frames
-    QValueList<QPixmap> list;
-    list.append(QPixmap(  DEFAULT_BLANK ));
-    list.append(QPixmap(  DEFAULT_BLACK ));
-    list.append(QPixmap(  DEFAULT_WHITE ));
+    QValueList<QPixmap> list = atlasPixmaps( ATLAS_BLANK, 3 );
 
     // create pixmaparray of gamepiece frames
     pieces = new QCanvasPixmapArray (list);
@@ -64,42 +64,23 @@ Othello::Othello(const char *name) : QMainWindow(0L , name)
     for (int i=0; i<COLUMNS*ROWS; i++) {
       piecelist.append( new Piece(pieces,Canvas) );
       piecelist.last()->setPosition( i );
-      piecelist.last()->setFrame( BLANK );
-      piecelist.last()->show();
+      piecelist.last()->showColor( BLANK );
     }
 
     // setup list of animpiece animation frames
     // white-to-black
-    QValueList<QPixmap> wtblist;
-    wtblist.append(QPixmap(  DEFAULT_WTB_1 ));
-    wtblist.append(QPixmap(  DEFAULT_WTB_2 ));
-    wtblist.append(QPixmap(  DEFAULT_WTB_3 ));
-    wtblist.append(QPixmap(  DEFAULT_WTB_4 ));
-    wtblist.append(QPixmap(  DEFAULT_WTB_5 ));
-    wtblist.append(QPixmap(  DEFAULT_WTB_6 ));
-    wtblist.append(QPixmap(  DEFAULT_WTB_7 ));
+    QValueList<QPixmap> wtblist = atlasPixmaps( ATLAS_WTB, FRAMES );
     // black-to-white
-    QValueList<QPixmap> btwlist;
-    btwlist.append(QPixmap(  DEFAULT_BTW_1 ));
-    btwlist.append(QPixmap(  DEFAULT_BTW_2 ));
-    btwlist.append(QPixmap(  DEFAULT_BTW_3 ));
-    btwlist.append(QPixmap(  DEFAULT_BTW_4 ));
-    btwlist.append(QPixmap(  DEFAULT_BTW_5 ));
-    btwlist.append(QPixmap(  DEFAULT_BTW_6 ));
-    btwlist.append(QPixmap(  DEFAULT_BTW_7 ));
+    QValueList<QPixmap> btwlist = atlasPixmaps( ATLAS_BTW, FRAMES );
 
     // create pixmaparrays of animpiece frames
     wtbpieces = new QCanvasPixmapArray(wtblist); 
     btwpieces = new QCanvasPixmapArray(btwlist);
 
-    // create animpiece lists
-    for (int i=0; i<COLUMNS*ROWS; i++) {
-      wtbpiecelist.append( new AnimPiece(wtbpieces,Canvas,WTB) );
-      wtbpiecelist.last()->setPosition( i );
-      btwpiecelist.append( new AnimPiece(btwpieces,Canvas,BTW) );
-      btwpiecelist.last()->setPosition( i );
-    }
+    // animpieces get made when the flips need them
+    OthelloBoard->setAnimFrames( btwpieces, wtbpieces );
 
+    OthelloBoard->findSprites();
     OthelloBoard->clearBoard();
   
     // FILE menu
@@ -111,6 +92,10 @@ Othello::Othello(const char *name) : QMainWindow(0L , name)
     filemenu->insertItem( "&Weird Two Player Game", OthelloBoard, SLOT( newWeirdTwoGame() ) );
     filemenu->insertSeparator();
     filemenu->insertItem( "&View Demo Game", OthelloBoard, SLOT( newDemoGame() ) );
+    filemenu->insertItem( "View T&urbo Demo", OthelloBoard, SLOT( newTurboDemo() ) );
+    filemenu->insertSeparator();
+    filemenu->insertItem( "&Save Game...", this, SLOT( saveGame() ) );
+    filemenu->insertItem( "&Load Game...", this, SLOT( loadGame() ) );
 /*
     filemenu->insertSeparator();
     filemenu->insertItem( "&Host Network Game" );
@@ -119,6 +104,14 @@ Othello::Othello(const char *name) : QMainWindow(0L , name)
     filemenu->insertSeparator();
     filemenu->insertItem( "&Quit", qApp, SLOT( quit() ) );
 
+    // MOVES menu
+    QPopupMenu * movesmenu = new QPopupMenu( this, "MovesPopupMenu" );
+    movesmenu->insertItem( "&Undo", OthelloBoard, SLOT( undoMove() ), Qt::CTRL+Qt::Key_Z );
+    movesmenu->insertItem( "&Redo", OthelloBoard, SLOT( redoMove() ), Qt::CTRL+Qt::Key_Y );
+    movesmenu->insertSeparator();
+    movesmenu->insertItem( "To &Start", OthelloBoard, SLOT( firstMove() ), Qt::CTRL+Qt::Key_Home );
+    movesmenu->insertItem( "To &End", OthelloBoard, SLOT( lastMove() ), Qt::CTRL+Qt::Key_End );
+
     // OPTIONS menu
     optionsmenu = new QPopupMenu;
     anim_id = optionsmenu->insertItem( "&Animated flips", this, SLOT( toggleAnim() ) );
@@ -132,6 +125,11 @@ Othello::Othello(const char *name) : QMainWindow(0L , name)
     animenu->insertSeparator();
     animSpeeds.append( animenu->insertItem( "&Random", this, SLOT(setAnimSpeedR()) )  );
     optionsmenu->insertItem( "&Animation speed", animenu );
+    optionsmenu->insertSeparator();
+    analysis_id = optionsmenu->insertItem( "Analyse &moves", this, SLOT( toggleAnalysis() ) );
+    optionsmenu->setItemChecked(analysis_id, FALSE);
+    explorer_id = optionsmenu->insertItem( "Opening &explorer", this, SLOT( toggleExplorer() ) );
+    optionsmenu->setItemChecked(explorer_id, FALSE);
 
     setAnimSpeed3();
         
@@ -142,6 +140,7 @@ Othello::Othello(const char *name) : QMainWindow(0L , name)
     // insert items into menu
     QMenuBar * menu = menuBar();
     menu->insertItem( "&Game", filemenu );
+    menu->insertItem( "&Moves", movesmenu );
     // menu->insertSeparator();
     menu->insertItem( "&Options", optionsmenu );
     menu->insertSeparator();
@@ -155,10 +154,18 @@ Othello::Othello(const char *name) : QMainWindow(0L , name)
 
                  
     setCentralWidget( OthelloBoard );
+
+    // opening explorer, docked next to the board when switched on
+    explorerDock = new QDockWindow( this, "ExplorerDock" );
+    explorerDock->setResizeEnabled( TRUE );
+    explorer = new ExplorerPanel( explorerDock, "Explorer" );
+    explorerDock->setWidget( explorer );
+    addDockWindow( explorerDock, Qt::DockRight );
+    explorerDock->hide();
 }
 
 /**
-* Clears the piecelists and then proceeds to delete all pointers.
+* Clears the piecelist and then proceeds to delete all pointers.
 */
 Othello::~Othello()
 {
@@ -166,21 +173,14 @@ Othello::~Othello()
           delete piecelist.last();
           piecelist.pop_back();
     }
-    while (!wtbpiecelist.isEmpty()) {
-          delete wtbpiecelist.last();
-          wtbpiecelist.pop_back();
-    }
-    while (!btwpiecelist.isEmpty()) {
-          delete btwpiecelist.last();
-          btwpiecelist.pop_back();
-    }
+    // the board takes its animpieces along, before their frames go
+    delete OthelloBoard;
 
     delete animenu;
     delete optionsmenu;
     delete wtbpieces;
     delete btwpieces;
     delete pieces;
-    delete OthelloBoard;
     delete Canvas;
 }
 
@@ -194,6 +194,30 @@ void Othello::about()
                         "Ilmari Heikkinen (irheikki@cc.hut.fi)\nJari Visnen (jvaisan2@cc.hut.fi)");
 }
 
+/**
+* Asks for a file name and saves the game on the board there.
+*/
+void Othello::saveGame()
+{
+    QString name = QFileDialog::getSaveFileName( QString::null, "Games (*.game)", this );
+    if ( name.isEmpty() )
+        return;
+    if ( !OthelloBoard->saveGame(name) )
+        QMessageBox::warning( this, "Othello", "Could not save the game to\n" + name );
+}
+
+/**
+* Asks for a game file and replays the first game in it on the board.
+*/
+void Othello::loadGame()
+{
+    QString name = QFileDialog::getOpenFileName( QString::null, "Games (*.game)", this );
+    if ( name.isEmpty() )
+        return;
+    if ( !OthelloBoard->loadGame(name) )
+        QMessageBox::warning( this, "Othello", name + "\nis not a game file or has an illegal move." );
+}
+
 /**
 * Toggles animations on and off using BoardView's setAnimated(bool) method.
 */
@@ -204,6 +228,29 @@ void Othello::toggleAnim()
     OthelloBoard->setAnimated(s);
 }
 /**
+* Toggles the move analysis heatmap on and off using BoardView's setAnalysis(bool) method.
+*/
+void Othello::toggleAnalysis()
+{
+    bool s = !optionsmenu->isItemChecked(analysis_id);
+    optionsmenu->setItemChecked(analysis_id,s);
+    OthelloBoard->setAnalysis(s);
+}
+/**
+* Shows and hides the opening explorer panel. The board only updates it while it is shown.
+*/
+void Othello::toggleExplorer()
+{
+    bool s = !optionsmenu->isItemChecked(explorer_id);
+    optionsmenu->setItemChecked(explorer_id,s);
+    OthelloBoard->setExplorer( s ? explorer : NULL );
+    if (s) {
+        explorerDock->show();
+    } else {
+        explorerDock->hide();
+    }
+}
+/**
 * Sets BoardView's animation speed to fastest.
 */
 void Othello::setAnimSpeed1()
@@ -30,13 +30,13 @@
 #include "piece.h"
 #include "animpiece.h"
 
-#define DEFAULT_BG "pics/board.png"
-
 class QCanvas;
 class BoardView;
 class GameRules;
 class Rules;
 class QCanvasPixmapArray;
+class QDockWindow;
+class ExplorerPanel;
 
 /**
 * @short Othello program main window.
@@ -78,7 +78,7 @@ class Othello : public QMainWindow
 /**
 * Othello program main window destructor.
 *
-* Clears the piecelists and then proceeds to delete all pointers.
+* Clears the piecelist and then proceeds to delete all pointers.
 */
     ~Othello();
 
@@ -88,10 +88,26 @@ class Othello : public QMainWindow
 */
     void about();
 /**
+* Asks for a file name and saves the game on the board there.
+*/
+    void saveGame();
+/**
+* Asks for a game file and replays the first game in it on the board.
+*/
+    void loadGame();
+/**
 * Toggles animations on and off using BoardView's setAnimated(bool) method.
 */
     void toggleAnim();
 /**
+* Toggles the move analysis heatmap on and off using BoardView's setAnalysis(bool) method.
+*/
+    void toggleAnalysis();
+/**
+* Shows and hides the opening explorer panel.
+*/
+    void toggleExplorer();
+/**
 * Sets OthelloBoard's animation speed to fastest.
 */
     void setAnimSpeed1();
@@ -131,6 +147,14 @@ class Othello : public QMainWindow
 * For showing Canvas and all actual game logic processing.
 */
     BoardView* OthelloBoard;
+/**
+* Dock window holding the opening explorer.
+*/
+    QDockWindow* explorerDock;
+/**
+* Position index statistics of the board.
+*/
+    ExplorerPanel* explorer;
     QCanvasPixmapArray* pieces;
     QCanvasPixmapArray* wtbpieces;
     QCanvasPixmapArray* btwpieces;
@@ -139,14 +163,6 @@ class Othello : public QMainWindow
 */
     QValueList<Piece*> piecelist;
 /**
-* List of piece animations (white-to-black) on canvas. 64 in total on a 8x8 board.
-*/
-    QValueList<AnimPiece*> btwpiecelist;
-/**
-* List of piece animations (black-to-white) on canvas. 64 in total on a 8x8 board.
-*/
-    QValueList<AnimPiece*> wtbpiecelist;
-/**
 * List of references to Animation Speed menuitems.
 */
     QValueList<int> animSpeeds;
@@ -164,6 +180,14 @@ class Othello : public QMainWindow
 * Reference to Animated flips menuitem.
 */
     int anim_id;
+/**
+* Reference to Analysis menuitem.
+*/
+    int analysis_id;
+/**
+* Reference to Opening explorer menuitem.
+*/
+    int explorer_id;
 };
 
 #endif
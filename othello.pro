@@ -4,25 +4,58 @@
 
 TEMPLATE = app
 INCLUDEPATH += .
+LIBS += -lpthread
 
 # Input
 HEADERS += ai.h \
            aiplayer.h \
+           alloccount.h \
+           analysis.h \
+           animclock.h \
            animpiece.h \
+           atlas.h \
            board.h \
            boardview.h \
+           book.h \
+           explorerpanel.h \
+           gamerecord.h \
            gamerules.h \
+           gamestate.h \
+           heatmark.h \
            othello.h \
            piece.h \
            playerif.h \
-           rules.h
+           posindex.h \
+           position.h \
+           rules.h \
+           search.h \
+           solvedcache.h \
+           trace.h \
+           transtable.h \
+           turbodemo.h
 SOURCES += ai.cpp \
            aiplayer.cpp \
+           alloccount.cpp \
+           analysis.cpp \
+           animclock.cpp \
            animpiece.cpp \
+           atlas.cpp \
            board.cpp \
            boardview.cpp \
+           book.cpp \
+           explorerpanel.cpp \
+           gamerecord.cpp \
            gamerules.cpp \
+           gamestate.cpp \
+           heatmark.cpp \
            main.cpp \
            othello.cpp \
            piece.cpp \
-           rules.cpp
+           posindex.cpp \
+           position.cpp \
+           rules.cpp \
+           search.cpp \
+           solvedcache.cpp \
+           trace.cpp \
+           transtable.cpp \
+           turbodemo.cpp
@@ -0,0 +1,230 @@
+#include <stddef.h>
+#include <string.h>
+#include <unistd.h>
+#include <vector>
+#include "othellocore.h"
+#include "evalbatch.h"
+#include "search.h"
+#include "solvedcache.h"
+#include "position.h"
+#include "rules.h"
+
+/// Smallest structures accepted, those of the first version
+#define LIMITS_SIZE_1 (offsetof(TOthelloLimits, seconds)+sizeof(double))
+#define RESULT_SIZE_1 (offsetof(TOthelloResult, pv)+OTHELLO_MAX_PV)
+
+static TSolvedCache *cache=NULL;
+
+static TPosition corePosition(const TOthelloPosition *pos)
+{
+	TPosition p;
+
+	p.own=pos->own;
+	p.enemy=pos->enemy;
+	return p;
+}
+
+/**
+* Tells whether the limits make sense.
+*/
+static bool validLimits(const TOthelloLimits *limits)
+{
+	switch(limits->mode)
+	{
+		case OTHELLO_STATIC : case OTHELLO_SOLVE : return true;
+		case OTHELLO_DEPTH : return limits->depth > 0;
+		case OTHELLO_TIME : return limits->seconds >= 0;
+	}
+	return false;
+}
+
+/**
+* Copies the caller's limits, as many bytes as it says they have. Fields
+* added after its version are 0.
+* @return Returns false if the size is too small or the limits not valid.
+*/
+static bool readLimits(const TOthelloLimits *limits, TOthelloLimits *own)
+{
+	if(limits->size < LIMITS_SIZE_1)
+		return false;
+	memset(own, 0, sizeof(TOthelloLimits));
+	memcpy(own, limits, (limits->size < sizeof(TOthelloLimits)) ? limits->size : sizeof(TOthelloLimits));
+	return validLimits(own);
+}
+
+/**
+* Saves a result into the caller's structure, only the fields it has room for.
+* @param const TOthelloResult *own, the full result.
+* @param TOthelloResult *result, the caller's result.
+* @param uint32_t size, size of the caller's result.
+*/
+static void writeResult(const TOthelloResult *own, TOthelloResult *result, uint32_t size)
+{
+	memcpy(result, own, (size < sizeof(TOthelloResult)) ? size : sizeof(TOthelloResult));
+	result->size=size;
+}
+
+static void evalLimits(const TOthelloLimits *limits, TEvalLimits *eval)
+{
+	static const int modes[] = { EVAL_STATIC, EVAL_DEPTH, EVAL_TIME, EVAL_SOLVE };
+
+	eval->mode=modes[limits->mode];
+	eval->depth=limits->depth;
+	eval->seconds=limits->seconds;
+}
+
+int othelloVersion(void)
+{
+	return OTHELLO_CORE_VERSION;
+}
+
+void othelloStartPosition(TOthelloPosition *pos)
+{
+	TRules start;
+	TPosition p=positionFromRules(start, BLACK);
+
+	pos->own=p.own;
+	pos->enemy=p.enemy;
+}
+
+int othelloParsePosition(const char *text, TOthelloPosition *pos)
+{
+	TPosition p;
+
+	if(text == NULL || parsePosition(text, &p) == -1)
+		return -1;
+	pos->own=p.own;
+	pos->enemy=p.enemy;
+	return 0;
+}
+
+uint64_t othelloLegalMoves(const TOthelloPosition *pos)
+{
+	return legalMoves(corePosition(pos));
+}
+
+int othelloPlayMove(const TOthelloPosition *pos, int move, TOthelloPosition *next)
+{
+	TPosition p=corePosition(pos);
+	uint64_t moves=legalMoves(p);
+
+	if(move == OTHELLO_PASS)
+	{
+		if(moves != 0)
+			return -1;
+	} else if(move < 0 || move >= SQUARES || !((moves >> move) & 1))
+		return -1;
+
+	p=playMove(p, move);
+	next->own=p.own;
+	next->enemy=p.enemy;
+	return 0;
+}
+
+int othelloGameOver(const TOthelloPosition *pos)
+{
+	TPosition p=corePosition(pos);
+
+	return legalMoves(p) == 0 && legalMoves(playMove(p, PASS_MOVE)) == 0;
+}
+
+int othelloSearch(const TOthelloPosition *pos, const TOthelloLimits *limits,
+	TOthelloResult *result)
+{
+	TSearchStats stats;
+	TEvalResult score;
+	TEvalLimits eval;
+	TOthelloLimits own;
+	TOthelloResult found;
+
+	if((pos->own & pos->enemy) != 0 || !readLimits(limits, &own) ||
+		result->size < RESULT_SIZE_1)
+		return -1;
+
+	evalLimits(&own, &eval);
+	evaluateOne(corePosition(pos), &eval, &score, &stats);
+
+	memset(&found, 0, sizeof(TOthelloResult));
+	found.score=score.score;
+	found.move=score.move;
+	found.depth=score.depth;
+	found.exact=score.exact;
+	found.selDepth=stats.selDepth;
+	found.nodes=stats.nodes;
+	found.ttProbes=stats.ttProbes;
+	found.ttHits=stats.ttHits;
+	found.seconds=stats.seconds;
+	found.pvLength=(stats.pvLength < OTHELLO_MAX_PV) ? stats.pvLength : OTHELLO_MAX_PV;
+	memcpy(found.pv, stats.pv, found.pvLength);
+	writeResult(&found, result, result->size);
+
+	return 0;
+}
+
+int othelloSearchBatch(const TOthelloPosition *positions, TOthelloResult *results,
+	int count, const TOthelloLimits *limits, int threads)
+{
+	std::vector<TPosition> list(count > 0 ? count : 0);
+	std::vector<TEvalResult> scores(list.size());
+	TEvalLimits eval;
+	TOthelloLimits own;
+	TOthelloResult found;
+	uint32_t size;
+	int i;
+
+	if(count <= 0)
+		return 0;
+	/// The caller's results may be bigger or smaller than ours, step by its size.
+	size=results->size;
+	if(!readLimits(limits, &own) || size < RESULT_SIZE_1)
+		return -1;
+	for(i=0; i<count; i++)
+	{
+		if((positions[i].own & positions[i].enemy) != 0)
+			return -1;
+		list[i]=corePosition(&positions[i]);
+	}
+
+	if(threads <= 0)
+		threads=sysconf(_SC_NPROCESSORS_ONLN);
+	evalLimits(&own, &eval);
+	evaluateBatch(&list[0], &scores[0], count, &eval, threads);
+
+	for(i=0; i<count; i++)
+	{
+		memset(&found, 0, sizeof(TOthelloResult));
+		found.score=scores[i].score;
+		found.move=scores[i].move;
+		found.depth=scores[i].depth;
+		found.exact=scores[i].exact;
+		found.nodes=scores[i].nodes;
+		if(scores[i].move != NO_MOVE)
+		{
+			found.pv[0]=scores[i].move;
+			found.pvLength=1;
+		}
+		writeResult(&found, (TOthelloResult *)((char *)results+(size_t)i*size), size);
+	}
+
+	return 0;
+}
+
+int othelloOpenCache(const char *path)
+{
+	setSolvedCache(NULL);
+	delete cache;
+	cache=NULL;
+
+	if(path == NULL)
+		return 0;
+
+	cache=new TSolvedCache;
+	if(cache->open(path) == -1)
+	{
+		delete cache;
+		cache=NULL;
+		return -1;
+	}
+	setSolvedCache(cache);
+	return 0;
+}
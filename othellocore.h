@@ -0,0 +1,178 @@
+/** @file othellocore.h
+ *  C interface of libothello-core, the rules and search without Qt.
+ *  Meant to be called from other languages, so it uses only plain C
+ *  types of fixed size.
+ *
+ *  TOthelloLimits and TOthelloResult may grow at the end between
+ *  versions, existing fields keep their place. Their first field is the
+ *  size of the structure as the caller knows it, set to sizeof() before
+ *  the call. The library reads and writes only that many bytes, so
+ *  programs built against an older header keep working. TOthelloPosition
+ *  never changes.
+ *
+ *  Every function but othelloOpenCache() can be called from several
+ *  threads at once.
+*/
+
+#ifndef OTHELLOCORE_H
+#define OTHELLOCORE_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Interface version, raised when something is added
+#define OTHELLO_CORE_VERSION 1
+
+/// Square code used for a pass
+#define OTHELLO_PASS 64
+/// Square code used for "no move"
+#define OTHELLO_NO_MOVE 255
+/// Score of one disc of final disc difference
+#define OTHELLO_DISC 100
+/// Longest principal variation
+#define OTHELLO_MAX_PV 128
+
+/// Search modes
+#define OTHELLO_STATIC 0
+#define OTHELLO_DEPTH 1
+#define OTHELLO_TIME 2
+#define OTHELLO_SOLVE 3
+
+/**
+* @short Position seen from the side to move.
+*
+* Square index is x+y*8, x=0 is column a and y=0 is row 8.
+* @param uint64_t own, stones of the player to move.
+* @param uint64_t enemy, stones of the opponent.
+*/
+typedef struct{
+	uint64_t own;
+	uint64_t enemy;
+	} TOthelloPosition;
+
+/**
+* @short How to search.
+* @param uint32_t size, sizeof(TOthelloLimits), set by the caller.
+* @param int32_t mode, OTHELLO_STATIC, OTHELLO_DEPTH, OTHELLO_TIME or OTHELLO_SOLVE.
+* @param int32_t depth, plies for OTHELLO_DEPTH.
+* @param double seconds, time for OTHELLO_TIME.
+*/
+typedef struct{
+	uint32_t size;
+	int32_t mode;
+	int32_t depth;
+	double seconds;
+	} TOthelloLimits;
+
+/**
+* @short Search result and statistics.
+* @param uint32_t size, sizeof(TOthelloResult), set by the caller.
+* @param int32_t score, value for the player to move, OTHELLO_DISC per disc.
+* @param int32_t move, best move 0..63, OTHELLO_PASS or OTHELLO_NO_MOVE.
+* @param int32_t depth, plies searched, or empty squares if exact.
+* @param int32_t exact, 1 if score is the perfect play result.
+* @param int32_t selDepth, deepest ply visited.
+* @param int32_t pvLength, moves in pv.
+* @param uint64_t nodes, positions visited.
+* @param uint64_t ttProbes, transposition lookups.
+* @param uint64_t ttHits, lookups that found a usable result.
+* @param double seconds, time taken.
+* @param uint8_t pv, principal variation.
+*/
+typedef struct{
+	uint32_t size;
+	int32_t score;
+	int32_t move;
+	int32_t depth;
+	int32_t exact;
+	int32_t selDepth;
+	int32_t pvLength;
+	uint64_t nodes;
+	uint64_t ttProbes;
+	uint64_t ttHits;
+	double seconds;
+	uint8_t pv[OTHELLO_MAX_PV];
+	} TOthelloResult;
+
+/**
+* @return Returns OTHELLO_CORE_VERSION of the library.
+*/
+int othelloVersion(void);
+
+/**
+* Sets up the starting position, black to move.
+* @param TOthelloPosition *pos, the position is saved here.
+*/
+void othelloStartPosition(TOthelloPosition *pos);
+
+/**
+* Reads a position in text form, 64 squares from a1 to h8 row by row,
+* X for black, O for white, - for empty, then the side to move.
+* @param const char *text, the text.
+* @param TOthelloPosition *pos, the position is saved here.
+* @return Returns 0, or -1 if text is not a position.
+*/
+int othelloParsePosition(const char *text, TOthelloPosition *pos);
+
+/**
+* @return Returns a bitmask of the squares where the player to move can play.
+*/
+uint64_t othelloLegalMoves(const TOthelloPosition *pos);
+
+/**
+* Makes a move and hands the turn to the opponent.
+* @param const TOthelloPosition *pos, current position.
+* @param int move, square 0..63, or OTHELLO_PASS if there is no legal move.
+* @param TOthelloPosition *next, the position after the move, seen from
+* the opponent, is saved here. May be the same as pos.
+* @return Returns 0, or -1 if the move is illegal.
+*/
+int othelloPlayMove(const TOthelloPosition *pos, int move, TOthelloPosition *next);
+
+/**
+* @return Returns 1 if neither player can move, 0 otherwise.
+*/
+int othelloGameOver(const TOthelloPosition *pos);
+
+/**
+* Searches a position.
+* @param const TOthelloPosition *pos, the position.
+* @param const TOthelloLimits *limits, how to search.
+* @param TOthelloResult *result, the result is saved here, its size set.
+* @return Returns 0, or -1 if the position, limits or result size are
+* not valid.
+*/
+int othelloSearch(const TOthelloPosition *pos, const TOthelloLimits *limits,
+	TOthelloResult *result);
+
+/**
+* Searches many positions on a pool of threads. The results have no
+* principal variation beyond the best move.
+* @param const TOthelloPosition *positions, the positions.
+* @param TOthelloResult *results, result i is saved for position i. The
+* size of the first result is that of every result.
+* @param int count, number of positions.
+* @param const TOthelloLimits *limits, how to search.
+* @param int threads, threads to use, 0 for one per processor.
+* @return Returns 0, or -1 if a position, the limits or the result size
+* are not valid.
+*/
+int othelloSearchBatch(const TOthelloPosition *positions, TOthelloResult *results,
+	int count, const TOthelloLimits *limits, int threads);
+
+/**
+* Opens a solved position cache that every later search uses. Replaces
+* the cache opened before, do not call while searches are running.
+* @param const char *path, the cache file, NULL to close the cache.
+* @return Returns 0, or -1 if the file is not a valid cache.
+*/
+int othelloOpenCache(const char *path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OTHELLOCORE_H */
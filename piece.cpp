@@ -80,3 +80,11 @@ unsigned int Piece::getColor()
 {
   return color;
 }
+
+// QCanvas marks the square changed only if frame or visibility really change
+void Piece::showColor( unsigned int new_color )
+{
+  setColor( new_color );
+  setFrame( color );
+  setVisible( color != BLANK );
+}
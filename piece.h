@@ -23,10 +23,6 @@
 #include <qpoint.h>
 
 // othello board and piece defines
-#define DEFAULT_BLANK "pics/blank.png"
-#define DEFAULT_BLACK "pics/black.png"
-#define DEFAULT_WHITE "pics/white.png"
-
 #define BLANK 0
 #define BLACK 1
 #define WHITE 2
@@ -44,9 +40,9 @@
 * @author Ilmari Heikkinen
 *
 * The Piece-class represents a single othello board position. By default its set to transparent - 
-* BLANK - frame. It defines default piece image locations on disk DEFAULT_BLANK, DEFAULT_BLACK and
-* DEFAULT_WHITE. It also defines the corresponding frame numbers BLANK, BLACK and WHITE and the piece
-* dimensions SQUARE_W and SQUARE_H that are used for computing the pixel position of the piece on board.
+* BLANK - frame. It defines the frame numbers BLANK, BLACK and WHITE, the same order the piece
+* pictures have in the atlas, and the piece dimensions SQUARE_W and SQUARE_H that are used for
+* computing the pixel position of the piece on board.
 */
 class Piece : public QCanvasSprite
 {
@@ -85,6 +81,12 @@ public:
     * @return Returns current piece color. Possible values are BLANK, BLACK and WHITE.
     */
     unsigned int getColor();
+    /**
+    * Sets piece color and shows the matching frame. A BLANK piece is hidden,
+    * its frame is transparent and the canvas then has nothing to draw over the board there.
+    * @param new_color Color to show. Permitted values are BLANK, BLACK and WHITE.
+    */
+    void showColor( unsigned int new_color );
                                 
 protected:
     /**
@@ -51,6 +51,11 @@ class PlayerIface : virtual public QObject
     * @param QObject* Pointer to player object to disconnect.
     */
     void disconnectMe( QObject* );
+    /**
+    * Tells the game board what the player is thinking about, for showing in the statusbar.
+    * @param QString& Description of the search in progress.
+    */
+    void thinking( const QString& );
 
 };
 
@@ -0,0 +1,195 @@
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "posindex.h"
+#include "position.h"
+
+TPositionIndex::TPositionIndex() : map(NULL), mapSize(0), header(NULL), entries(NULL),
+	moves(NULL), occurrenceTable(NULL)
+{
+}
+
+/**
+* Destructor. Unmaps the file.
+*/
+TPositionIndex::~TPositionIndex()
+{
+	close();
+}
+
+/**
+* Maps an index file. Closes the previous one first.
+* @param const char *path, file name.
+* @return Returns 0 if the file was mapped, -1 if it does not exist or
+* is not a valid index.
+*/
+int TPositionIndex::open(const char *path)
+{
+	struct stat info;
+	const TIndexHeader *head;
+	uint64_t size;
+	void *data;
+	int fd;
+
+	close();
+
+	fd=::open(path, O_RDONLY);
+	if(fd == -1)
+		return -1;
+
+	if(fstat(fd, &info) == -1 || (size_t)info.st_size < sizeof(TIndexHeader))
+	{
+		::close(fd);
+		return -1;
+	}
+
+	data=mmap(NULL, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	::close(fd);
+	if(data == MAP_FAILED)
+		return -1;
+
+	head=(const TIndexHeader *)data;
+	size=sizeof(TIndexHeader)+head->entries*sizeof(TIndexEntry)+
+		head->moves*sizeof(TIndexMove)+head->occurrences*sizeof(TIndexOccurrence);
+	if(memcmp(head->magic, INDEX_MAGIC, sizeof(head->magic)) != 0 ||
+		head->version != INDEX_VERSION ||
+		head->entrySize != sizeof(TIndexEntry) ||
+		size > (uint64_t)info.st_size)
+	{
+		munmap(data, info.st_size);
+		return -1;
+	}
+
+	map=data;
+	mapSize=info.st_size;
+	header=head;
+	entries=(const TIndexEntry *)(head+1);
+	moves=(const TIndexMove *)(entries+head->entries);
+	occurrenceTable=(const TIndexOccurrence *)(moves+head->moves);
+
+	return 0;
+}
+
+/**
+* Unmaps the index file.
+*/
+void TPositionIndex::close()
+{
+	if(map != NULL)
+		munmap(map, mapSize);
+
+	map=NULL;
+	mapSize=0;
+	header=NULL;
+	entries=NULL;
+	moves=NULL;
+	occurrenceTable=NULL;
+}
+
+bool TPositionIndex::isOpen() const
+{
+	return map != NULL;
+}
+
+uint64_t TPositionIndex::games() const
+{
+	return (header != NULL) ? header->games : 0;
+}
+
+uint64_t TPositionIndex::size() const
+{
+	return (header != NULL) ? header->entries : 0;
+}
+
+/**
+* Finds an entry by hash. Hashes are spread evenly, so the search guesses
+* where the hash should be from the hashes at the ends of the range, and
+* bisects every other step in case the guesses are poor.
+*/
+static const TIndexEntry *findEntry(const TIndexEntry *table, uint64_t count, uint64_t hash)
+{
+	uint64_t low=0, high=count, middle;
+	bool guess=true;
+
+	while(low < high)
+	{
+		if(hash < table[low].hash || hash > table[high-1].hash)
+			return NULL;
+		if(guess && high-low > 2 && table[high-1].hash > table[low].hash)
+			middle=low+(uint64_t)((double)(hash-table[low].hash)/
+				(double)(table[high-1].hash-table[low].hash)*(high-1-low));
+		else
+			middle=low+(high-low)/2;
+		guess=!guess;
+
+		if(table[middle].hash == hash)
+			return &table[middle];
+		if(table[middle].hash < hash)
+			low=middle+1;
+		else
+			high=middle;
+	}
+
+	return NULL;
+}
+
+/**
+* Looks up a position.
+* @param TPosition pos, position seen from the player to move.
+* @param TIndexStats *stats, if not NULL, what the games say is saved here.
+* @return Returns the entry, NULL if no game reached the position.
+*/
+const TIndexEntry *TPositionIndex::lookup(TPosition pos, TIndexStats *stats) const
+{
+	const TIndexEntry *found;
+	unsigned int finished, count, i;
+	int sym, back;
+
+	if(header == NULL)
+		return NULL;
+
+	found=findEntry(entries, header->entries, positionHash(canonicalPosition(pos, &sym)));
+	if(found == NULL || stats == NULL)
+		return found;
+
+	stats->games=found->games;
+	stats->wins=found->wins;
+	stats->draws=found->draws;
+	stats->losses=found->losses;
+	finished=found->wins+found->draws+found->losses;
+	stats->discs=(finished > 0) ? (double)found->discs/finished : 0;
+
+	/// Moves are stored in canonical orientation, turn them back.
+	count=found->moves;
+	if(found->move > header->moves || count > header->moves-found->move || count > INDEX_MAX_MOVES)
+		count=0;
+	back=inverseSymmetry(sym);
+	for(i=0; i<count; i++)
+	{
+		stats->moves[i]=transformSquare(moves[found->move+i].move, back);
+		stats->moveGames[i]=moves[found->move+i].games;
+	}
+	stats->count=count;
+
+	return found;
+}
+
+/**
+* Returns the games that reached a position.
+* @param const TIndexEntry *entry, an entry found by lookup().
+* @param unsigned int *count, the number of occurrences is saved here.
+* @return Returns the occurrences in game file order.
+*/
+const TIndexOccurrence *TPositionIndex::occurrences(const TIndexEntry *entry, unsigned int *count) const
+{
+	*count=0;
+	if(header == NULL || entry->occurrence > header->occurrences ||
+		entry->games > header->occurrences-entry->occurrence)
+		return NULL;
+
+	*count=entry->games;
+	return occurrenceTable+entry->occurrence;
+}
@@ -0,0 +1,188 @@
+/** @file posindex.h
+ *  Position index over a game file. For every position reached in the
+ *  games it lists the games that reached it, with the ply, and keeps
+ *  how those games ended and which moves were played next. Positions
+ *  are keyed by the hash of their canonical form, so transpositions and
+ *  symmetric positions share an entry.
+ *
+ *  Like the book, the index is used straight from a read-only memory
+ *  mapping. The file is a TIndexHeader, then the entries sorted by hash,
+ *  the next moves, and the occurrences, each entry pointing at its own
+ *  run of moves and occurrences. Fields are in host byte order.
+*/
+
+#ifndef POSINDEX_H
+#define POSINDEX_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "position.h"
+
+/// Index file looked up by the opening explorer
+#define DEFAULT_INDEX "othello.index"
+
+#define INDEX_MAGIC "OTHINDX1"
+#define INDEX_VERSION 1
+
+/// Most different moves a position can have, passing included
+#define INDEX_MAX_MOVES (SQUARES+1)
+
+/**
+* @short Header at the start of an index file.
+* @param char magic[8], INDEX_MAGIC without the terminating zero.
+* @param uint32_t version, INDEX_VERSION.
+* @param uint32_t entrySize, sizeof(TIndexEntry), for sanity checks.
+* @param uint64_t entries, number of positions.
+* @param uint64_t moves, number of next move records.
+* @param uint64_t occurrences, number of occurrence records.
+* @param uint64_t games, number of games in the game file.
+*/
+typedef struct{
+	char magic[8];
+	uint32_t version;
+	uint32_t entrySize;
+	uint64_t entries;
+	uint64_t moves;
+	uint64_t occurrences;
+	uint64_t games;
+	} TIndexHeader;
+
+/**
+* @short One indexed position.
+*
+* Results are seen from the player to move and count only finished games.
+* @param uint64_t hash, positionHash() of the canonical position.
+* @param uint64_t occurrence, index of the first occurrence.
+* @param uint64_t move, index of the first next move.
+* @param int64_t discs, sum of the final disc differences.
+* @param uint32_t games, games that reached the position.
+* @param uint32_t wins, uint32_t draws, uint32_t losses, finished games.
+* @param uint32_t moves, number of different next moves.
+* @param uint32_t reserved, zero.
+*/
+typedef struct{
+	uint64_t hash;
+	uint64_t occurrence;
+	uint64_t move;
+	int64_t discs;
+	uint32_t games;
+	uint32_t wins;
+	uint32_t draws;
+	uint32_t losses;
+	uint32_t moves;
+	uint32_t reserved;
+	} TIndexEntry;
+
+/**
+* @short A move played from an indexed position, most played first.
+* @param uint32_t games, games that played it.
+* @param uint8_t move, the square in canonical orientation, or PASS_MOVE.
+*/
+typedef struct{
+	uint32_t games;
+	uint8_t move;
+	uint8_t reserved[3];
+	} TIndexMove;
+
+/**
+* @short A game that reached an indexed position, in game file order.
+* @param uint32_t game, number of the game in the game file, from 0.
+* @param uint8_t ply, moves played before the position, passes included.
+*/
+typedef struct{
+	uint32_t game;
+	uint8_t ply;
+	uint8_t reserved[3];
+	} TIndexOccurrence;
+
+/**
+* @short What the games say about a position.
+* @param unsigned int games, games that reached it.
+* @param unsigned int wins, unsigned int draws, unsigned int losses,
+* finished games, for the player to move.
+* @param double discs, average final disc difference of the finished games.
+* @param int count, number of next moves.
+* @param int moves, the next moves in the orientation of the position
+* looked up, most played first.
+* @param unsigned int moveGames, games that played each move.
+*/
+typedef struct{
+	unsigned int games;
+	unsigned int wins;
+	unsigned int draws;
+	unsigned int losses;
+	double discs;
+	int count;
+	int moves[INDEX_MAX_MOVES];
+	unsigned int moveGames[INDEX_MAX_MOVES];
+	} TIndexStats;
+
+/**
+* @short Read-only view of an index file.
+*/
+class TPositionIndex
+{
+	public:
+
+TPositionIndex();
+
+/**
+* Destructor. Unmaps the file.
+*/
+~TPositionIndex();
+
+/**
+* Maps an index file. Closes the previous one first.
+* @param const char *path, file name.
+* @return Returns 0 if the file was mapped, -1 if it does not exist or
+* is not a valid index.
+*/
+int open(const char *path);
+
+/**
+* Unmaps the index file.
+*/
+void close();
+
+/**
+* @return Returns TRUE if an index file is mapped.
+*/
+bool isOpen() const;
+
+/**
+* @return Returns the number of games in the indexed game file.
+*/
+uint64_t games() const;
+
+/**
+* @return Returns the number of positions indexed.
+*/
+uint64_t size() const;
+
+/**
+* Looks up a position.
+* @param TPosition pos, position seen from the player to move.
+* @param TIndexStats *stats, if not NULL, what the games say is saved here.
+* @return Returns the entry, NULL if no game reached the position.
+*/
+const TIndexEntry *lookup(TPosition pos, TIndexStats *stats) const;
+
+/**
+* Returns the games that reached a position.
+* @param const TIndexEntry *entry, an entry found by lookup().
+* @param unsigned int *count, the number of occurrences is saved here.
+* @return Returns the occurrences in game file order.
+*/
+const TIndexOccurrence *occurrences(const TIndexEntry *entry, unsigned int *count) const;
+
+	private:
+
+void *map;
+size_t mapSize;
+const TIndexHeader *header;
+const TIndexEntry *entries;
+const TIndexMove *moves;
+const TIndexOccurrence *occurrenceTable;
+};
+
+#endif /* POSINDEX_H */
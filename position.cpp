@@ -0,0 +1,410 @@
+#include <stdlib.h>
+#include "position.h"
+#include "rules.h"
+#include "board.h"
+
+/// Masks that keep a shifted board from wrapping around the edges.
+#define NOT_FIRST_COLUMN 0xfefefefefefefefeULL
+#define NOT_LAST_COLUMN  0x7f7f7f7f7f7f7f7fULL
+
+/**
+* Shifts every stone one step in direction dir.
+* @param uint64_t bits, the stones.
+* @param int dir, 0-up, 1-up and right, 2-right, 3-down and right,
+* 4-down, 5-left and down, 6-left, 7-left and up (like in TRules).
+* @return Returns the shifted stones.
+*/
+static inline uint64_t shiftDir(uint64_t bits, int dir)
+{
+	switch (dir)
+	{
+		case 0 : return bits << 8;
+		case 1 : return (bits << 9) & NOT_FIRST_COLUMN;
+		case 2 : return (bits << 1) & NOT_FIRST_COLUMN;
+		case 3 : return (bits >> 7) & NOT_FIRST_COLUMN;
+		case 4 : return bits >> 8;
+		case 5 : return (bits >> 9) & NOT_LAST_COLUMN;
+		case 6 : return (bits >> 1) & NOT_LAST_COLUMN;
+		default : return (bits << 7) & NOT_LAST_COLUMN;
+	}
+}
+
+/**
+* Builds a bitboard position from the board.
+* @param TRules &othello, current situation.
+* @param unsigned int player, colour of the player to move.
+* @return Returns the position seen from player.
+*/
+TPosition positionFromRules(TRules &othello, unsigned int player)
+{
+	TPosition pos;
+	unsigned int stone;
+	int x, y;
+
+	pos.own=0;
+	pos.enemy=0;
+
+	for(y=0; y<BOARDSIZE; y++)
+		for(x=0; x<BOARDSIZE; x++)
+		{
+			stone=othello.getStoneAt(x,y);
+			if(stone == player)
+				pos.own|=1ULL << (x+y*BOARDSIZE);
+			else if(stone != BLANK)
+				pos.enemy|=1ULL << (x+y*BOARDSIZE);
+		}
+
+	return pos;
+}
+
+/**
+* Returns the squares where the player to move can put a stone.
+* @param TPosition pos, current position.
+* @return Returns a bitmask of legal moves.
+*/
+uint64_t legalMoves(TPosition pos)
+{
+	uint64_t empty=~(pos.own|pos.enemy);
+	uint64_t moves=0, trail;
+	int dir, i;
+
+	/// Follow each direction from own stones over a line of opponent's stones.
+	for(dir=0; dir<8; dir++)
+	{
+		trail=shiftDir(pos.own, dir) & pos.enemy;
+		for(i=0; i<5; i++)
+			trail|=shiftDir(trail, dir) & pos.enemy;
+		moves|=shiftDir(trail, dir) & empty;
+	}
+
+	return moves;
+}
+
+/**
+* Returns the stones turned by a move.
+* @param TPosition pos, current position.
+* @param int square, square of the new stone (0..63).
+* @return Returns a bitmask of turned stones, 0 if the move is illegal.
+*/
+uint64_t flipMask(TPosition pos, int square)
+{
+	uint64_t start=1ULL << square;
+	uint64_t flips=0, line, next;
+	int dir;
+
+	if((pos.own|pos.enemy) & start)
+		return 0;
+
+	for(dir=0; dir<8; dir++)
+	{
+		line=0;
+		next=shiftDir(start, dir);
+		while(next & pos.enemy)
+		{
+			line|=next;
+			next=shiftDir(next, dir);
+		}
+		/// The line counts only if it ends in own stone.
+		if(next & pos.own)
+			flips|=line;
+	}
+
+	return flips;
+}
+
+/**
+* Makes a move and hands the turn to the opponent. Does not check legality.
+* @param TPosition pos, current position.
+* @param int square, square of the new stone (0..63) or PASS_MOVE.
+* @return Returns the position seen from the opponent.
+*/
+TPosition playMove(TPosition pos, int square)
+{
+	TPosition next;
+	uint64_t flips;
+
+	if(square == PASS_MOVE)
+	{
+		next.own=pos.enemy;
+		next.enemy=pos.own;
+		return next;
+	}
+
+	flips=flipMask(pos, square);
+	next.own=pos.enemy & ~flips;
+	next.enemy=pos.own | flips | (1ULL << square);
+
+	return next;
+}
+
+/**
+* Returns the squares next to (in any of the eight directions) some
+* square of a mask.
+* @param uint64_t bits, the mask.
+* @return Returns the neighbouring squares, may include squares of bits.
+*/
+uint64_t adjacentSquares(uint64_t bits)
+{
+	uint64_t result=0;
+	int dir;
+
+	for(dir=0; dir<8; dir++)
+		result|=shiftDir(bits, dir);
+
+	return result;
+}
+
+/**
+* Counts the stones in a bitmask.
+* @param uint64_t bits, the mask.
+* @return Returns the number of set bits.
+*/
+int countBits(uint64_t bits)
+{
+	return __builtin_popcountll(bits);
+}
+
+/**
+* Mirrors x: reverses the bits of each row.
+*/
+static uint64_t mirrorX(uint64_t b)
+{
+	b=((b >> 1) & 0x5555555555555555ULL) | ((b & 0x5555555555555555ULL) << 1);
+	b=((b >> 2) & 0x3333333333333333ULL) | ((b & 0x3333333333333333ULL) << 2);
+	b=((b >> 4) & 0x0f0f0f0f0f0f0f0fULL) | ((b & 0x0f0f0f0f0f0f0f0fULL) << 4);
+	return b;
+}
+
+/**
+* Mirrors y: reverses the order of the rows.
+*/
+static uint64_t mirrorY(uint64_t b)
+{
+	return __builtin_bswap64(b);
+}
+
+/**
+* Transposes the board: square x+y*8 goes to y+x*8.
+*/
+static uint64_t transpose(uint64_t b)
+{
+	uint64_t t;
+
+	t=0x0f0f0f0f00000000ULL & (b ^ (b << 28));
+	b^=t ^ (t >> 28);
+	t=0x3333000033330000ULL & (b ^ (b << 14));
+	b^=t ^ (t >> 14);
+	t=0x5500550055005500ULL & (b ^ (b << 7));
+	b^=t ^ (t >> 7);
+	return b;
+}
+
+/**
+* Maps a bitmask through one of the eight board symmetries.
+* Bit 2 of sym transposes the board, bit 0 then mirrors x and
+* bit 1 mirrors y.
+* @param uint64_t bits, the mask.
+* @param int sym, symmetry 0..7, 0 is identity.
+* @return Returns the transformed mask.
+*/
+uint64_t transformBits(uint64_t bits, int sym)
+{
+	if(sym & 4)
+		bits=transpose(bits);
+	if(sym & 1)
+		bits=mirrorX(bits);
+	if(sym & 2)
+		bits=mirrorY(bits);
+	return bits;
+}
+
+/**
+* Maps a square through a symmetry. PASS_MOVE and NO_MOVE map to themselves.
+* @param int square, square 0..63.
+* @param int sym, symmetry 0..7.
+* @return Returns the transformed square.
+*/
+int transformSquare(int square, int sym)
+{
+	int x, y, temp;
+
+	if(square < 0 || square >= SQUARES)
+		return square;
+
+	x=square%BOARDSIZE;
+	y=square/BOARDSIZE;
+
+	if(sym & 4)
+	{
+		temp=x;
+		x=y;
+		y=temp;
+	}
+	if(sym & 1)
+		x=BOARDSIZE-1-x;
+	if(sym & 2)
+		y=BOARDSIZE-1-y;
+
+	return x+y*BOARDSIZE;
+}
+
+/**
+* Returns the symmetry that undoes sym.
+* Reflections are their own inverse. When the board is transposed the
+* mirrors are undone before it, and transposing swaps their axes.
+* @param int sym, symmetry 0..7.
+* @return Returns the inverse symmetry.
+*/
+int inverseSymmetry(int sym)
+{
+	if(sym & 4)
+		return 4 | ((sym & 1) << 1) | ((sym & 2) >> 1);
+	return sym;
+}
+
+/**
+* Finds the canonical form of a position: the smallest of its eight
+* symmetric images. Symmetric positions share one canonical form.
+* @param TPosition pos, the position.
+* @param int *sym, if not NULL, saves the symmetry that maps pos to
+* the canonical form here.
+* @return Returns the canonical position.
+*/
+TPosition canonicalPosition(TPosition pos, int *sym)
+{
+	TPosition best=pos, image;
+	int k, bestSym=0;
+
+	for(k=1; k<SYMMETRIES; k++)
+	{
+		image.own=transformBits(pos.own, k);
+		image.enemy=transformBits(pos.enemy, k);
+		if(comparePositions(image, best) < 0)
+		{
+			best=image;
+			bestSym=k;
+		}
+	}
+
+	if(sym != NULL)
+		*sym=bestSym;
+
+	return best;
+}
+
+/**
+* Orders positions by (own, enemy). Used for sorted position files.
+* @return Returns <0, 0 or >0 like strcmp.
+*/
+int comparePositions(TPosition a, TPosition b)
+{
+	if(a.own != b.own)
+		return (a.own < b.own) ? -1 : 1;
+	if(a.enemy != b.enemy)
+		return (a.enemy < b.enemy) ? -1 : 1;
+	return 0;
+}
+
+/**
+* Mixes a position into a 64-bit hash key.
+* @param TPosition pos, the position.
+* @return Returns the hash.
+*/
+uint64_t positionHash(TPosition pos)
+{
+	uint64_t h=pos.own * 0x9e3779b97f4a7c15ULL;
+
+	h^=(pos.enemy + 0x632be59bd9b4e019ULL) * 0xbf58476d1ce4e5b9ULL;
+	h^=h >> 31;
+	h*=0x94d049bb133111ebULL;
+	h^=h >> 29;
+	return h;
+}
+
+/**
+* Writes a square in the usual othello notation, "a1".."h8". Column a is
+* x=0. Our starting position is the usual one upside down, so row 1 is
+* y=7.
+* @param int square, square 0..63, or PASS_MOVE which is written "pa".
+* @param char *name, at least three characters of space.
+*/
+void squareName(int square, char *name)
+{
+	if(square < 0 || square >= SQUARES)
+	{
+		name[0]='p';
+		name[1]='a';
+	} else {
+		name[0]='a'+square%BOARDSIZE;
+		name[1]='8'-square/BOARDSIZE;
+	}
+	name[2]=0;
+}
+
+/**
+* Reads a square written by squareName(). Accepts upper case too.
+* @param const char *name, the text, at least two characters are read.
+* @return Returns the square 0..63, PASS_MOVE, or -1 if name is not a square.
+*/
+int parseSquare(const char *name)
+{
+	char column=name[0], row=name[1];
+
+	if(column >= 'A' && column <= 'Z')
+		column+='a'-'A';
+	if(row >= 'A' && row <= 'Z')
+		row+='a'-'A';
+
+	if(column == 'p' && row == 'a')
+		return PASS_MOVE;
+	if(column < 'a' || column > 'h' || row < '1' || row > '8')
+		return -1;
+
+	return (column-'a')+('8'-row)*BOARDSIZE;
+}
+
+/**
+* Reads a position in the usual text form: 64 squares from a1 to h1,
+* then a2 and so on up to h8, X or * for black, O for white, - or . for
+* empty, then optional blanks and the side to move, X or O.
+* @param const char *text, the text.
+* @param TPosition *pos, the position seen from the side to move is saved here.
+* @return Returns the number of characters read, -1 if text is not a position.
+*/
+int parsePosition(const char *text, TPosition *pos)
+{
+	uint64_t black=0, white=0, bit;
+	int i, square;
+
+	/// Text runs from row 1, which is y=7 on our board.
+	for(i=0; i<SQUARES; i++)
+	{
+		square=(i % BOARDSIZE)+(BOARDSIZE-1-i/BOARDSIZE)*BOARDSIZE;
+		bit=1ULL << square;
+		switch(text[i])
+		{
+			case 'X' : case 'x' : case '*' : black|=bit; break;
+			case 'O' : case 'o' : white|=bit; break;
+			case '-' : case '.' : break;
+			default : return -1;
+		}
+	}
+
+	while(text[i] == ' ' || text[i] == '\t')
+		i++;
+
+	switch(text[i])
+	{
+		case 'X' : case 'x' : case '*' :
+			pos->own=black;
+			pos->enemy=white;
+			break;
+		case 'O' : case 'o' :
+			pos->own=white;
+			pos->enemy=black;
+			break;
+		default : return -1;
+	}
+
+	return i+1;
+}
@@ -0,0 +1,167 @@
+/** @file position.h
+ *  Compact bitboard form of an othello position. Used for hashing,
+ *  symmetry canonicalization and the on-disk position formats.
+*/
+
+#ifndef POSITION_H
+#define POSITION_H
+
+#include <stdint.h>
+#include "rules.h"
+
+/// Number of squares on the board
+#define SQUARES 64
+/// Number of board symmetries (rotations and reflections)
+#define SYMMETRIES 8
+/// Square code used for a pass
+#define PASS_MOVE 64
+/// Square code used for "no move"
+#define NO_MOVE 255
+
+/**
+* @short Bitboard position seen from the side to move.
+*
+* Square index is x+y*8, the same as the GUI-format positions used by
+* GameRules. Bit n of own is set if the player to move has a stone on
+* square n, likewise for enemy. The colour of the side to move is not
+* stored, a position is the same for both colours.
+* @param uint64_t own, stones of the player to move.
+* @param uint64_t enemy, stones of the opponent.
+*/
+typedef struct{
+	uint64_t own;
+	uint64_t enemy;
+	} TPosition;
+
+/**
+* Builds a bitboard position from the board.
+* @param TRules &othello, current situation.
+* @param unsigned int player, colour of the player to move.
+* @return Returns the position seen from player.
+*/
+TPosition positionFromRules(TRules &othello, unsigned int player);
+
+/**
+* Returns the squares where the player to move can put a stone.
+* @param TPosition pos, current position.
+* @return Returns a bitmask of legal moves.
+*/
+uint64_t legalMoves(TPosition pos);
+
+/**
+* Returns the stones turned by a move.
+* @param TPosition pos, current position.
+* @param int square, square of the new stone (0..63).
+* @return Returns a bitmask of turned stones, 0 if the move is illegal.
+*/
+uint64_t flipMask(TPosition pos, int square);
+
+/**
+* Makes a move and hands the turn to the opponent. Does not check legality.
+* @param TPosition pos, current position.
+* @param int square, square of the new stone (0..63) or PASS_MOVE.
+* @return Returns the position seen from the opponent.
+*/
+TPosition playMove(TPosition pos, int square);
+
+/**
+* Returns the squares next to (in any of the eight directions) some
+* square of a mask.
+* @param uint64_t bits, the mask.
+* @return Returns the neighbouring squares, may include squares of bits.
+*/
+uint64_t adjacentSquares(uint64_t bits);
+
+/**
+* Counts the stones in a bitmask.
+* @param uint64_t bits, the mask.
+* @return Returns the number of set bits.
+*/
+int countBits(uint64_t bits);
+
+/**
+* Maps a bitmask through one of the eight board symmetries.
+* Bit 2 of sym transposes the board, bit 0 then mirrors x and
+* bit 1 mirrors y.
+* @param uint64_t bits, the mask.
+* @param int sym, symmetry 0..7, 0 is identity.
+* @return Returns the transformed mask.
+*/
+uint64_t transformBits(uint64_t bits, int sym);
+
+/**
+* Maps a square through a symmetry. PASS_MOVE and NO_MOVE map to themselves.
+* @param int square, square 0..63.
+* @param int sym, symmetry 0..7.
+* @return Returns the transformed square.
+*/
+int transformSquare(int square, int sym);
+
+/**
+* Returns the symmetry that undoes sym.
+* @param int sym, symmetry 0..7.
+* @return Returns the inverse symmetry.
+*/
+int inverseSymmetry(int sym);
+
+/**
+* Finds the canonical form of a position: the smallest of its eight
+* symmetric images. Symmetric positions share one canonical form.
+* @param TPosition pos, the position.
+* @param int *sym, if not NULL, saves the symmetry that maps pos to
+* the canonical form here.
+* @return Returns the canonical position.
+*/
+TPosition canonicalPosition(TPosition pos, int *sym);
+
+/**
+* Orders positions by (own, enemy). Used for sorted position files.
+* @return Returns <0, 0 or >0 like strcmp.
+*/
+int comparePositions(TPosition a, TPosition b);
+
+/**
+* Orders positions for std::map.
+*/
+struct TPositionLess
+{
+	bool operator()(const TPosition &a, const TPosition &b) const
+	{
+		return comparePositions(a, b) < 0;
+	}
+};
+
+/**
+* Mixes a position into a 64-bit hash key.
+* @param TPosition pos, the position.
+* @return Returns the hash.
+*/
+uint64_t positionHash(TPosition pos);
+
+/**
+* Writes a square in the usual othello notation, "a1".."h8". Column a is
+* x=0. Our starting position is the usual one upside down, so row 1 is
+* y=7.
+* @param int square, square 0..63, or PASS_MOVE which is written "pa".
+* @param char *name, at least three characters of space.
+*/
+void squareName(int square, char *name);
+
+/**
+* Reads a square written by squareName(). Accepts upper case too.
+* @param const char *name, the text, at least two characters are read.
+* @return Returns the square 0..63, PASS_MOVE, or -1 if name is not a square.
+*/
+int parseSquare(const char *name);
+
+/**
+* Reads a position in the usual text form: 64 squares from a1 to h1,
+* then a2 and so on up to h8, X or * for black, O for white, - or . for
+* empty, then optional blanks and the side to move, X or O.
+* @param const char *text, the text.
+* @param TPosition *pos, the position seen from the side to move is saved here.
+* @return Returns the number of characters read, -1 if text is not a position.
+*/
+int parsePosition(const char *text, TPosition *pos);
+
+#endif /* POSITION_H */
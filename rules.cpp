@@ -5,12 +5,12 @@
 /**
 * Constructor. Calls for the boards init.
 */
-TRules::TRules() : TBoard(), weird(FALSE)
+TRules::TRules() : TBoard(), weird(FALSE), flips(0)
 {
  init();
 }
 
-TRules::TRules(bool weird) : TBoard(), weird(weird)
+TRules::TRules(bool weird) : TBoard(), weird(weird), flips(0)
 {
  init();
 }
@@ -34,6 +34,7 @@ int TRules::rulesSetStone(TCoord location, unsigned int newStone)
 		return -1;
 
 	/// Checks that the location is legal and turns the stones.
+	flips=0;
 	if(turnStones(location, newStone) == -1)
 		return -1;
 
@@ -95,6 +96,16 @@ int TRules::movePossible(unsigned int next)
   return -1;
 }
 
+/**
+* Returns the stones flipped by the last successful rulesSetStone(). The
+* bit x+y*8 is set for the stone at (x,y), the new stone is not included.
+* @return Returns the flipped stones.
+*/
+uint64_t TRules::lastFlips()
+{
+	return flips;
+}
+
 /**
 * Checks the board and counts the number of white stones
 * @return Returns score.
@@ -182,7 +193,10 @@ int TRules::flipDir(TCoord location,int dir, unsigned int newStone, int flip)
   if (nextStone != newStone && nextStone != BLANK) {
     /// Flips the stones
     flipDir(next, dir, newStone, flip);
-    if (flip == 1) flipStone(next);
+    if (flip == 1) {
+      flipStone(next);
+      flips |= 1ULL << (next.x+next.y*BOARDSIZE);
+    }
     return 0;
   } else {
     return -1;
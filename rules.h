@@ -9,6 +9,7 @@
 #define TRUE 1
 #define FALSE 0
 
+#include <stdint.h>
 #include "board.h"
 
 /**
@@ -57,6 +58,13 @@ int turnStones(TCoord location, unsigned int newStone);
 */
 int movePossible(unsigned int next);
 
+/**
+* Returns the stones flipped by the last successful rulesSetStone(). The
+* bit x+y*8 is set for the stone at (x,y), the new stone is not included.
+* @return Returns the flipped stones.
+*/
+uint64_t lastFlips();
+
 
 /**
 * Checks the board and counts the number of white stones
@@ -106,6 +114,11 @@ TCoord getNextLocation(TCoord location, int dir);
 */
 bool weird;
 
+/**
+* Stones flipped by the last move, see lastFlips().
+*/
+uint64_t flips;
+
 };
 
 #endif /* RULES_H */
@@ -0,0 +1,974 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "search.h"
+#include "position.h"
+#include "solvedcache.h"
+#include "transtable.h"
+#include "trace.h"
+
+/// Most legal moves a position can have (one per empty square)
+#define MAX_MOVES 64
+/// Remaining depth from which moves are ordered by opponent's mobility
+#define SORT_DEPTH 3
+/// Nodes between looks at the clock
+#define CLOCK_NODES 4096
+/// Endgame positions with fewer empty squares are not worth a table lookup
+#define TABLE_MIN_EMPTIES 7
+
+/// Results from earlier searches and sessions, may be NULL
+static TSolvedCache *solvedCache=NULL;
+
+/**
+* Evaluation used when no weights are given. Square values: corners are
+* best, squares next to corners give them away.
+*/
+static const TEvalWeights defaultWeights = { {
+	100, -20, 10,  5,  5, 10, -20, 100,
+	-20, -50, -2, -2, -2, -2, -50, -20,
+	 10,  -2,  1,  1,  1,  1,  -2,  10,
+	  5,  -2,  1,  0,  0,  1,  -2,   5,
+	  5,  -2,  1,  0,  0,  1,  -2,   5,
+	 10,  -2,  1,  1,  1,  1,  -2,  10,
+	-20, -50, -2, -2, -2, -2, -50, -20,
+	100, -20, 10,  5,  5, 10, -20, 100
+	}, 10, 5 };
+
+/// Square values for move ordering, whatever the evaluation
+static const int *squareValue=defaultWeights.square;
+
+/// Corners and the squares next to them
+#define CORNERS 0x8100000000000081ULL
+static const int cornerSquare[4] = { 0, 7, 56, 63 };
+static const uint64_t cornerNeighbours[4] = {
+	0x0000000000000302ULL, 0x000000000000c040ULL,
+	0x0203000000000000ULL, 0x40c0000000000000ULL };
+
+/**
+* Sums square values over a set of stones. Squares next to an occupied
+* corner are worth nothing, the corner is already decided.
+*/
+static int squareSum(const int *values, uint64_t stones, uint64_t occupied)
+{
+	int sum=0, sq, k;
+	uint64_t ignore=0;
+
+	for(k=0; k<4; k++)
+		if(occupied & (1ULL << cornerSquare[k]))
+			ignore|=cornerNeighbours[k];
+
+	stones&=~ignore;
+	while(stones)
+	{
+		sq=__builtin_ctzll(stones);
+		sum+=values[sq];
+		stones&=stones-1;
+	}
+
+	return sum;
+}
+
+/**
+* Statically evaluates a position: square values, mobility and
+* frontier stones. Does not look at the moves.
+* @param TPosition pos, the position.
+* @return Returns the value for the player to move.
+*/
+int evaluatePosition(TPosition pos)
+{
+	return evaluateWeighted(pos, &defaultWeights);
+}
+
+/**
+* Statically evaluates a position like evaluatePosition(), with other
+* weights.
+* @param TPosition pos, the position.
+* @param const TEvalWeights *weights, the weights.
+* @return Returns the value for the player to move.
+*/
+int evaluateWeighted(TPosition pos, const TEvalWeights *weights)
+{
+	TPosition other;
+	uint64_t occupied=pos.own|pos.enemy;
+	uint64_t frontier=adjacentSquares(~occupied);
+	int score;
+
+	other.own=pos.enemy;
+	other.enemy=pos.own;
+
+	score=squareSum(weights->square, pos.own, occupied)-squareSum(weights->square, pos.enemy, occupied);
+
+	/// Own moves are good, opponent's moves bad.
+	score+=weights->mobility*(countBits(legalMoves(pos))-countBits(legalMoves(other)));
+
+	/// Stones next to empty squares give the opponent moves.
+	score-=weights->frontier*(countBits(pos.own & frontier)-countBits(pos.enemy & frontier));
+
+	return score;
+}
+
+/**
+* Reads evaluation weights from a text file: the 64 square values row
+* by row, then the mobility and the frontier weight. Text from # to the
+* end of a line is ignored.
+* @param const char *path, the file.
+* @param TEvalWeights *weights, the weights are saved here.
+* @return Returns 0, or -1 if the file can't be read or is too short.
+*/
+int loadWeights(const char *path, TEvalWeights *weights)
+{
+	int values[SQUARES+2];
+	int count=0, c;
+	FILE *file;
+
+	file=fopen(path, "r");
+	if(file == NULL)
+		return -1;
+
+	while(count < SQUARES+2)
+	{
+		c=fgetc(file);
+		if(c == EOF)
+			break;
+		if(c == '#')
+		{
+			while(c != EOF && c != '\n')
+				c=fgetc(file);
+			continue;
+		}
+		if(c == '-' || (c >= '0' && c <= '9'))
+		{
+			ungetc(c, file);
+			if(fscanf(file, "%d", &values[count]) != 1)
+				break;
+			count++;
+		}
+	}
+	fclose(file);
+
+	if(count < SQUARES+2)
+		return -1;
+
+	memcpy(weights->square, values, sizeof(weights->square));
+	weights->mobility=values[SQUARES];
+	weights->frontier=values[SQUARES+1];
+	return 0;
+}
+
+/**
+* Final score of a finished game, empty squares go to the winner.
+* @param TPosition pos, the position.
+* @return Returns the disc difference times SCORE_DISC for the player to move.
+*/
+int finalScore(TPosition pos)
+{
+	int own=countBits(pos.own);
+	int enemy=countBits(pos.enemy);
+	int empty=SQUARES-own-enemy;
+
+	if(own > enemy)
+		own+=empty;
+	else if(enemy > own)
+		enemy+=empty;
+
+	return (own-enemy)*SCORE_DISC;
+}
+
+/**
+* Lists the moves in a mask, best looking first.
+* @param TPosition pos, current position.
+* @param uint64_t moves, moves to list.
+* @param int depth, remaining depth. Deep nodes pay for a mobility sort.
+* @param int *list, saves the moves here.
+* @return Returns the number of moves.
+*/
+static int orderMoves(TPosition pos, uint64_t moves, int depth, int *list)
+{
+	int keys[MAX_MOVES];
+	int count=0, sq, key, i;
+	TPosition next;
+
+	while(moves)
+	{
+		sq=__builtin_ctzll(moves);
+		moves&=moves-1;
+
+		key=squareValue[sq];
+		if(depth >= SORT_DEPTH)
+		{
+			/// Fewer replies for the opponent first.
+			next=playMove(pos, sq);
+			key-=20*countBits(legalMoves(next));
+		}
+
+		/// Insertion sort, the lists are short.
+		for(i=count; i>0 && keys[i-1] < key; i--)
+		{
+			keys[i]=keys[i-1];
+			list[i]=list[i-1];
+		}
+		keys[i]=key;
+		list[i]=sq;
+		count++;
+	}
+
+	return count;
+}
+
+/**
+* @short State of one search, handed down the tree.
+* @param TSearchStats *stats, counts of this search.
+* @param uint8_t pv, triangular table of principal variations, row ply
+* holds the best line from ply on.
+* @param int pvLength, end of the line in each row.
+* @param TSearchProgress progress, progress callback or NULL.
+* @param void *data, handed to progress.
+* @param double start, time the search started.
+* @param double reported, time of the last progress report.
+* @param TTransTable *table, transposition table or NULL.
+* @param double deadline, time to give up at, 0 for never.
+* @param const TEvalWeights *weights, evaluation of the leaves.
+* @param const int *stop, set by another thread to stop the search, or NULL.
+* Only read with __atomic_load_n().
+* @param int stopped, set when the deadline has passed or stop was set,
+* the search then unwinds and its result means nothing.
+*/
+typedef struct{
+	TSearchStats *stats;
+	uint8_t pv[MAX_PLY][MAX_PLY];
+	int pvLength[MAX_PLY];
+	TSearchProgress progress;
+	void *data;
+	double start;
+	double reported;
+	TTransTable *table;
+	double deadline;
+	const TEvalWeights *weights;
+	const int *stop;
+	int stopped;
+	} TSearch;
+
+/**
+* Returns the time in seconds, as used for search deadlines.
+*/
+double searchClock()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec+ts.tv_nsec/1e9;
+}
+
+/**
+* Starts a search.
+*/
+static void startSearch(TSearch *search, TSearchStats *stats,
+	TSearchProgress progress, void *data)
+{
+	memset(stats, 0, sizeof(TSearchStats));
+	search->stats=stats;
+	search->pvLength[0]=0;
+	search->progress=progress;
+	search->data=data;
+	search->start=searchClock();
+	search->reported=search->start;
+	search->table=NULL;
+	search->deadline=0;
+	search->weights=&defaultWeights;
+	search->stop=NULL;
+	search->stopped=0;
+}
+
+/**
+* Counts a node and reports progress if it is time to.
+*/
+static inline void visitNode(TSearch *search, int ply)
+{
+	TSearchStats *stats=search->stats;
+	double time;
+
+	stats->nodes++;
+	stats->plyNodes[ply]++;
+	if(ply > stats->selDepth)
+		stats->selDepth=ply;
+	search->pvLength[ply]=ply;
+
+	if((search->progress != NULL || search->deadline > 0 || search->stop != NULL) &&
+		stats->nodes % CLOCK_NODES == 0)
+	{
+		if(search->stop != NULL && __atomic_load_n(search->stop, __ATOMIC_RELAXED))
+			search->stopped=1;
+		time=searchClock();
+		if(search->deadline > 0 && time >= search->deadline)
+			search->stopped=1;
+		if(search->progress != NULL && time-search->reported >= PROGRESS_INTERVAL)
+		{
+			stats->seconds=time-search->start;
+			search->reported=time;
+			search->progress(stats, search->data);
+		}
+	}
+}
+
+/**
+* Makes move followed by the child's line the best line at ply.
+*/
+static inline void updatePV(TSearch *search, int ply, int move)
+{
+	int i, length=search->pvLength[ply+1];
+
+	search->pv[ply][ply]=move;
+	for(i=ply+1; i<length; i++)
+		search->pv[ply][i]=search->pv[ply+1][i];
+	search->pvLength[ply]=(length > ply+1) ? length : ply+1;
+}
+
+/**
+* Counts a beta cutoff caused by the move at index.
+*/
+static inline void countCutoff(TSearch *search, int index)
+{
+	if(index >= CUTOFF_MOVES)
+		index=CUTOFF_MOVES-1;
+	search->stats->cutoffs[index]++;
+}
+
+/**
+* Moves the best move of an earlier search to the front of a list.
+*/
+static void moveToFront(int *list, int count, int move)
+{
+	int i;
+
+	for(i=0; i<count && list[i] != move; i++);
+	if(i == count)
+		return;
+	for(; i>0; i--)
+		list[i]=list[i-1];
+	list[0]=move;
+}
+
+/**
+* Depth limited negamax with alpha-beta pruning.
+* @return Returns the score for the player to move.
+*/
+static int alphaBeta(TSearch *search, TPosition pos, int alpha, int beta, int depth, int ply)
+{
+	int list[MAX_MOVES];
+	int count, i, score, best=-SCORE_INF, bestMove=NO_MOVE;
+	int alphaOrig=alpha, tableMove=NO_MOVE;
+	uint64_t moves=legalMoves(pos);
+	const TTransEntry *entry;
+	TPosition other;
+
+	visitNode(search, ply);
+
+	if(moves == 0)
+	{
+		other=playMove(pos, PASS_MOVE);
+		if(legalMoves(other) == 0)
+			return finalScore(pos);
+		/// Passing does not use up depth.
+		best=-alphaBeta(search, other, -beta, -alpha, depth, ply+1);
+		updatePV(search, ply, PASS_MOVE);
+		return best;
+	}
+
+	if(depth <= 0)
+		return evaluateWeighted(pos, search->weights);
+
+	if(search->table != NULL)
+	{
+		search->stats->ttProbes++;
+		entry=search->table->probe(pos);
+		if(entry != NULL)
+		{
+			if(entry->depth >= depth && (entry->bound == BOUND_EXACT ||
+				(entry->bound == BOUND_LOWER && entry->score >= beta) ||
+				(entry->bound == BOUND_UPPER && entry->score <= alpha)))
+			{
+				search->stats->ttHits++;
+				return entry->score;
+			}
+			tableMove=entry->move;
+		}
+	}
+
+	count=orderMoves(pos, moves, depth, list);
+	if(tableMove != NO_MOVE)
+		moveToFront(list, count, tableMove);
+	for(i=0; i<count; i++)
+	{
+		score=-alphaBeta(search, playMove(pos, list[i]), -beta, -alpha, depth-1, ply+1);
+		if(search->stopped)
+			return 0;
+		if(score > best)
+		{
+			best=score;
+			bestMove=list[i];
+			if(score > alpha)
+			{
+				alpha=score;
+				updatePV(search, ply, list[i]);
+				if(alpha >= beta)
+				{
+					countCutoff(search, i);
+					break;
+				}
+			}
+		}
+	}
+
+	if(search->table != NULL)
+		search->table->store(pos, best, bestMove, depth,
+			(best <= alphaOrig) ? BOUND_UPPER : (best >= beta) ? BOUND_LOWER : BOUND_EXACT);
+
+	return best;
+}
+
+/**
+* Exact endgame negamax with alpha-beta pruning. Scores are in discs.
+* @return Returns the final disc difference for the player to move.
+*/
+static int solve(TSearch *search, TPosition pos, int alpha, int beta, int ply)
+{
+	int list[MAX_MOVES];
+	int count, i, score, best=-SQUARES, bestMove=NO_MOVE;
+	int alphaOrig=alpha, tableMove=NO_MOVE;
+	int empties=SQUARES-countBits(pos.own|pos.enemy);
+	uint64_t moves=legalMoves(pos);
+	const TTransEntry *entry=NULL;
+	TSolvedRecord record;
+	TPosition other;
+
+	visitNode(search, ply);
+
+	if(moves == 0)
+	{
+		other=playMove(pos, PASS_MOVE);
+		if(legalMoves(other) == 0)
+			return finalScore(pos)/SCORE_DISC;
+		best=-solve(search, other, -beta, -alpha, ply+1);
+		updatePV(search, ply, PASS_MOVE);
+		return best;
+	}
+
+	/// Big subtrees may have been solved before.
+	if(solvedCache != NULL && empties >= SOLVED_MIN_EMPTIES)
+	{
+		search->stats->ttProbes++;
+		if(solvedCache->lookup(pos, &record) == 0 && (record.flags & SOLVED_EXACT))
+		{
+			search->stats->ttHits++;
+			return record.score/SCORE_DISC;
+		}
+	}
+
+	if(search->table != NULL && empties >= TABLE_MIN_EMPTIES)
+	{
+		search->stats->ttProbes++;
+		entry=search->table->probe(pos);
+		if(entry != NULL)
+		{
+			score=entry->score/SCORE_DISC;
+			if(entry->depth == DEPTH_SOLVED && (entry->bound == BOUND_EXACT ||
+				(entry->bound == BOUND_LOWER && score >= beta) ||
+				(entry->bound == BOUND_UPPER && score <= alpha)))
+			{
+				search->stats->ttHits++;
+				return score;
+			}
+			tableMove=entry->move;
+		}
+	}
+
+	count=orderMoves(pos, moves, (empties > 6) ? SORT_DEPTH : 0, list);
+	if(tableMove != NO_MOVE)
+		moveToFront(list, count, tableMove);
+	for(i=0; i<count; i++)
+	{
+		score=-solve(search, playMove(pos, list[i]), -beta, -alpha, ply+1);
+		if(search->stopped)
+			return 0;
+		if(score > best)
+		{
+			best=score;
+			bestMove=list[i];
+			if(score > alpha)
+			{
+				alpha=score;
+				updatePV(search, ply, list[i]);
+				if(alpha >= beta)
+				{
+					countCutoff(search, i);
+					break;
+				}
+			}
+		}
+	}
+
+	if(search->table != NULL && empties >= TABLE_MIN_EMPTIES)
+		search->table->store(pos, best*SCORE_DISC, bestMove, DEPTH_SOLVED,
+			(best <= alphaOrig) ? BOUND_UPPER : (best >= beta) ? BOUND_LOWER : BOUND_EXACT);
+
+	return best;
+}
+
+/**
+* Searches the root moves of a position.
+* @param TSearch *search, the search.
+* @param TPosition pos, the position.
+* @param int depth, plies to search, or -1 to solve exactly.
+* @param uint64_t exclude, root moves not to consider.
+* @param int *bestMove, saves the best move here if not NULL.
+* @return Returns the score for the player to move.
+*/
+static int searchRoot(TSearch *search, TPosition pos, int depth, uint64_t exclude, int *bestMove)
+{
+	int list[MAX_MOVES];
+	int count, i, score, best=-SCORE_INF, move=NO_MOVE;
+	int alpha=-SCORE_INF;
+	uint64_t moves=legalMoves(pos);
+	TPosition other;
+
+	visitNode(search, 0);
+
+	if(moves == 0)
+	{
+		other=playMove(pos, PASS_MOVE);
+		if(legalMoves(other) == 0)
+		{
+			best=finalScore(pos);
+		} else {
+			move=PASS_MOVE;
+			if(depth < 0)
+				best=-solve(search, other, -SQUARES, SQUARES, 1)*SCORE_DISC;
+			else
+				best=-alphaBeta(search, other, -SCORE_INF, SCORE_INF, depth, 1);
+			updatePV(search, 0, PASS_MOVE);
+		}
+		if(bestMove != NULL)
+			*bestMove=move;
+		return best;
+	}
+
+	count=orderMoves(pos, moves & ~exclude, SORT_DEPTH, list);
+	for(i=0; i<count; i++)
+	{
+		if(depth < 0)
+			score=-solve(search, playMove(pos, list[i]), -SQUARES, -alpha/SCORE_DISC, 1)*SCORE_DISC;
+		else
+			score=-alphaBeta(search, playMove(pos, list[i]), -SCORE_INF, -alpha, depth-1, 1);
+		if(search->stopped)
+			break;
+
+		if(score > best)
+		{
+			best=score;
+			move=list[i];
+			if(score > alpha)
+			{
+				alpha=score;
+				updatePV(search, 0, list[i]);
+			}
+		}
+	}
+
+	if(bestMove != NULL)
+		*bestMove=move;
+
+	return best;
+}
+
+/**
+* Searches the root with the solved position cache: uses a stored result
+* if it is good enough, and stores the new result if it was expensive.
+* Fills in the depth, score and principal variation of the statistics.
+* @param TSearch *search, the search.
+* @param TPosition pos, the position.
+* @param int depth, plies to search, or -1 to solve exactly.
+* @param uint64_t exclude, root moves not to consider.
+* @param int *bestMove, saves the best move here if not NULL.
+* @return Returns the score for the player to move.
+*/
+static int cachedRoot(TSearch *search, TPosition pos, int depth, uint64_t exclude, int *bestMove)
+{
+	TRACE_SCOPE("cachedRoot");
+	TSearchStats *stats=search->stats;
+	int empties=SQUARES-countBits(pos.own|pos.enemy);
+	TSolvedRecord record;
+	int score, move;
+
+	/// Results with root moves left out are not the position's value,
+	/// nor are results of other weights.
+	if(solvedCache != NULL && exclude == 0 && search->weights == &defaultWeights)
+	{
+		stats->ttProbes++;
+		if(solvedCache->lookup(pos, &record) == 0 &&
+			((record.flags & SOLVED_EXACT) || (depth >= 0 && record.depth >= depth)))
+		{
+			stats->ttHits++;
+			stats->exact=(record.flags & SOLVED_EXACT) != 0;
+			stats->depth=record.depth;
+			stats->score=record.score;
+			stats->pv[0]=record.move;
+			stats->pvLength=1;
+			if(bestMove != NULL)
+				*bestMove=record.move;
+			return record.score;
+		}
+	}
+
+	score=searchRoot(search, pos, depth, exclude, &move);
+	if(search->stopped)
+		return score;
+
+	stats->exact=(depth < 0);
+	stats->depth=(depth < 0) ? empties : depth;
+	stats->score=score;
+	stats->pvLength=search->pvLength[0];
+	memcpy(stats->pv, search->pv[0], stats->pvLength);
+
+	if(solvedCache != NULL && exclude == 0 && search->weights == &defaultWeights)
+	{
+		if(depth < 0 && empties >= SOLVED_MIN_EMPTIES)
+			solvedCache->store(pos, score, move, empties, SOLVED_EXACT);
+		else if(depth >= SOLVED_MIN_DEPTH)
+			solvedCache->store(pos, score, move, depth, 0);
+	}
+
+	if(bestMove != NULL)
+		*bestMove=move;
+	return score;
+}
+
+/**
+* Searches a position. Goes depth plies forward and evaluates the leaves,
+* or solves the game exactly if at most EXACT_EMPTIES squares are empty.
+* @param TPosition pos, the position.
+* @param int depth, plies to search.
+* @param uint64_t exclude, root moves not to consider.
+* @param int *bestMove, if not NULL, the best move (0..63), PASS_MOVE
+* or NO_MOVE (game over, or every move excluded) is saved here.
+* @param TSearchStats *stats, if not NULL, the statistics are saved here.
+* @return Returns the score for the player to move, -SCORE_INF if every
+* move was excluded.
+*/
+int searchPosition(TPosition pos, int depth, uint64_t exclude, int *bestMove,
+	TSearchStats *stats)
+{
+	TSearchStats own;
+	TSearch search;
+	int score;
+
+	if(SQUARES-countBits(pos.own|pos.enemy) <= EXACT_EMPTIES)
+		depth=-1;
+	else if(depth < 1)
+		depth=1;
+
+	startSearch(&search, (stats != NULL) ? stats : &own, NULL, NULL);
+	score=cachedRoot(&search, pos, depth, exclude, bestMove);
+	search.stats->seconds=searchClock()-search.start;
+
+	return score;
+}
+
+/**
+* Solves a position exactly.
+* @param TPosition pos, the position.
+* @param int *bestMove, if not NULL, the best move is saved here.
+* @param TSearchStats *stats, if not NULL, the statistics are saved here.
+* @return Returns the final disc difference times SCORE_DISC with perfect play.
+*/
+int solvePosition(TPosition pos, int *bestMove, TSearchStats *stats)
+{
+	TSearchStats own;
+	TSearch search;
+	int score;
+
+	startSearch(&search, (stats != NULL) ? stats : &own, NULL, NULL);
+	score=cachedRoot(&search, pos, -1, 0, bestMove);
+	search.stats->seconds=searchClock()-search.start;
+
+	return score;
+}
+
+/**
+* Searches a position with iterative deepening, one ply deeper at a
+* time up to depth, reporting progress as it goes. Endgames are solved
+* in one go.
+* @param TPosition pos, the position.
+* @param int depth, plies to search at most.
+* @param int *bestMove, if not NULL, the best move is saved here.
+* @param TSearchStats *stats, if not NULL, the statistics are saved here.
+* @param TSearchProgress progress, called with the statistics so far, may be NULL.
+* @param void *data, handed to progress.
+* @return Returns the score for the player to move.
+*/
+int thinkPosition(TPosition pos, int depth, int *bestMove, TSearchStats *stats,
+	TSearchProgress progress, void *data)
+{
+	TRACE_SCOPE("thinkPosition");
+	TSearchStats own;
+	TSearch search;
+	int score=0, move=NO_MOVE, iteration;
+
+	if(SQUARES-countBits(pos.own|pos.enemy) <= EXACT_EMPTIES)
+		depth=-1;
+	else if(depth < 1)
+		depth=1;
+
+	startSearch(&search, (stats != NULL) ? stats : &own, progress, data);
+
+	for(iteration=(depth < 0) ? -1 : 1; iteration <= depth; iteration++)
+	{
+		score=cachedRoot(&search, pos, iteration, 0, &move);
+		search.stats->seconds=searchClock()-search.start;
+		if(progress != NULL)
+		{
+			search.reported=search.start+search.stats->seconds;
+			progress(search.stats, data);
+		}
+		if(depth < 0)
+			break;
+	}
+
+	if(bestMove != NULL)
+		*bestMove=move;
+	return score;
+}
+
+/**
+* Searches a position with iterative deepening until a limit is reached.
+* The result is that of the deepest iteration that finished, an iteration
+* that would likely not finish in time is not started. The first
+* iteration is always finished, so there is a result however soon the
+* search is stopped. Endgames are solved exactly once there is time for it.
+* @param TPosition pos, the position.
+* @param const TSearchLimits *limits, when to stop.
+* @param int *bestMove, if not NULL, the best move is saved here.
+* @param TSearchStats *stats, if not NULL, the statistics are saved here.
+* @param TSearchProgress progress, called with the statistics so far, may be NULL.
+* @param void *data, handed to progress.
+* @return Returns the score for the player to move.
+*/
+int searchLimited(TPosition pos, const TSearchLimits *limits, int *bestMove,
+	TSearchStats *stats, TSearchProgress progress, void *data)
+{
+	TRACE_SCOPE("searchLimited");
+	TSearchStats own;
+	TSearch search;
+	int empties=SQUARES-countBits(pos.own|pos.enemy);
+	int score, move=NO_MOVE, iterScore, iterMove, iteration, depth=empties;
+	double begun, took;
+
+	startSearch(&search, (stats != NULL) ? stats : &own, progress, data);
+	if(limits->weights != NULL)
+		search.weights=limits->weights;
+
+	if(empties <= EXACT_EMPTIES)
+		depth=-1;
+	else if(limits->depth > 0 && limits->depth < empties)
+		depth=limits->depth;
+
+	score=cachedRoot(&search, pos, (depth < 0) ? -1 : 1, 0, &move);
+	search.stats->seconds=searchClock()-search.start;
+	if(progress != NULL)
+	{
+		search.reported=search.start+search.stats->seconds;
+		progress(search.stats, data);
+	}
+	if(limits->seconds > 0)
+		search.deadline=search.start+limits->seconds;
+	search.stop=limits->stop;
+	took=search.stats->seconds;
+
+	/// Each iteration takes a few times longer than the one before.
+	for(iteration=2; depth > 0 && iteration <= depth && !search.stats->exact; iteration++)
+	{
+		TRACE_SCOPE("searchLimited iteration");
+		begun=searchClock();
+		if(search.deadline > 0 && begun+4*took >= search.deadline)
+			break;
+		if(search.stop != NULL && __atomic_load_n(search.stop, __ATOMIC_RELAXED))
+			break;
+
+		/// An iteration to the end is a solve.
+		iterScore=cachedRoot(&search, pos, (iteration == empties) ? -1 : iteration, 0, &iterMove);
+		if(search.stopped)
+			break;
+		score=iterScore;
+		move=iterMove;
+		took=searchClock()-begun;
+
+		search.stats->seconds=searchClock()-search.start;
+		if(progress != NULL)
+		{
+			search.reported=search.start+search.stats->seconds;
+			progress(search.stats, data);
+		}
+	}
+
+	search.stats->seconds=searchClock()-search.start;
+	if(bestMove != NULL)
+		*bestMove=move;
+	return score;
+}
+
+/**
+* Searches a position with iterative deepening for a given time, see
+* searchLimited().
+* @param TPosition pos, the position.
+* @param double seconds, time to search.
+* @param int *bestMove, if not NULL, the best move is saved here.
+* @param TSearchStats *stats, if not NULL, the statistics are saved here.
+* @return Returns the score for the player to move.
+*/
+int searchTimed(TPosition pos, double seconds, int *bestMove, TSearchStats *stats)
+{
+	TSearchLimits limits;
+
+	/// No time at all still gets the first iteration.
+	limits.depth=0;
+	limits.seconds=(seconds > 0) ? seconds : 1e-6;
+	limits.weights=NULL;
+	limits.stop=NULL;
+
+	return searchLimited(pos, &limits, bestMove, stats, NULL, NULL);
+}
+
+/**
+* Searches a single root move with a full window, so that its score is
+* exact and can be compared with the other moves'. Used for scoring
+* every move of a position.
+* @param TPosition pos, the position.
+* @param int move, the move, PASS_MOVE if there are no legal moves.
+* @param int depth, plies to search, counting move, or -1 to solve exactly.
+* @param TTransTable *table, transposition table kept between calls, may be NULL.
+* @param double deadline, searchClock() time to give up at, 0 for never.
+* @param int *score, saves the score for the player to move here.
+* @param TSearchStats *stats, if not NULL, the statistics are saved here,
+* the principal variation starting with move.
+* @return Returns 0 if the search finished, -1 if it ran out of time.
+*/
+int searchMove(TPosition pos, int move, int depth, TTransTable *table, double deadline,
+	int *score, TSearchStats *stats)
+{
+	TSearchStats own;
+	TSearch search;
+	TPosition next=playMove(pos, move);
+	int value;
+
+	startSearch(&search, (stats != NULL) ? stats : &own, NULL, NULL);
+	search.table=table;
+	search.deadline=deadline;
+
+	visitNode(&search, 0);
+	if(depth < 0)
+		value=-solve(&search, next, -SQUARES, SQUARES, 1)*SCORE_DISC;
+	else
+		value=-alphaBeta(&search, next, -SCORE_INF, SCORE_INF, depth-1, 1);
+	search.stats->seconds=searchClock()-search.start;
+	if(search.stopped)
+		return -1;
+
+	updatePV(&search, 0, move);
+	search.stats->exact=(depth < 0);
+	search.stats->depth=(depth < 0) ? SQUARES-countBits(pos.own|pos.enemy) : depth;
+	search.stats->score=value;
+	search.stats->pvLength=search.pvLength[0];
+	memcpy(search.stats->pv, search.pv[0], search.stats->pvLength);
+
+	*score=value;
+	return 0;
+}
+
+/**
+* @return Returns the nodes visited per second.
+*/
+double nodesPerSecond(const TSearchStats *stats)
+{
+	if(stats->seconds <= 0)
+		return 0;
+	return stats->nodes/stats->seconds;
+}
+
+/**
+* Average number of children of the nodes at a ply.
+* @param const TSearchStats *stats, the statistics.
+* @param int ply, ply from the root.
+* @return Returns the branching factor, 0 if no nodes were visited at ply.
+*/
+double branchingFactor(const TSearchStats *stats, int ply)
+{
+	if(ply < 0 || ply+1 >= MAX_PLY || stats->plyNodes[ply] == 0)
+		return 0;
+	return (double)stats->plyNodes[ply+1]/stats->plyNodes[ply];
+}
+
+/**
+* Share of the beta cutoffs caused by the move at an index. A well
+* ordered search cuts off at the first move almost always.
+* @param const TSearchStats *stats, the statistics.
+* @param int index, move index, CUTOFF_MOVES-1 covers the later moves too.
+* @return Returns the share between 0 and 1.
+*/
+double cutoffRate(const TSearchStats *stats, int index)
+{
+	uint64_t total=0;
+	int i;
+
+	for(i=0; i<CUTOFF_MOVES; i++)
+		total+=stats->cutoffs[i];
+	if(total == 0 || index < 0 || index >= CUTOFF_MOVES)
+		return 0;
+	return (double)stats->cutoffs[index]/total;
+}
+
+/**
+* Writes a one line summary: depth, score, nodes, speed, cutoffs and
+* the principal variation.
+* @param const TSearchStats *stats, the statistics.
+* @param char *text, the line is saved here.
+* @param int size, size of text.
+*/
+void formatStats(const TSearchStats *stats, char *text, int size)
+{
+	char name[3];
+	int length, i;
+
+	if(stats->exact)
+		length=snprintf(text, size, "solved %d empties, %+d discs",
+			stats->depth, stats->score/SCORE_DISC);
+	else
+		length=snprintf(text, size, "depth %d/%d, score %+.2f",
+			stats->depth, stats->selDepth, (double)stats->score/SCORE_DISC);
+
+	length+=snprintf(text+length, (length < size) ? size-length : 0,
+		", %llu nodes, %.0f kN/s, cut@1 %.0f%%",
+		(unsigned long long)stats->nodes, nodesPerSecond(stats)/1000,
+		100*cutoffRate(stats, 0));
+	if(stats->ttProbes > 0)
+		length+=snprintf(text+length, (length < size) ? size-length : 0,
+			", tt %.0f%%", 100.0*stats->ttHits/stats->ttProbes);
+
+	if(stats->pvLength > 0)
+		length+=snprintf(text+length, (length < size) ? size-length : 0, ", pv");
+	for(i=0; i<stats->pvLength && i<8; i++)
+	{
+		squareName(stats->pv[i], name);
+		length+=snprintf(text+length, (length < size) ? size-length : 0, " %s", name);
+	}
+}
+
+/**
+* Sets the solved position cache. Searches look up their root position
+* and the bigger endgame positions there, and store exact solves and deep
+* results in it.
+* @param TSolvedCache *cache, the cache, NULL for none.
+*/
+void setSolvedCache(TSolvedCache *cache)
+{
+	solvedCache=cache;
+}
@@ -0,0 +1,263 @@
+/** @file search.h
+ *  Alpha-beta search over bitboard positions. Unlike findMove() it
+ *  returns a score, so it can be used for analysis and book building.
+ *  The functions can be called from several threads at once. The only
+ *  shared state is the optional solved position cache.
+*/
+
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include <stdint.h>
+#include "position.h"
+
+class TSolvedCache;
+class TTransTable;
+
+/// Score of one disc of final disc difference
+#define SCORE_DISC 100
+/// Bigger than any score
+#define SCORE_INF 32000
+/// Positions with this many empty squares or less are solved exactly
+#define EXACT_EMPTIES 12
+
+/// Deepest a search can go: 60 moves, and a pass before each of them
+#define MAX_PLY 128
+/// Cutoffs are counted by the index of the move causing them, the last counts the rest
+#define CUTOFF_MOVES 8
+/// Seconds between progress reports within an iteration
+#define PROGRESS_INTERVAL 0.1
+
+/**
+* @short What a search did.
+*
+* Counts are totals over every iteration of the search, depth, score
+* and the principal variation are those of the last finished iteration.
+* @param uint64_t nodes, positions visited.
+* @param double seconds, time taken so far.
+* @param int depth, plies searched, or empty squares if exact.
+* @param int exact, 1 if the position was solved exactly.
+* @param int selDepth, deepest ply visited, passes and endgame included.
+* @param int score, value for the player to move.
+* @param uint64_t ttProbes, transposition lookups.
+* @param uint64_t ttHits, lookups that found a usable result.
+* @param uint64_t cutoffs, beta cutoffs by index of the move that caused them.
+* @param uint64_t plyNodes, nodes visited at each ply from the root.
+* @param uint8_t pv, principal variation, moves or PASS_MOVE.
+* @param int pvLength, moves in pv.
+*/
+typedef struct TSearchStats{
+	uint64_t nodes;
+	double seconds;
+	int depth;
+	int exact;
+	int selDepth;
+	int score;
+	uint64_t ttProbes;
+	uint64_t ttHits;
+	uint64_t cutoffs[CUTOFF_MOVES];
+	uint64_t plyNodes[MAX_PLY];
+	uint8_t pv[MAX_PLY];
+	int pvLength;
+	} TSearchStats;
+
+/**
+* @short Weights of the static evaluation.
+* @param int square, value of a stone on each square.
+* @param int mobility, value of each move more than the opponent has.
+* @param int frontier, cost of each stone next to an empty square more
+* than the opponent has.
+*/
+typedef struct{
+	int square[SQUARES];
+	int mobility;
+	int frontier;
+	} TEvalWeights;
+
+/**
+* Called while a search runs, after each iteration and every
+* PROGRESS_INTERVAL seconds.
+* @param const TSearchStats *stats, the search so far.
+* @param void *data, the caller's pointer.
+*/
+typedef void (*TSearchProgress)(const TSearchStats *stats, void *data);
+
+/**
+* Statically evaluates a position: square values, mobility and
+* frontier stones. Does not look at the moves.
+* @param TPosition pos, the position.
+* @return Returns the value for the player to move.
+*/
+int evaluatePosition(TPosition pos);
+
+/**
+* Statically evaluates a position like evaluatePosition(), with other
+* weights.
+* @param TPosition pos, the position.
+* @param const TEvalWeights *weights, the weights.
+* @return Returns the value for the player to move.
+*/
+int evaluateWeighted(TPosition pos, const TEvalWeights *weights);
+
+/**
+* Reads evaluation weights from a text file: the 64 square values row
+* by row, then the mobility and the frontier weight. Text from # to the
+* end of a line is ignored.
+* @param const char *path, the file.
+* @param TEvalWeights *weights, the weights are saved here.
+* @return Returns 0, or -1 if the file can't be read or is too short.
+*/
+int loadWeights(const char *path, TEvalWeights *weights);
+
+/**
+* Final score of a finished game, empty squares go to the winner.
+* @param TPosition pos, the position.
+* @return Returns the disc difference times SCORE_DISC for the player to move.
+*/
+int finalScore(TPosition pos);
+
+/**
+* Searches a position. Goes depth plies forward and evaluates the leaves,
+* or solves the game exactly if at most EXACT_EMPTIES squares are empty.
+* @param TPosition pos, the position.
+* @param int depth, plies to search.
+* @param uint64_t exclude, root moves not to consider.
+* @param int *bestMove, if not NULL, the best move (0..63), PASS_MOVE
+* or NO_MOVE (game over, or every move excluded) is saved here.
+* @param TSearchStats *stats, if not NULL, the statistics are saved here.
+* @return Returns the score for the player to move, -SCORE_INF if every
+* move was excluded.
+*/
+int searchPosition(TPosition pos, int depth, uint64_t exclude, int *bestMove,
+	TSearchStats *stats);
+
+/**
+* Solves a position exactly.
+* @param TPosition pos, the position.
+* @param int *bestMove, if not NULL, the best move is saved here.
+* @param TSearchStats *stats, if not NULL, the statistics are saved here.
+* @return Returns the final disc difference times SCORE_DISC with perfect play.
+*/
+int solvePosition(TPosition pos, int *bestMove, TSearchStats *stats);
+
+/**
+* Searches a position with iterative deepening, one ply deeper at a
+* time up to depth, reporting progress as it goes. Endgames are solved
+* in one go.
+* @param TPosition pos, the position.
+* @param int depth, plies to search at most.
+* @param int *bestMove, if not NULL, the best move is saved here.
+* @param TSearchStats *stats, if not NULL, the statistics are saved here.
+* @param TSearchProgress progress, called with the statistics so far, may be NULL.
+* @param void *data, handed to progress.
+* @return Returns the score for the player to move.
+*/
+int thinkPosition(TPosition pos, int depth, int *bestMove, TSearchStats *stats,
+	TSearchProgress progress, void *data);
+
+/**
+* @short When a search should end.
+* @param int depth, deepest iteration, 0 for no limit.
+* @param double seconds, time to search, 0 for no limit.
+* @param const TEvalWeights *weights, evaluation to use, NULL for the
+* usual one. Searches with other weights do not use the solved cache.
+* @param const int *stop, if not NULL, the search stops soon after
+* another thread sets it to non-zero with __atomic_store_n().
+*/
+typedef struct{
+	int depth;
+	double seconds;
+	const TEvalWeights *weights;
+	const int *stop;
+	} TSearchLimits;
+
+/**
+* Searches a position with iterative deepening until a limit is reached.
+* The result is that of the deepest iteration that finished, an iteration
+* that would likely not finish in time is not started. The first
+* iteration is always finished, so there is a result however soon the
+* search is stopped. Endgames are solved exactly once there is time for it.
+* @param TPosition pos, the position.
+* @param const TSearchLimits *limits, when to stop.
+* @param int *bestMove, if not NULL, the best move is saved here.
+* @param TSearchStats *stats, if not NULL, the statistics are saved here.
+* @param TSearchProgress progress, called with the statistics so far, may be NULL.
+* @param void *data, handed to progress.
+* @return Returns the score for the player to move.
+*/
+int searchLimited(TPosition pos, const TSearchLimits *limits, int *bestMove,
+	TSearchStats *stats, TSearchProgress progress, void *data);
+
+/**
+* Searches a position with iterative deepening for a given time, see
+* searchLimited().
+* @param TPosition pos, the position.
+* @param double seconds, time to search.
+* @param int *bestMove, if not NULL, the best move is saved here.
+* @param TSearchStats *stats, if not NULL, the statistics are saved here.
+* @return Returns the score for the player to move.
+*/
+int searchTimed(TPosition pos, double seconds, int *bestMove, TSearchStats *stats);
+
+/**
+* Searches a single root move with a full window, so that its score is
+* exact and can be compared with the other moves'. Used for scoring
+* every move of a position.
+* @param TPosition pos, the position.
+* @param int move, the move, PASS_MOVE if there are no legal moves.
+* @param int depth, plies to search, counting move, or -1 to solve exactly.
+* @param TTransTable *table, transposition table kept between calls, may be NULL.
+* @param double deadline, searchClock() time to give up at, 0 for never.
+* @param int *score, saves the score for the player to move here.
+* @param TSearchStats *stats, if not NULL, the statistics are saved here,
+* the principal variation starting with move.
+* @return Returns 0 if the search finished, -1 if it ran out of time.
+*/
+int searchMove(TPosition pos, int move, int depth, TTransTable *table, double deadline,
+	int *score, TSearchStats *stats);
+
+/**
+* Returns the time in seconds, as used for search deadlines.
+*/
+double searchClock();
+
+/**
+* @return Returns the nodes visited per second.
+*/
+double nodesPerSecond(const TSearchStats *stats);
+
+/**
+* Average number of children of the nodes at a ply.
+* @param const TSearchStats *stats, the statistics.
+* @param int ply, ply from the root.
+* @return Returns the branching factor, 0 if no nodes were visited at ply.
+*/
+double branchingFactor(const TSearchStats *stats, int ply);
+
+/**
+* Share of the beta cutoffs caused by the move at an index. A well
+* ordered search cuts off at the first move almost always.
+* @param const TSearchStats *stats, the statistics.
+* @param int index, move index, CUTOFF_MOVES-1 covers the later moves too.
+* @return Returns the share between 0 and 1.
+*/
+double cutoffRate(const TSearchStats *stats, int index);
+
+/**
+* Writes a one line summary: depth, score, nodes, speed, cutoffs and
+* the principal variation.
+* @param const TSearchStats *stats, the statistics.
+* @param char *text, the line is saved here.
+* @param int size, size of text.
+*/
+void formatStats(const TSearchStats *stats, char *text, int size);
+
+/**
+* Sets the solved position cache. Searches look up their root position
+* and the bigger endgame positions there, and store exact solves and deep
+* results in it.
+* @param TSolvedCache *cache, the cache, NULL for none.
+*/
+void setSolvedCache(TSolvedCache *cache);
+
+#endif /* SEARCH_H */
@@ -0,0 +1,380 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <string>
+#include <vector>
+#include "solvedcache.h"
+#include "position.h"
+
+/**
+* Builds the log file name, path ".log".
+*/
+static std::string logName(const char *path)
+{
+	return std::string(path)+".log";
+}
+
+/**
+* Tells whether record a should replace record b: exact beats depth,
+* deeper beats shallower.
+*/
+bool betterRecord(const TSolvedRecord *a, const TSolvedRecord *b)
+{
+	if((a->flags & SOLVED_EXACT) != (b->flags & SOLVED_EXACT))
+		return (a->flags & SOLVED_EXACT) != 0;
+	if(a->flags & SOLVED_EXACT)
+		return false;
+	return a->depth > b->depth;
+}
+
+/**
+* qsort() comparison, by position and then best record first.
+*/
+static int compareRecords(const void *a, const void *b)
+{
+	const TSolvedRecord *ra=(const TSolvedRecord *)a;
+	const TSolvedRecord *rb=(const TSolvedRecord *)b;
+	TPosition pa, pb;
+	int order;
+
+	pa.own=ra->own;
+	pa.enemy=ra->enemy;
+	pb.own=rb->own;
+	pb.enemy=rb->enemy;
+
+	order=comparePositions(pa, pb);
+	if(order != 0)
+		return order;
+	if(betterRecord(ra, rb))
+		return -1;
+	if(betterRecord(rb, ra))
+		return 1;
+	return 0;
+}
+
+TSolvedCache::TSolvedCache() : map(NULL), mapSize(0), table(NULL), count(0), logFile(-1)
+{
+	pthread_rwlock_init(&lock, NULL);
+}
+
+/**
+* Destructor. Closes the files.
+*/
+TSolvedCache::~TSolvedCache()
+{
+	close();
+	pthread_rwlock_destroy(&lock);
+}
+
+/**
+* Maps the compacted file and reads the log. Missing files are fine,
+* they are created on the first store(). No other thread may use the
+* cache meanwhile.
+* @param const char *path, compacted file, the log is path ".log".
+* @return Returns 0 on success, -1 if a file exists but is not valid.
+*/
+int TSolvedCache::open(const char *path)
+{
+	const TSolvedHeader *header;
+	TSolvedRecord record;
+	TPosition key;
+	struct stat info;
+	void *data;
+	int fd;
+
+	close();
+
+	fd=::open(path, O_RDONLY);
+	if(fd != -1)
+	{
+		if(fstat(fd, &info) == -1 || (size_t)info.st_size < sizeof(TSolvedHeader))
+		{
+			::close(fd);
+			return -1;
+		}
+		data=mmap(NULL, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+		::close(fd);
+		if(data == MAP_FAILED)
+			return -1;
+
+		header=(const TSolvedHeader *)data;
+		if(memcmp(header->magic, SOLVED_MAGIC, sizeof(header->magic)) != 0 ||
+			header->version != SOLVED_VERSION ||
+			header->recordSize != sizeof(TSolvedRecord) ||
+			sizeof(TSolvedHeader) + (size_t)header->count*sizeof(TSolvedRecord) > (size_t)info.st_size)
+		{
+			munmap(data, info.st_size);
+			return -1;
+		}
+
+		map=data;
+		mapSize=info.st_size;
+		table=(const TSolvedRecord *)((const char *)data + sizeof(TSolvedHeader));
+		count=header->count;
+	}
+
+	/// The log is small, it is kept in memory.
+	logFile=::open(logName(path).c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+	if(logFile == -1)
+		return 0;
+
+	while(read(logFile, &record, sizeof(record)) == (ssize_t)sizeof(record))
+	{
+		key.own=record.own;
+		key.enemy=record.enemy;
+		if(find(key) == NULL || betterRecord(&record, find(key)))
+			added[key]=record;
+	}
+
+	return 0;
+}
+
+/**
+* Closes the files. No other thread may use the cache meanwhile.
+*/
+void TSolvedCache::close()
+{
+	if(map != NULL)
+		munmap(map, mapSize);
+	if(logFile != -1)
+		::close(logFile);
+
+	map=NULL;
+	mapSize=0;
+	table=NULL;
+	count=0;
+	logFile=-1;
+	added.clear();
+}
+
+unsigned int TSolvedCache::size()
+{
+	unsigned int known;
+
+	pthread_rwlock_rdlock(&lock);
+	known=count+added.size();
+	pthread_rwlock_unlock(&lock);
+	return known;
+}
+
+/**
+* Finds a canonical position in the mapped file or in the log. Call with
+* lock held while other threads may use the cache.
+*/
+const TSolvedRecord *TSolvedCache::find(TPosition key)
+{
+	const TSolvedRecord *found=findAdded(key);
+
+	/// Log records are never worse than the file's.
+	if(found != NULL)
+		return found;
+	return findMapped(key);
+}
+
+/**
+* Finds a canonical position in the records added, call with lock held.
+*/
+const TSolvedRecord *TSolvedCache::findAdded(TPosition key)
+{
+	TRecordMap::iterator it=added.find(key);
+
+	if(it != added.end())
+		return &it->second;
+	return NULL;
+}
+
+/**
+* Finds a canonical position in the mapped file, needs no lock.
+*/
+const TSolvedRecord *TSolvedCache::findMapped(TPosition key)
+{
+	unsigned int low=0, high=count, middle;
+	TPosition probe;
+	int order;
+
+	while(low < high)
+	{
+		middle=low+(high-low)/2;
+		probe.own=table[middle].own;
+		probe.enemy=table[middle].enemy;
+		order=comparePositions(probe, key);
+		if(order == 0)
+			return &table[middle];
+		if(order < 0)
+			low=middle+1;
+		else
+			high=middle;
+	}
+
+	return NULL;
+}
+
+/**
+* Finds a position.
+* @param TPosition pos, position seen from the player to move.
+* @param TSolvedRecord *record, the record is copied here, its move turned
+* to the orientation of pos.
+* @return Returns 0 if found, -1 if not.
+*/
+int TSolvedCache::lookup(TPosition pos, TSolvedRecord *record)
+{
+	const TSolvedRecord *found;
+	TPosition key;
+	int sym, retval=-1;
+
+	key=canonicalPosition(pos, &sym);
+
+	/// A map record can be replaced by store() as soon as the lock is let go.
+	pthread_rwlock_rdlock(&lock);
+	found=findAdded(key);
+	if(found != NULL)
+	{
+		*record=*found;
+		retval=0;
+	}
+	pthread_rwlock_unlock(&lock);
+
+	if(retval == -1)
+	{
+		found=findMapped(key);
+		if(found != NULL)
+		{
+			*record=*found;
+			retval=0;
+		}
+	}
+
+	if(retval == 0)
+	{
+		record->own=pos.own;
+		record->enemy=pos.enemy;
+		record->move=transformSquare(record->move, inverseSymmetry(sym));
+	}
+
+	return retval;
+}
+
+/**
+* Remembers a result and appends it to the log. Results no better than
+* the one already known are ignored.
+* @param TPosition pos, position seen from the player to move.
+* @param int score, value for the player to move.
+* @param int move, best move in the orientation of pos.
+* @param int depth, search depth, or number of empty squares if exact.
+* @param int flags, SOLVED_EXACT or 0.
+*/
+void TSolvedCache::store(TPosition pos, int score, int move, int depth, int flags)
+{
+	const TSolvedRecord *old;
+	TSolvedRecord record;
+	TPosition key;
+	int sym;
+
+	key=canonicalPosition(pos, &sym);
+
+	memset(&record, 0, sizeof(record));
+	record.own=key.own;
+	record.enemy=key.enemy;
+	record.score=score;
+	record.move=transformSquare(move, sym);
+	record.depth=depth;
+	record.flags=flags;
+
+	pthread_rwlock_wrlock(&lock);
+	old=find(key);
+	if(old == NULL || betterRecord(&record, old))
+	{
+		added[key]=record;
+		/// One write per record, appends from other processes don't mix in.
+		if(logFile != -1 && write(logFile, &record, sizeof(record)) != (ssize_t)sizeof(record))
+		{
+			::close(logFile);
+			logFile=-1;
+		}
+	}
+	pthread_rwlock_unlock(&lock);
+}
+
+/**
+* Merges the log into the compacted file and empties the log. Must not
+* run while other processes are appending to the same log.
+* @param const char *path, compacted file, the log is path ".log".
+* @return Returns 0 on success, -1 on error.
+*/
+int TSolvedCache::compact(const char *path)
+{
+	std::vector<TSolvedRecord> records;
+	std::string temp=std::string(path)+".tmp";
+	TSolvedHeader header;
+	TSolvedRecord record;
+	unsigned int i, unique=0;
+	FILE *file;
+	int retval=0;
+
+	/// Everything from both files, sorted, best record of each position first.
+	file=fopen(path, "rb");
+	if(file != NULL)
+	{
+		if(fread(&header, sizeof(header), 1, file) != 1 ||
+			memcmp(header.magic, SOLVED_MAGIC, sizeof(header.magic)) != 0 ||
+			header.recordSize != sizeof(TSolvedRecord))
+		{
+			fclose(file);
+			return -1;
+		}
+		while(fread(&record, sizeof(record), 1, file) == 1)
+			records.push_back(record);
+		fclose(file);
+	}
+
+	file=fopen(logName(path).c_str(), "rb");
+	if(file != NULL)
+	{
+		while(fread(&record, sizeof(record), 1, file) == 1)
+			records.push_back(record);
+		fclose(file);
+	}
+
+	if(!records.empty())
+		qsort(&records[0], records.size(), sizeof(TSolvedRecord), compareRecords);
+	for(i=0; i<records.size(); i++)
+	{
+		if(unique > 0 && records[unique-1].own == records[i].own &&
+			records[unique-1].enemy == records[i].enemy)
+			continue;
+		records[unique++]=records[i];
+	}
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, SOLVED_MAGIC, sizeof(header.magic));
+	header.version=SOLVED_VERSION;
+	header.count=unique;
+	header.recordSize=sizeof(TSolvedRecord);
+
+	file=fopen(temp.c_str(), "wb");
+	if(file == NULL)
+		return -1;
+	if(fwrite(&header, sizeof(header), 1, file) != 1 ||
+		(unique > 0 && fwrite(&records[0], sizeof(TSolvedRecord), unique, file) != unique))
+		retval=-1;
+	if(fclose(file) != 0)
+		retval=-1;
+
+	if(retval == 0 && rename(temp.c_str(), path) != 0)
+		retval=-1;
+	if(retval == -1)
+	{
+		remove(temp.c_str());
+		return -1;
+	}
+
+	/// Everything in the log is in the file now.
+	if(truncate(logName(path).c_str(), 0) == -1)
+		return -1;
+
+	return 0;
+}
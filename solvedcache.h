@@ -0,0 +1,169 @@
+/** @file solvedcache.h
+ *  Persistent cache of solved positions. Exact endgame results and deep
+ *  search results are appended to a log file as they are found. Offline
+ *  compaction merges the log into a sorted file, which later runs map
+ *  into memory and search directly, so results survive between sessions.
+*/
+
+#ifndef SOLVEDCACHE_H
+#define SOLVEDCACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <map>
+#include <pthread.h>
+#include "position.h"
+
+/// Cache file used by the computer players, the log is DEFAULT_SOLVED ".log"
+#define DEFAULT_SOLVED "othello.solved"
+
+#define SOLVED_MAGIC "OTHSOLV1"
+#define SOLVED_VERSION 1
+
+/// Exact solves with fewer empty squares are cheap, they are not stored
+#define SOLVED_MIN_EMPTIES 10
+/// Depth searches shallower than this are cheap, they are not stored
+#define SOLVED_MIN_DEPTH 10
+
+/// Record flags
+#define SOLVED_EXACT 1
+
+/**
+* @short Header at the start of a compacted cache file.
+*/
+typedef struct{
+	char magic[8];
+	uint32_t version;
+	uint32_t count;
+	uint32_t recordSize;
+	uint32_t reserved;
+	} TSolvedHeader;
+
+/**
+* @short One solved position.
+*
+* The position is canonical and move is in canonical orientation. The
+* same records make up the log and, sorted by comparePositions(), the
+* compacted file.
+* @param uint64_t own, stones of the player to move.
+* @param uint64_t enemy, stones of the opponent.
+* @param int16_t score, value for the player to move, in search units.
+* @param uint8_t move, best move, PASS_MOVE or NO_MOVE.
+* @param uint8_t depth, search depth, or number of empty squares if exact.
+* @param uint8_t flags, SOLVED_EXACT if score is the perfect play result.
+*/
+typedef struct{
+	uint64_t own;
+	uint64_t enemy;
+	int16_t score;
+	uint8_t move;
+	uint8_t depth;
+	uint8_t flags;
+	uint8_t reserved[3];
+	} TSolvedRecord;
+
+/**
+* @short Solved position store.
+*
+* The compacted file is mapped read-only, the log is read into memory
+* and appended to. lookup() and store() may be called from several
+* threads. The mapped file never changes while it is open, so lookups
+* search it without locking. Only the records added from the log and by
+* store() are guarded, by a reader-writer lock that lets lookups run side
+* by side.
+*/
+class TSolvedCache
+{
+	public:
+
+TSolvedCache();
+
+/**
+* Destructor. Closes the files.
+*/
+~TSolvedCache();
+
+/**
+* Maps the compacted file and reads the log. Missing files are fine,
+* they are created on the first store(). No other thread may use the
+* cache meanwhile.
+* @param const char *path, compacted file, the log is path ".log".
+* @return Returns 0 on success, -1 if a file exists but is not valid.
+*/
+int open(const char *path);
+
+/**
+* Closes the files. No other thread may use the cache meanwhile.
+*/
+void close();
+
+/**
+* Finds a position.
+* @param TPosition pos, position seen from the player to move.
+* @param TSolvedRecord *record, the record is copied here, its move turned
+* to the orientation of pos.
+* @return Returns 0 if found, -1 if not.
+*/
+int lookup(TPosition pos, TSolvedRecord *record);
+
+/**
+* Remembers a result and appends it to the log. Results no better than
+* the one already known are ignored.
+* @param TPosition pos, position seen from the player to move.
+* @param int score, value for the player to move.
+* @param int move, best move in the orientation of pos.
+* @param int depth, search depth, or number of empty squares if exact.
+* @param int flags, SOLVED_EXACT or 0.
+*/
+void store(TPosition pos, int score, int move, int depth, int flags);
+
+/**
+* @return Returns the number of positions known.
+*/
+unsigned int size();
+
+/**
+* Merges the log into the compacted file and empties the log. Must not
+* run while other processes are appending to the same log.
+* @param const char *path, compacted file, the log is path ".log".
+* @return Returns 0 on success, -1 on error.
+*/
+static int compact(const char *path);
+
+	private:
+
+typedef std::map<TPosition, TSolvedRecord, TPositionLess> TRecordMap;
+
+/**
+* Finds a canonical position in the mapped file or in the log. Call with
+* lock held while other threads may use the cache.
+*/
+const TSolvedRecord *find(TPosition key);
+
+/**
+* Finds a canonical position in the records added, call with lock held.
+*/
+const TSolvedRecord *findAdded(TPosition key);
+
+/**
+* Finds a canonical position in the mapped file, needs no lock.
+*/
+const TSolvedRecord *findMapped(TPosition key);
+
+void *map;
+size_t mapSize;
+const TSolvedRecord *table;
+unsigned int count;
+/// Guarded by lock
+TRecordMap added;
+int logFile;
+pthread_rwlock_t lock;
+};
+
+/**
+* Tells whether record a should replace record b: exact beats depth,
+* deeper beats shallower.
+*/
+bool betterRecord(const TSolvedRecord *a, const TSolvedRecord *b);
+
+#endif /* SOLVEDCACHE_H */
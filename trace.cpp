@@ -0,0 +1,161 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include "trace.h"
+
+#ifdef OTHELLO_TRACE
+
+/**
+* @short A finished trace scope.
+*/
+typedef struct{
+	const char *name;
+	uint64_t start;
+	uint64_t duration;
+	} TTraceEvent;
+
+/**
+* @short Ring buffer of one thread. Only the owning thread writes it.
+* @param TTraceEvent events, the last TRACE_EVENTS events.
+* @param uint64_t head, events recorded so far, the next one goes to
+* events[head % TRACE_EVENTS].
+* @param int thread, number of the thread in the trace.
+* @param const char *name, name of the thread, NULL if it has none.
+* @param TTraceBuffer *next, next buffer in the list of all buffers.
+*/
+typedef struct TTraceBuffer{
+	TTraceEvent events[TRACE_EVENTS];
+	volatile uint64_t head;
+	int thread;
+	const char *volatile name;
+	struct TTraceBuffer *next;
+	} TTraceBuffer;
+
+/// Buffer of the calling thread
+static __thread TTraceBuffer *threadBuffer=NULL;
+/// Every buffer made. Buffers are never freed, threads that ended are still dumped.
+static TTraceBuffer *volatile buffers=NULL;
+/// Threads seen so far
+static volatile int threads=0;
+
+/**
+* Makes the calling thread's buffer and adds it to the list.
+*/
+static TTraceBuffer *newBuffer()
+{
+	TTraceBuffer *buffer=(TTraceBuffer *)calloc(1, sizeof(TTraceBuffer));
+
+	if(buffer == NULL)
+		return NULL;
+	buffer->thread=__sync_add_and_fetch(&threads, 1);
+	do
+		buffer->next=buffers;
+	while(!__sync_bool_compare_and_swap(&buffers, buffer->next, buffer));
+
+	threadBuffer=buffer;
+	return buffer;
+}
+
+/**
+* Records an event in the calling thread's buffer.
+* @param const char *name, what happened, a string that stays valid.
+* @param uint64_t start, traceClock() at the start.
+* @param uint64_t end, traceClock() at the end.
+*/
+void traceEvent(const char *name, uint64_t start, uint64_t end)
+{
+	TTraceBuffer *buffer=threadBuffer;
+	TTraceEvent *event;
+
+	if(buffer == NULL && (buffer=newBuffer()) == NULL)
+		return;
+
+	event=&buffer->events[buffer->head % TRACE_EVENTS];
+	event->name=name;
+	event->start=start;
+	event->duration=end-start;
+	/// The event is complete before the dump can see it.
+	__sync_synchronize();
+	buffer->head++;
+}
+
+/**
+* Names the calling thread in the trace.
+* @param const char *name, the name, a string that stays valid.
+*/
+void traceThreadName(const char *name)
+{
+	TTraceBuffer *buffer=threadBuffer;
+
+	if(buffer == NULL && (buffer=newBuffer()) == NULL)
+		return;
+	buffer->name=name;
+}
+
+/**
+* Writes every recorded event as Chrome trace JSON. Threads may go on
+* recording while the trace is written.
+* @param const char *path, the file.
+* @return Returns 0, or -1 if the file can't be written or tracing is
+* not built in.
+*/
+int traceDump(const char *path)
+{
+	std::vector<TTraceEvent> events;
+	TTraceBuffer *buffer;
+	uint64_t head, first, after, i;
+	bool comma=false;
+	FILE *file;
+
+	file=fopen(path, "w");
+	if(file == NULL)
+		return -1;
+
+	fprintf(file, "{\"traceEvents\": [\n");
+	for(buffer=buffers; buffer != NULL; buffer=buffer->next)
+	{
+		if(buffer->name != NULL)
+		{
+			fprintf(file, "%s{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, "
+				"\"args\": {\"name\": \"%s\"}}", comma ? ",\n" : "", buffer->thread, buffer->name);
+			comma=true;
+		}
+
+		/// Copy, then keep only what the thread can't have overwritten meanwhile.
+		head=buffer->head;
+		__sync_synchronize();
+		first=(head > TRACE_EVENTS) ? head-TRACE_EVENTS : 0;
+		events.clear();
+		for(i=first; i<head; i++)
+			events.push_back(buffer->events[i % TRACE_EVENTS]);
+		__sync_synchronize();
+		after=buffer->head;
+		if(after >= TRACE_EVENTS && after-TRACE_EVENTS+1 > first)
+			first=after-TRACE_EVENTS+1;
+
+		for(i=first; i<head; i++)
+		{
+			const TTraceEvent &event=events[i-(head-events.size())];
+			fprintf(file, "%s{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, "
+				"\"ts\": %.3f, \"dur\": %.3f}", comma ? ",\n" : "", event.name, buffer->thread,
+				event.start/1000.0, event.duration/1000.0);
+			comma=true;
+		}
+	}
+	fprintf(file, "\n]}\n");
+
+	return (fclose(file) == 0) ? 0 : -1;
+}
+
+#else
+
+void traceThreadName(const char *)
+{
+}
+
+int traceDump(const char *)
+{
+	return -1;
+}
+
+#endif /* OTHELLO_TRACE */
@@ -0,0 +1,95 @@
+/** @file trace.h
+ *  Scoped trace points for profiling. A TRACE_SCOPE() records how long
+ *  the rest of its block takes, and traceDump() writes what was recorded
+ *  as a Chrome trace (chrome://tracing or ui.perfetto.dev), one timeline
+ *  per thread.
+ *
+ *  Tracing is built in only when OTHELLO_TRACE is defined, for example
+ *  with CXXFLAGS=-DOTHELLO_TRACE. Otherwise TRACE_SCOPE() expands to
+ *  nothing and the functions do nothing. Each thread records into a ring
+ *  buffer of its own without locking, and the oldest events of a thread
+ *  are lost once it has recorded more than TRACE_EVENTS.
+*/
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include <time.h>
+
+/// Trace file written by the programs
+#define DEFAULT_TRACE "othello-trace.json"
+
+/// Events kept per thread
+#define TRACE_EVENTS 65536
+
+#ifdef OTHELLO_TRACE
+
+#define TRACE_JOIN2(a, b) a##b
+#define TRACE_JOIN(a, b) TRACE_JOIN2(a, b)
+/// Traces the rest of the enclosing block under name, a string literal.
+#define TRACE_SCOPE(name) TTraceScope TRACE_JOIN(traceScope, __LINE__)(name)
+
+/**
+* Returns the trace clock in nanoseconds.
+*/
+inline uint64_t traceClock()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec*1000000000+ts.tv_nsec;
+}
+
+/**
+* Records an event in the calling thread's buffer.
+* @param const char *name, what happened, a string that stays valid.
+* @param uint64_t start, traceClock() at the start.
+* @param uint64_t end, traceClock() at the end.
+*/
+void traceEvent(const char *name, uint64_t start, uint64_t end);
+
+/**
+* @short Records the time from its construction to its destruction.
+*/
+class TTraceScope
+{
+	public:
+
+TTraceScope(const char *name) : name(name), start(traceClock())
+{
+}
+
+~TTraceScope()
+{
+	traceEvent(name, start, traceClock());
+}
+
+	private:
+
+const char *name;
+uint64_t start;
+};
+
+#else
+
+#define TRACE_SCOPE(name)
+
+#endif /* OTHELLO_TRACE */
+
+/**
+* Names the calling thread in the trace.
+* @param const char *name, the name, a string that stays valid.
+*/
+void traceThreadName(const char *name);
+
+/**
+* Writes every recorded event as Chrome trace JSON. Threads may go on
+* recording while the trace is written.
+* @param const char *path, the file.
+* @return Returns 0, or -1 if the file can't be written or tracing is
+* not built in.
+*/
+int traceDump(const char *path);
+
+#endif /* TRACE_H */
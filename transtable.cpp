@@ -0,0 +1,70 @@
+#include <stdlib.h>
+#include <string.h>
+#include "transtable.h"
+#include "position.h"
+
+/**
+* Constructor. Allocates the table.
+* @param unsigned int bits, the table has 2^bits entries.
+*/
+TTransTable::TTransTable(unsigned int bits)
+{
+	mask=(1ULL << bits)-1;
+	entries=new TTransEntry[mask+1];
+	clear();
+}
+
+/**
+* Destructor. Frees the table.
+*/
+TTransTable::~TTransTable()
+{
+	delete[] entries;
+}
+
+/**
+* Forgets everything.
+*/
+void TTransTable::clear()
+{
+	memset(entries, 0, (mask+1)*sizeof(TTransEntry));
+}
+
+/**
+* Finds a position.
+* @param TPosition pos, the position.
+* @return Returns the entry, or NULL if the position is not in the table.
+*/
+const TTransEntry *TTransTable::probe(TPosition pos)
+{
+	const TTransEntry *entry=&entries[positionHash(pos) & mask];
+
+	if(entry->bound == 0 || entry->own != pos.own || entry->enemy != pos.enemy)
+		return NULL;
+	return entry;
+}
+
+/**
+* Saves a search result.
+* @param TPosition pos, the position.
+* @param int score, value for the player to move.
+* @param int move, best move, or NO_MOVE.
+* @param int depth, remaining depth, DEPTH_SOLVED if exact.
+* @param int bound, what score is: BOUND_UPPER, BOUND_LOWER or BOUND_EXACT.
+*/
+void TTransTable::store(TPosition pos, int score, int move, int depth, int bound)
+{
+	TTransEntry *entry=&entries[positionHash(pos) & mask];
+
+	/// Keep the deeper result of the same position.
+	if(entry->bound != 0 && entry->own == pos.own && entry->enemy == pos.enemy &&
+		entry->depth > depth)
+		return;
+
+	entry->own=pos.own;
+	entry->enemy=pos.enemy;
+	entry->score=score;
+	entry->move=move;
+	entry->depth=depth;
+	entry->bound=bound;
+}
@@ -0,0 +1,88 @@
+/** @file transtable.h
+ *  Transposition table. Remembers search results by position so that
+ *  positions reached by different move orders are searched once, and
+ *  deeper iterations try the best move of the previous one first.
+*/
+
+#ifndef TRANSTABLE_H
+#define TRANSTABLE_H
+
+#include <stdint.h>
+#include "position.h"
+
+/// Bound types of a stored score
+#define BOUND_UPPER 1
+#define BOUND_LOWER 2
+#define BOUND_EXACT (BOUND_UPPER|BOUND_LOWER)
+
+/// Depth stored for exact endgame results, deeper than any search
+#define DEPTH_SOLVED 127
+
+/**
+* @short One transposition table slot.
+* @param uint64_t own, stones of the player to move.
+* @param uint64_t enemy, stones of the opponent.
+* @param int16_t score, value for the player to move, in search units.
+* @param uint8_t move, best move found, or NO_MOVE.
+* @param int8_t depth, remaining depth of the search, DEPTH_SOLVED if exact.
+* @param uint8_t bound, BOUND_UPPER, BOUND_LOWER or BOUND_EXACT, 0 if empty.
+*/
+typedef struct{
+	uint64_t own;
+	uint64_t enemy;
+	int16_t score;
+	uint8_t move;
+	int8_t depth;
+	uint8_t bound;
+	} TTransEntry;
+
+/**
+* @short Fixed size hash table of search results.
+*
+* One entry per slot, a new result replaces the old one unless the old
+* one is about the same position and deeper. Not thread safe.
+*/
+class TTransTable
+{
+	public:
+
+/**
+* Constructor. Allocates the table.
+* @param unsigned int bits, the table has 2^bits entries.
+*/
+TTransTable(unsigned int bits);
+
+/**
+* Destructor. Frees the table.
+*/
+~TTransTable();
+
+/**
+* Forgets everything.
+*/
+void clear();
+
+/**
+* Finds a position.
+* @param TPosition pos, the position.
+* @return Returns the entry, or NULL if the position is not in the table.
+*/
+const TTransEntry *probe(TPosition pos);
+
+/**
+* Saves a search result.
+* @param TPosition pos, the position.
+* @param int score, value for the player to move.
+* @param int move, best move, or NO_MOVE.
+* @param int depth, remaining depth, DEPTH_SOLVED if exact.
+* @param int bound, what score is: BOUND_UPPER, BOUND_LOWER or BOUND_EXACT.
+*/
+void store(TPosition pos, int score, int move, int depth, int bound);
+
+	private:
+
+TTransEntry *entries;
+uint64_t mask;
+};
+
+#endif /* TRANSTABLE_H */
@@ -0,0 +1,180 @@
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include "turbodemo.h"
+#include "search.h"
+#include "board.h"
+#include "trace.h"
+
+TTurboDemo::TTurboDemo() : started(false), stopFlag(0), depth(TURBO_DEPTH), seed(time(NULL)), played(0), begun(0)
+{
+	pthread_mutex_init(&lock, NULL);
+	memset(&latest, 0, sizeof(latest));
+	latest.turn=BLANK;
+}
+
+/**
+* Destructor. Stops the games.
+*/
+TTurboDemo::~TTurboDemo()
+{
+	stop();
+	pthread_mutex_destroy(&lock);
+}
+
+/**
+* Starts playing, from a new game.
+* @param int depth, plies to search per move.
+* @return Returns 0, or -1 if the thread can't be started.
+*/
+int TTurboDemo::start(int depth)
+{
+	stop();
+
+	this->depth=depth;
+	__atomic_store_n(&stopFlag, 0, __ATOMIC_RELAXED);
+	played=0;
+	begun=searchClock();
+	pthread_mutex_lock(&lock);
+	memset(&latest, 0, sizeof(latest));
+	latest.turn=BLANK;
+	pthread_mutex_unlock(&lock);
+
+	if(pthread_create(&thread, NULL, run, this) != 0)
+		return -1;
+	started=true;
+	return 0;
+}
+
+/**
+* Stops playing and waits for the thread to end. The last move being
+* searched is given up.
+*/
+void TTurboDemo::stop()
+{
+	if(!started)
+		return;
+	__atomic_store_n(&stopFlag, 1, __ATOMIC_RELAXED);
+	pthread_join(thread, NULL);
+	started=false;
+}
+
+/**
+* @return Returns true while the games are being played.
+*/
+bool TTurboDemo::running()
+{
+	return started;
+}
+
+/**
+* Copies the latest sample.
+* @param TTurboSample *sample, the sample is saved here.
+*/
+void TTurboDemo::sample(TTurboSample *sample)
+{
+	pthread_mutex_lock(&lock);
+	*sample=latest;
+	pthread_mutex_unlock(&lock);
+	if(started)
+		sample->seconds=searchClock()-begun;
+}
+
+/**
+* Body of the thread, plays until told to stop.
+* @param void *data, the TTurboDemo.
+*/
+void *TTurboDemo::run(void *data)
+{
+	TTurboDemo *demo=(TTurboDemo *)data;
+	int result;
+
+	traceThreadName("turbo");
+	while(!__atomic_load_n(&demo->stopFlag, __ATOMIC_RELAXED))
+	{
+		result=demo->playGame();
+		if(__atomic_load_n(&demo->stopFlag, __ATOMIC_RELAXED))
+			break;
+
+		pthread_mutex_lock(&demo->lock);
+		demo->latest.games++;
+		if(result > 0)
+			demo->latest.blackWins++;
+		else if(result < 0)
+			demo->latest.whiteWins++;
+		pthread_mutex_unlock(&demo->lock);
+	}
+	return NULL;
+}
+
+/**
+* Plays one game.
+* @return Returns the final disc difference for black, meaningless if
+* stopped.
+*/
+int TTurboDemo::playGame()
+{
+	TRACE_SCOPE("TTurboDemo::playGame");
+	TRules start;
+	TSearchLimits limits;
+	TPosition pos=positionFromRules(start, BLACK);
+	unsigned int turn=BLACK;
+	uint64_t moves;
+	int ply, square, count;
+
+	limits.depth=depth;
+	limits.seconds=0;
+	limits.weights=NULL;
+	limits.stop=&stopFlag;
+
+	publish(pos, turn, false);
+	for(ply=0; !__atomic_load_n(&stopFlag, __ATOMIC_RELAXED); ply++)
+	{
+		moves=legalMoves(pos);
+		if(moves == 0)
+		{
+			/// Both sides out of moves ends the game.
+			if(legalMoves(playMove(pos, PASS_MOVE)) == 0)
+				break;
+			pos=playMove(pos, PASS_MOVE);
+			turn=(turn == BLACK) ? WHITE : BLACK;
+			continue;
+		}
+
+		if(ply < TURBO_RANDOM_PLIES)
+		{
+			/// The n:th legal move, counting from the lowest square.
+			count=rand_r(&seed) % countBits(moves);
+			while(count-- > 0)
+				moves&=moves-1;
+			square=__builtin_ctzll(moves);
+		}
+		else
+			searchLimited(pos, &limits, &square, NULL, NULL, NULL);
+
+		pos=playMove(pos, square);
+		turn=(turn == BLACK) ? WHITE : BLACK;
+		played++;
+		publish(pos, turn, false);
+	}
+
+	publish(pos, turn, true);
+	count=countBits(pos.own)-countBits(pos.enemy);
+	return (turn == BLACK) ? count : -count;
+}
+
+/**
+* Publishes a position.
+* @param TPosition pos, the position seen from colour.
+* @param unsigned int colour, BLACK or WHITE.
+* @param bool over, true if the game has ended.
+*/
+void TTurboDemo::publish(TPosition pos, unsigned int colour, bool over)
+{
+	pthread_mutex_lock(&lock);
+	latest.black=(colour == WHITE) ? pos.enemy : pos.own;
+	latest.white=(colour == WHITE) ? pos.own : pos.enemy;
+	latest.turn=over ? BLANK : colour;
+	latest.moves=played;
+	pthread_mutex_unlock(&lock);
+}
@@ -0,0 +1,120 @@
+/** @file turbodemo.h
+ *  Computer against computer as fast as the search goes, for watching
+ *  the engine play game after game. The games are played in a thread of
+ *  their own and whoever shows them samples the latest position when it
+ *  likes, missing the positions in between.
+*/
+
+#ifndef TURBODEMO_H
+#define TURBODEMO_H
+
+#include <stdint.h>
+#include <pthread.h>
+#include "position.h"
+
+/// Plies searched per move, the endgame is still solved exactly
+#define TURBO_DEPTH 4
+/// Random moves that open each game, so that the games differ
+#define TURBO_RANDOM_PLIES 6
+
+/**
+* @short What the demo is doing, as of the last move played.
+* @param uint64_t black, black stones.
+* @param uint64_t white, white stones.
+* @param unsigned int turn, BLACK or WHITE to move, BLANK at the end of a game.
+* @param unsigned int games, games finished.
+* @param unsigned int blackWins, games won by black.
+* @param unsigned int whiteWins, games won by white.
+* @param unsigned int moves, moves played in all the games, passes not counted.
+* @param double seconds, time since the demo started.
+*/
+typedef struct{
+	uint64_t black;
+	uint64_t white;
+	unsigned int turn;
+	unsigned int games;
+	unsigned int blackWins;
+	unsigned int whiteWins;
+	unsigned int moves;
+	double seconds;
+	} TTurboSample;
+
+/**
+* @short Plays computer against computer games in a thread.
+*
+* The thread publishes a TTurboSample after every move under a lock, the
+* only thing it shares. It runs until stop() or the destructor.
+*/
+class TTurboDemo
+{
+	public:
+
+TTurboDemo();
+
+/**
+* Destructor. Stops the games.
+*/
+~TTurboDemo();
+
+/**
+* Starts playing, from a new game.
+* @param int depth, plies to search per move.
+* @return Returns 0, or -1 if the thread can't be started.
+*/
+int start(int depth);
+
+/**
+* Stops playing and waits for the thread to end. The last move being
+* searched is given up.
+*/
+void stop();
+
+/**
+* @return Returns true while the games are being played.
+*/
+bool running();
+
+/**
+* Copies the latest sample.
+* @param TTurboSample *sample, the sample is saved here.
+*/
+void sample(TTurboSample *sample);
+
+	private:
+
+/**
+* Body of the thread, plays until told to stop.
+* @param void *data, the TTurboDemo.
+*/
+static void *run(void *data);
+
+/**
+* Plays one game.
+* @return Returns the final disc difference for black, meaningless if
+* stopped.
+*/
+int playGame();
+
+/**
+* Publishes a position.
+* @param TPosition pos, the position seen from colour.
+* @param unsigned int colour, BLACK or WHITE.
+* @param bool over, true if the game has ended.
+*/
+void publish(TPosition pos, unsigned int colour, bool over);
+
+pthread_t thread;
+bool started;
+/// Only accessed with the __atomic builtins
+int stopFlag;
+pthread_mutex_t lock;
+/// Guarded by lock
+TTurboSample latest;
+int depth;
+unsigned int seed;
+/// Moves played, written by the thread only
+unsigned int played;
+double begun;
+};
+
+#endif /* TURBODEMO_H */
@@ -0,0 +1,106 @@
+#include "workpool.h"
+
+TWorkPool::TWorkPool() : job(NULL), data(NULL), count(0), chunk(1), next(0)
+{
+	pthread_mutex_init(&lock, NULL);
+}
+
+/**
+* Destructor. Waits for the jobs, see finish().
+*/
+TWorkPool::~TWorkPool()
+{
+	finish();
+	pthread_mutex_destroy(&lock);
+}
+
+/**
+* Starts the threads and returns, or runs every job before returning if
+* no thread could be started. Jobs may run in any order and at once.
+* @param TWorkJob job, called for each index.
+* @param void *data, handed to job.
+* @param int count, number of jobs.
+* @param int threads, most threads to start, no more than there are chunks.
+* @param int chunk, indexes a thread takes at a time, for jobs too quick
+* to lock for each.
+*/
+void TWorkPool::start(TWorkJob job, void *data, int count, int threads, int chunk)
+{
+	int started;
+
+	finish();
+	this->job=job;
+	this->data=data;
+	this->count=count;
+	this->chunk=(chunk < 1) ? 1 : chunk;
+	next=0;
+
+	if(threads > (count+this->chunk-1)/this->chunk)
+		threads=(count+this->chunk-1)/this->chunk;
+	workers.resize(threads > 0 ? threads : 0);
+	for(started=0; started<threads; started++)
+		if(pthread_create(&workers[started], NULL, worker, this) != 0)
+			break;
+	workers.resize(started);
+
+	/// If no thread could be started, work here.
+	if(started == 0)
+		work();
+}
+
+/**
+* Waits until every job has run.
+*/
+void TWorkPool::finish()
+{
+	unsigned int i;
+
+	for(i=0; i<workers.size(); i++)
+		pthread_join(workers[i], NULL);
+	workers.clear();
+}
+
+void *TWorkPool::worker(void *arg)
+{
+	((TWorkPool *)arg)->work();
+	return NULL;
+}
+
+/**
+* Runs jobs until none are left.
+*/
+void TWorkPool::work()
+{
+	int first, i;
+
+	for(;;)
+	{
+		pthread_mutex_lock(&lock);
+		first=next;
+		if(next < count)
+			next+=chunk;
+		pthread_mutex_unlock(&lock);
+
+		if(first >= count)
+			break;
+
+		for(i=first; i<first+chunk && i<count; i++)
+			job(i, data);
+	}
+}
+
+/**
+* Runs count jobs on up to threads threads and returns when all are done.
+* @param TWorkJob job, called for each index.
+* @param void *data, handed to job.
+* @param int count, number of jobs.
+* @param int threads, most threads to use.
+* @param int chunk, indexes a thread takes at a time.
+*/
+void runJobs(TWorkJob job, void *data, int count, int threads, int chunk)
+{
+	TWorkPool pool;
+
+	pool.start(job, data, count, threads, chunk);
+	pool.finish();
+}
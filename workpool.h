@@ -0,0 +1,80 @@
+/** @file workpool.h
+ *  Runs numbered jobs on a few threads. Each thread takes the next
+ *  indexes until none are left; if no thread can be started, the jobs
+ *  run on the calling thread instead.
+*/
+
+#ifndef WORKPOOL_H
+#define WORKPOOL_H
+
+#include <pthread.h>
+#include <vector>
+
+/**
+* A job, called once for each index.
+* @param int index, the job, from 0 to count-1.
+* @param void *data, as given to the pool.
+*/
+typedef void (*TWorkJob)(int index, void *data);
+
+class TWorkPool
+{
+	public:
+
+TWorkPool();
+
+/**
+* Destructor. Waits for the jobs, see finish().
+*/
+~TWorkPool();
+
+/**
+* Starts the threads and returns, or runs every job before returning if
+* no thread could be started. Jobs may run in any order and at once.
+* @param TWorkJob job, called for each index.
+* @param void *data, handed to job.
+* @param int count, number of jobs.
+* @param int threads, most threads to start, no more than there are chunks.
+* @param int chunk, indexes a thread takes at a time, for jobs too quick
+* to lock for each.
+*/
+void start(TWorkJob job, void *data, int count, int threads, int chunk=1);
+
+/**
+* Waits until every job has run.
+*/
+void finish();
+
+	private:
+
+static void *worker(void *arg);
+
+/**
+* Runs jobs until none are left.
+*/
+void work();
+
+TWorkPool(const TWorkPool &);
+TWorkPool &operator=(const TWorkPool &);
+
+TWorkJob job;
+void *data;
+int count;
+int chunk;
+/// Guarded by lock
+int next;
+std::vector<pthread_t> workers;
+pthread_mutex_t lock;
+};
+
+/**
+* Runs count jobs on up to threads threads and returns when all are done.
+* @param TWorkJob job, called for each index.
+* @param void *data, handed to job.
+* @param int count, number of jobs.
+* @param int threads, most threads to use.
+* @param int chunk, indexes a thread takes at a time.
+*/
+void runJobs(TWorkJob job, void *data, int count, int threads, int chunk=1);
+
+#endif /* WORKPOOL_H */
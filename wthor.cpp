@@ -0,0 +1,196 @@
+#include <stdio.h>
+#include <string.h>
+#include "wthor.h"
+#include "position.h"
+
+/**
+* Reads a whole file.
+* @return Returns 0, or -1 if the file can't be read.
+*/
+static int readFile(const char *path, std::vector<uint8_t> *data)
+{
+	FILE *file=fopen(path, "rb");
+	long length;
+
+	if(file == NULL)
+		return -1;
+	if(fseek(file, 0, SEEK_END) != 0 || (length=ftell(file)) < 0 ||
+		fseek(file, 0, SEEK_SET) != 0)
+	{
+		fclose(file);
+		return -1;
+	}
+	data->resize(length);
+	if(length > 0 && fread(&(*data)[0], length, 1, file) != 1)
+	{
+		fclose(file);
+		return -1;
+	}
+	fclose(file);
+	return 0;
+}
+
+/**
+* Reads a whole .wtb file and checks its header.
+* @param const char *path, the file.
+* @param std::vector<uint8_t> *data, the file is saved here.
+* @param int *games, the number of games is saved here.
+* @param char *error, if the file can't be used the reason is saved here.
+* @param int size, size of error.
+* @return Returns 0, or -1 if the file can't be read or is not an 8x8 game file.
+*/
+int readWthorFile(const char *path, std::vector<uint8_t> *data, int *games,
+	char *error, int size)
+{
+	uint32_t count;
+
+	if(readFile(path, data) == -1)
+	{
+		snprintf(error, size, "can't read the file");
+		return -1;
+	}
+	if(data->size() < WTHOR_HEADER)
+	{
+		snprintf(error, size, "not a WTHOR file");
+		return -1;
+	}
+
+	count=(*data)[4] | ((*data)[5] << 8) | ((*data)[6] << 16) | ((uint32_t)(*data)[7] << 24);
+	/// Board size 0 is an old way of writing 8.
+	if((*data)[12] != 0 && (*data)[12] != 8)
+	{
+		snprintf(error, size, "board is %dx%d", (*data)[12], (*data)[12]);
+		return -1;
+	}
+	if(count > (data->size()-WTHOR_HEADER)/WTHOR_GAME)
+	{
+		snprintf(error, size, "header says %u games, the file has room for %u",
+			count, (unsigned int)((data->size()-WTHOR_HEADER)/WTHOR_GAME));
+		return -1;
+	}
+
+	*games=count;
+	return 0;
+}
+
+/**
+* Reads the player names of a .jou file.
+* @param const char *path, the file.
+* @param std::vector<std::string> *names, the names by player number.
+* @return Returns 0, or -1 if the file can't be read.
+*/
+int readWthorPlayers(const char *path, std::vector<std::string> *names)
+{
+	std::vector<uint8_t> data;
+	unsigned int count, i, length;
+	const char *name;
+
+	if(readFile(path, &data) == -1 || data.size() < WTHOR_HEADER)
+		return -1;
+
+	/// The number of records is the uint16 at 8.
+	count=data[8] | (data[9] << 8);
+	if(count > (data.size()-WTHOR_HEADER)/WTHOR_NAME)
+		count=(data.size()-WTHOR_HEADER)/WTHOR_NAME;
+
+	names->clear();
+	for(i=0; i<count; i++)
+	{
+		name=(const char *)&data[WTHOR_HEADER+i*WTHOR_NAME];
+		for(length=0; length < WTHOR_NAME && name[length] != 0; length++)
+			;
+		while(length > 0 && name[length-1] == ' ')
+			length--;
+		names->push_back(std::string(name, length));
+	}
+	return 0;
+}
+
+/**
+* Looks up a player name.
+*/
+static void playerName(const std::vector<std::string> *players, unsigned int number, char *name)
+{
+	if(players != NULL && number < players->size())
+		snprintf(name, GAME_MAX_NAME+1, "%s", (*players)[number].c_str());
+	else
+		snprintf(name, GAME_MAX_NAME+1, "#%u", number);
+}
+
+/**
+* Converts a game, replaying it to check every move and the score.
+* Passes are put in where a player had no move.
+* @param const uint8_t *record, the WTHOR_GAME bytes of the game.
+* @param const std::vector<std::string> *players, player names, may be
+* NULL. Players without a name are called by their number, like "#12".
+* @param TGameRecord *game, the game is saved here.
+* @param char *error, what is wrong with the game is saved here.
+* @param int size, size of error.
+* @return Returns WTHOR_FINISHED, WTHOR_UNFINISHED if neither player
+* had run out of moves, WTHOR_ILLEGAL for an illegal move, or
+* WTHOR_BAD_SCORE if the recorded score is not that of the last position.
+*/
+int wthorToGame(const uint8_t *record, const std::vector<std::string> *players,
+	TGameRecord *game, char *error, int size)
+{
+	TRules start;
+	TPosition pos=positionFromRules(start, BLACK);
+	bool blackToMove=true;
+	int i, code, square, black, white, empty, discs;
+	char name[3];
+
+	clearGame(game);
+	playerName(players, record[2] | (record[3] << 8), game->black);
+	playerName(players, record[4] | (record[5] << 8), game->white);
+
+	for(i=0; i<WTHOR_MOVES && record[8+i] != 0; i++)
+	{
+		code=record[8+i];
+		if(code/10 < 1 || code/10 > 8 || code%10 < 1 || code%10 > 8)
+		{
+			snprintf(error, size, "move %d is not a square (%d)", i+1, code);
+			return WTHOR_ILLEGAL;
+		}
+		/// Row 1 is at the top of the GUI board.
+		square=(code%10-1)+(8-code/10)*8;
+
+		if(legalMoves(pos) == 0)
+		{
+			game->moves[game->count++]=PASS_MOVE;
+			pos=playMove(pos, PASS_MOVE);
+			blackToMove=!blackToMove;
+		}
+		if((legalMoves(pos) & ((uint64_t)1 << square)) == 0)
+		{
+			squareName(square, name);
+			snprintf(error, size, "move %d, %s for %s, is illegal", i+1, name,
+				blackToMove ? "black" : "white");
+			return WTHOR_ILLEGAL;
+		}
+		game->moves[game->count++]=square;
+		pos=playMove(pos, square);
+		blackToMove=!blackToMove;
+	}
+
+	if(legalMoves(pos) != 0 || legalMoves(playMove(pos, PASS_MOVE)) != 0)
+		return WTHOR_UNFINISHED;
+
+	black=countBits(blackToMove ? pos.own : pos.enemy);
+	white=countBits(blackToMove ? pos.enemy : pos.own);
+	empty=SQUARES-black-white;
+	game->result=black-white;
+	if(black > white)
+		game->result+=empty;
+	else if(white > black)
+		game->result-=empty;
+
+	/// The score gives the empty squares to the winner, old files may not.
+	discs=record[6];
+	if(discs != (SQUARES+game->result)/2 && discs != black)
+	{
+		snprintf(error, size, "score is %d discs for black, the game gives %d", discs,
+			(SQUARES+game->result)/2);
+		return WTHOR_BAD_SCORE;
+	}
+	return WTHOR_FINISHED;
+}
@@ -0,0 +1,66 @@
+/** @file wthor.h
+ *  Reading the WTHOR game archives of the French Othello federation.
+ *  A .wtb file is a 16 byte header and 68 byte games: the tournament,
+ *  black and white player numbers as uint16, black's discs at the end,
+ *  the theoretical score, and 60 moves as 10*row+column, 11 for a1 and
+ *  0 after the last move. Passes are not stored. Player names are in a
+ *  .jou file of 20 byte records after a 16 byte header. Numbers are
+ *  little-endian.
+*/
+
+#ifndef WTHOR_H
+#define WTHOR_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "gamerecord.h"
+
+#define WTHOR_HEADER 16
+#define WTHOR_GAME 68
+#define WTHOR_NAME 20
+#define WTHOR_MOVES 60
+
+/// Results of wthorToGame()
+#define WTHOR_FINISHED 0
+#define WTHOR_UNFINISHED 1
+#define WTHOR_ILLEGAL 2
+#define WTHOR_BAD_SCORE 3
+
+/**
+* Reads a whole .wtb file and checks its header.
+* @param const char *path, the file.
+* @param std::vector<uint8_t> *data, the file is saved here.
+* @param int *games, the number of games is saved here.
+* @param char *error, if the file can't be used the reason is saved here.
+* @param int size, size of error.
+* @return Returns 0, or -1 if the file can't be read or is not an 8x8 game file.
+*/
+int readWthorFile(const char *path, std::vector<uint8_t> *data, int *games,
+	char *error, int size);
+
+/**
+* Reads the player names of a .jou file.
+* @param const char *path, the file.
+* @param std::vector<std::string> *names, the names by player number.
+* @return Returns 0, or -1 if the file can't be read.
+*/
+int readWthorPlayers(const char *path, std::vector<std::string> *names);
+
+/**
+* Converts a game, replaying it to check every move and the score.
+* Passes are put in where a player had no move.
+* @param const uint8_t *record, the WTHOR_GAME bytes of the game.
+* @param const std::vector<std::string> *players, player names, may be
+* NULL. Players without a name are called by their number, like "#12".
+* @param TGameRecord *game, the game is saved here.
+* @param char *error, what is wrong with the game is saved here.
+* @param int size, size of error.
+* @return Returns WTHOR_FINISHED, WTHOR_UNFINISHED if neither player
+* had run out of moves, WTHOR_ILLEGAL for an illegal move, or
+* WTHOR_BAD_SCORE if the recorded score is not that of the last position.
+*/
+int wthorToGame(const uint8_t *record, const std::vector<std::string> *players,
+	TGameRecord *game, char *error, int size);
+
+#endif /* WTHOR_H */
@@ -0,0 +1,236 @@
+/** @file wthormain.cpp
+ *  othello-wthor, imports WTHOR .wtb archives into a game file. Every
+ *  game is replayed to check its moves and score, files are checked in
+ *  parallel and written in the order given. Each file gets a report
+ *  line, and each rejected game a line saying what is wrong with it.
+ *
+ *  usage: othello-wthor [options] files.wtb...
+ *    -o file       game file to write (default: standard output)
+ *    -a            add to the game file instead of replacing it
+ *    -p file       player names, WTHOR.JOU
+ *    -s            skip unfinished games (default: keep, without result)
+ *    -j threads    files checked at once (default: number of processors)
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <string>
+#include <vector>
+#include "wthor.h"
+#include "gamerecord.h"
+#include "search.h"
+#include "workpool.h"
+
+/// Room for a line of the report
+#define REPORT_LINE 512
+
+/**
+* @short One file, converted.
+* @param std::vector<TGameRecord> games, the games to write.
+* @param std::string report, the lines of the report.
+* @param int total, games in the file, -1 if the file can't be used.
+* @param int unfinished, games that had not ended.
+* @param int illegal, games with an illegal move.
+* @param int badScore, games whose score is not that of the last position.
+* @param bool done, the file has been converted.
+*/
+typedef struct{
+	std::vector<TGameRecord> games;
+	std::string report;
+	int total;
+	int unfinished;
+	int illegal;
+	int badScore;
+	bool done;
+	} TImportedFile;
+
+/**
+* @short Files shared by the converting threads.
+* @param char **paths, the files.
+* @param int count, number of files.
+* @param const std::vector<std::string> *players, player names, may be NULL.
+* @param bool skipUnfinished, leave out games that had not ended.
+* @param std::vector<TImportedFile> files, the files by index.
+* @param pthread_mutex_t lock, guards files.
+* @param pthread_cond_t converted, signalled when a file is done.
+*/
+typedef struct{
+	char **paths;
+	int count;
+	const std::vector<std::string> *players;
+	bool skipUnfinished;
+	std::vector<TImportedFile> files;
+	pthread_mutex_t lock;
+	pthread_cond_t converted;
+	} TImport;
+
+static void usage()
+{
+	fprintf(stderr, "usage: othello-wthor [-o file] [-a] [-p players.jou] [-s] [-j threads] files.wtb...\n");
+	exit(1);
+}
+
+/**
+* Converts one file.
+* @param const char *path, the file.
+* @param TImport *import, the settings.
+* @param TImportedFile *file, the games and the report are saved here.
+*/
+static void convertFile(const char *path, TImport *import, TImportedFile *file)
+{
+	std::vector<uint8_t> data;
+	char error[REPORT_LINE/2], line[REPORT_LINE];
+	int games, i, status;
+
+	file->total=-1;
+	if(readWthorFile(path, &data, &games, error, sizeof(error)) == -1)
+	{
+		snprintf(line, sizeof(line), "%s: %s\n", path, error);
+		file->report+=line;
+		return;
+	}
+
+	file->total=games;
+	file->games.reserve(games);
+	for(i=0; i<games; i++)
+	{
+		file->games.resize(file->games.size()+1);
+		status=wthorToGame(&data[WTHOR_HEADER+i*WTHOR_GAME], import->players,
+			&file->games.back(), error, sizeof(error));
+
+		if(status == WTHOR_FINISHED)
+			continue;
+		if(status == WTHOR_UNFINISHED)
+		{
+			file->unfinished++;
+			if(!import->skipUnfinished)
+				continue;
+		} else {
+			if(status == WTHOR_ILLEGAL)
+				file->illegal++;
+			else
+				file->badScore++;
+			snprintf(line, sizeof(line), "%s: game %d: %s\n", path, i+1, error);
+			file->report+=line;
+		}
+		file->games.pop_back();
+	}
+
+	snprintf(line, sizeof(line), "%s: %d games, %d imported, %d illegal, %d wrong score, %d unfinished\n",
+		path, games, (int)file->games.size(), file->illegal, file->badScore, file->unfinished);
+	file->report+=line;
+}
+
+/**
+* Converts file index and hands it to the writer.
+*/
+static void importJob(int index, void *data)
+{
+	TImport *import=(TImport *)data;
+	TImportedFile file;
+
+	file.unfinished=file.illegal=file.badScore=0;
+	convertFile(import->paths[index], import, &file);
+
+	pthread_mutex_lock(&import->lock);
+	import->files[index].games.swap(file.games);
+	import->files[index].report.swap(file.report);
+	import->files[index].total=file.total;
+	import->files[index].unfinished=file.unfinished;
+	import->files[index].illegal=file.illegal;
+	import->files[index].badScore=file.badScore;
+	import->files[index].done=true;
+	pthread_cond_broadcast(&import->converted);
+	pthread_mutex_unlock(&import->lock);
+}
+
+int main(int argc, char *argv[])
+{
+	std::vector<std::string> players;
+	const char *output="-", *playerFile=NULL;
+	int threads=sysconf(_SC_NPROCESSORS_ONLN);
+	bool append=false, failed=false;
+	TImport import;
+	TImportedFile file;
+	TGameWriter writer;
+	TWorkPool pool;
+	int opt, i, written=0, rejected=0;
+	unsigned int j;
+	double start=searchClock();
+
+	import.skipUnfinished=false;
+	while((opt=getopt(argc, argv, "o:ap:sj:")) != -1)
+	{
+		switch (opt)
+		{
+			case 'o' : output=optarg; break;
+			case 'a' : append=true; break;
+			case 'p' : playerFile=optarg; break;
+			case 's' : import.skipUnfinished=true; break;
+			case 'j' : threads=atoi(optarg); break;
+			default : usage();
+		}
+	}
+	if(optind == argc)
+		usage();
+
+	if(playerFile != NULL && readWthorPlayers(playerFile, &players) == -1)
+	{
+		fprintf(stderr, "othello-wthor: can't read players from %s\n", playerFile);
+		return 1;
+	}
+	if(writer.open(output, append) == -1)
+	{
+		fprintf(stderr, "othello-wthor: can't write %s\n", output);
+		return 1;
+	}
+
+	import.paths=argv+optind;
+	import.count=argc-optind;
+	import.players=(playerFile != NULL) ? &players : NULL;
+	import.files.resize(import.count);
+	for(i=0; i<import.count; i++)
+		import.files[i].done=false;
+	pthread_mutex_init(&import.lock, NULL);
+	pthread_cond_init(&import.converted, NULL);
+
+	pool.start(importJob, &import, import.count, threads);
+
+	/// Files are written in order as soon as they are converted.
+	for(i=0; i<import.count; i++)
+	{
+		pthread_mutex_lock(&import.lock);
+		while(!import.files[i].done)
+			pthread_cond_wait(&import.converted, &import.lock);
+		file.games.swap(import.files[i].games);
+		file.report.swap(import.files[i].report);
+		file.total=import.files[i].total;
+		pthread_mutex_unlock(&import.lock);
+
+		fputs(file.report.c_str(), stderr);
+		if(file.total == -1)
+			failed=true;
+		else
+			rejected+=file.total-file.games.size();
+		for(j=0; j<file.games.size(); j++)
+			if(writer.write(&file.games[j]) == 0)
+				written++;
+		std::vector<TGameRecord>().swap(file.games);
+	}
+
+	pool.finish();
+	pthread_cond_destroy(&import.converted);
+	pthread_mutex_destroy(&import.lock);
+
+	if(writer.close() == -1)
+	{
+		fprintf(stderr, "othello-wthor: can't write %s\n", output);
+		return 1;
+	}
+	fprintf(stderr, "othello-wthor: %d games written, %d left out, %.2f s\n",
+		written, rejected, searchClock()-start);
+	return failed ? 1 : 0;
+}